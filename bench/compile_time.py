@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+
+"""Measure compile time on the generated workloads against a baseline.
+
+Every workload of generators.py is compiled a number of times with
+--time-report=json, once as is and once with -O1 (reported as
+"<workload> -O1"), so that the optimizer is covered too. For each one the median time of every phase, the peak
+RSS, and tokens/s and lines/s over the whole compilation are printed, next
+to the change from the stored baseline. A workload whose total time or peak
+RSS has grown past the threshold is a regression, and the exit status is 1.
+
+    python3 compile_time.py --save-baseline
+
+records the current numbers as the baseline. Baselines only compare across
+runs on the same machine, with the same build of the compiler.
+"""
+
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+from argparse import ArgumentParser
+
+import generators
+
+PHASES = ["lex", "parse", "dump-ast", "sema", "codegen", "optimize"]
+
+# the name suffix of a configuration and the flags it adds
+CONFIGURATIONS = [("", []), (" -O1", ["-O1"])]
+
+def run(compiler, source, output_dir, flags):
+    result = subprocess.run([compiler, source, "--quiet",
+                             "--time-report=json", "--save-path", output_dir]
+                            + flags,
+                            stdout = subprocess.DEVNULL,
+                            stderr = subprocess.PIPE, check = True,
+                            universal_newlines = True)
+    # the report is the last line
+    return json.loads(result.stderr.splitlines()[-1])
+
+def measure(compiler, source, output_dir, runs, flags):
+    """The median time of each phase over the runs, in ms, and the peak RSS
+    once it is done."""
+    # warm the page cache
+    run(compiler, source, output_dir, flags)
+    reports = [run(compiler, source, output_dir, flags)
+               for _ in range(runs)]
+
+    phases = {}
+    phases_rss = {}
+    for name in PHASES:
+        samples = [phase for report in reports for phase in report["phases"]
+                   if phase["name"] == name]
+        if samples:
+            phases[name] = statistics.median(phase["time_ns"] / 1e6
+                                             for phase in samples)
+            # the lexer runs inside the parser and has none of its own
+            if "peak_rss_kib" in samples[0]:
+                phases_rss[name] = max(phase["peak_rss_kib"]
+                                       for phase in samples)
+    totals = [sum(phase["time_ns"] for phase in report["phases"]) / 1e6
+              for report in reports]
+    peak_rss = max(phase.get("peak_rss_kib", 0) for report in reports
+                   for phase in report["phases"])
+
+    with open(source) as program:
+        num_lines = sum(1 for _ in program)
+    return {
+        "lines": num_lines,
+        "tokens": reports[0]["counts"]["tokens"],
+        "total_ms": statistics.median(totals),
+        "phases_ms": phases,
+        "phases_rss_kib": phases_rss,
+        "peak_rss_kib": peak_rss,
+    }
+
+def change(current, baseline):
+    if not baseline:
+        return ""
+    return "{:+6.1f}%".format(100.0 * (current - baseline) / baseline)
+
+def report(name, result, baseline, threshold):
+    """Print the numbers of a workload; True if it has regressed."""
+    total_s = result["total_ms"] / 1e3
+    print("{}: {} lines, {} tokens".format(name, result["lines"],
+                                           result["tokens"]))
+    for phase, time_ms in sorted(result["phases_ms"].items(),
+                                 key = lambda item: PHASES.index(item[0])):
+        base = baseline.get("phases_ms", {}).get(phase) if baseline else None
+        rss = result["phases_rss_kib"].get(phase)
+        print("  {:<9} {:10.2f} ms {:7}  {}".format(
+            phase, time_ms, change(time_ms, base),
+            "{} KiB".format(rss) if rss else ""))
+    print("  {:<9} {:10.2f} ms {:7}  {:.0f} tokens/s  {:.0f} lines/s".format(
+        "total", result["total_ms"],
+        change(result["total_ms"], baseline and baseline["total_ms"]),
+        result["tokens"] / total_s, result["lines"] / total_s))
+    print("  {:<9} {:10d} KiB {}".format(
+        "peak RSS", result["peak_rss_kib"],
+        change(result["peak_rss_kib"],
+               baseline and baseline["peak_rss_kib"])))
+
+    if not baseline:
+        return False
+    regressed = []
+    for key in ("total_ms", "peak_rss_kib"):
+        if result[key] > baseline[key] * (1 + threshold):
+            regressed.append(key)
+    if regressed:
+        print("  REGRESSION in " + ", ".join(regressed))
+    return bool(regressed)
+
+def main():
+    bench_dir = os.path.dirname(os.path.abspath(__file__))
+    parser = ArgumentParser(description = __doc__)
+    parser.add_argument("--compiler",
+                        default = os.path.join(bench_dir, "../src/compiler"),
+                        help = "path to the compiler")
+    parser.add_argument("--runs", type = int, default = 5,
+                        help = "number of timed runs of each workload")
+    parser.add_argument("--scale", type = float, default = 1.0,
+                        help = "multiplies the size of every workload")
+    parser.add_argument("--workload", action = "append",
+                        choices = sorted(generators.WORKLOADS),
+                        help = "run only these, may be repeated")
+    parser.add_argument("--baseline",
+                        default = os.path.join(bench_dir, "baseline.json"),
+                        help = "the numbers to compare against")
+    parser.add_argument("--save-baseline", action = "store_true",
+                        help = "store the numbers of this run as the baseline")
+    parser.add_argument("--threshold", type = float, default = 0.10,
+                        help = "slowdown or growth counted as a regression")
+    args = parser.parse_args()
+
+    baselines = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as baseline_file:
+            baselines = json.load(baseline_file)
+        if baselines.get("scale") != args.scale:
+            print("the baseline is at scale {}, not comparing".format(
+                baselines.get("scale")))
+            baselines = {}
+
+    results = {}
+    has_regression = False
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        for name in args.workload or list(generators.WORKLOADS):
+            source = os.path.join(tmp_dir, name + ".p")
+            generators.generate(name, source, args.scale)
+            for suffix, flags in CONFIGURATIONS:
+                key = name + suffix
+                results[key] = measure(args.compiler, source, tmp_dir,
+                                       args.runs, flags)
+                baseline = baselines.get("workloads", {}).get(key)
+                if report(key, results[key], baseline, args.threshold):
+                    has_regression = True
+
+    if args.save_baseline:
+        # keep the workloads that were not run this time
+        saved = baselines or {"scale": args.scale, "workloads": {}}
+        saved["scale"] = args.scale
+        saved["workloads"].update(results)
+        with open(args.baseline, "w") as baseline_file:
+            json.dump(saved, baseline_file, indent = 2, sort_keys = True)
+            baseline_file.write("\n")
+        print("baseline written to " + args.baseline)
+
+    return 1 if has_regression else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
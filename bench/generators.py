@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+
+"""Generators of large P programs for measuring compile time.
+
+Each workload stresses one part of the compiler the way a large but
+realistic program would: many globals for the symbol tables, deep nesting
+and long expressions for the recursive passes, many functions and loops for
+codegen. Every program is valid, so all the passes run over it, and starts
+with pseudocomments that turn the source listing, token echo and symbol
+table dump off.
+
+    python3 generators.py <workload> <output file> [--scale S]
+
+writes a single program, see WORKLOADS for the names.
+"""
+
+import sys
+from argparse import ArgumentParser
+
+HEADER = "//&S-\n//&T-\n//&D-\n{};\n\n"
+
+def globals_(out, scale):
+    """100k global variables and constants, each used once."""
+    count = int(100000 * scale)
+    out.write(HEADER.format("globals"))
+    for i in range(count):
+        if i % 4 == 3:
+            out.write("var c{}: {};\n".format(i, i))
+        else:
+            out.write("var g{}: integer;\n".format(i))
+    out.write("\nbegin\n\nvar sum: integer;\nsum := 0;\n")
+    for i in range(count):
+        if i % 4 == 3:
+            out.write("sum := sum + c{};\n".format(i))
+        else:
+            out.write("g{0} := {0};\nsum := sum + g{0};\n".format(i))
+    out.write("print sum;\n\nend\nend\n")
+
+def nested_ifs(out, scale):
+    """ifs nested 400 deep, with an else on every level."""
+    depth = int(400 * scale)
+    out.write(HEADER.format("nestedifs"))
+    out.write("begin\n\nvar a: integer;\na := 0;\n")
+    for level in range(depth):
+        out.write("if a < {} then\nbegin\n".format(level + 1))
+        out.write("a := a + {};\n".format(level % 7 + 1))
+    for level in reversed(range(depth)):
+        out.write("end\nelse\nbegin\nprint {};\nend\nend if\n".format(level))
+    out.write("print a;\n\nend\nend\n")
+
+def expression_chains(out, scale):
+    """20 assignments of chains of binary operators, up to 5000 long."""
+    length = int(5000 * scale)
+    operators = ["+", "-", "*", "+", "-"]
+    out.write(HEADER.format("expressions"))
+    out.write("var x, y: integer;\n\n")
+    out.write("begin\n\nx := 1;\ny := 2;\n")
+    for chain in range(20):
+        terms = []
+        for i in range(length * (chain + 1) // 20):
+            terms.append("(x {} {})".format(operators[i % len(operators)],
+                                            i % 97 + 1))
+            terms.append(operators[(i + chain) % len(operators)])
+        terms.append("y")
+        out.write("x := " + " ".join(terms) + ";\n")
+        out.write("y := x mod 1000;\n")
+    out.write("print x;\nprint y;\n\nend\nend\n")
+
+def functions(out, scale):
+    """5000 functions, each calling the one before it."""
+    count = int(5000 * scale)
+    out.write(HEADER.format("functions"))
+    out.write("var calls: integer;\n\n")
+    for i in range(count):
+        out.write("f{}(a, b: integer; c: boolean): integer\n".format(i))
+        out.write("begin\nvar result: integer;\n")
+        out.write("calls := calls + 1;\n")
+        if i == 0:
+            out.write("result := a * b;\n")
+        else:
+            out.write("if c then\nbegin\n")
+            out.write("result := f{}(b, a + {}, not c);\n".format(i - 1, i))
+            out.write("end\nelse\nbegin\nresult := a - b;\nend\nend if\n")
+        out.write("return result;\nend\nend\n\n")
+    out.write("begin\n\n")
+    for i in range(0, count, max(1, count // 100)):
+        out.write("print f{}({}, 2, true);\n".format(i, i))
+    out.write("print calls;\n\nend\nend\n")
+
+def arrays(out, scale):
+    """Large local arrays, passed around and indexed; codegen handles up to
+    two dimensions."""
+    count = int(200 * scale)
+    out.write(HEADER.format("arrays"))
+    out.write("trace(m: array 100 of array 100 of integer): integer\n")
+    out.write("begin\nvar sum: integer;\nsum := 0;\n")
+    out.write("for i := 0 to 99 do\nbegin\n")
+    out.write("sum := sum + m[i][i];\nend\nend do\n")
+    out.write("return sum;\nend\nend\n\n")
+    out.write("begin\n\n")
+    out.write("var m: array 100 of array 100 of integer;\n")
+    out.write("var v: array 100000 of integer;\n")
+    for i in range(count):
+        out.write("var t{}: array 20 of array 30 of integer;\n".format(i))
+    for i in range(count):
+        out.write("t{0}[{1}][{2}] := v[{3}] + m[{1}][{2}];\n".format(
+            i, i % 20, i % 30, i * 97 % 100000))
+        out.write("v[{}] := t{}[{}][{}] * 2;\n".format(
+            i * 31 % 100000, i, (i + 3) % 20, (i + 7) % 30))
+        out.write("m[{}][{}] := v[{}];\n".format(i % 100, i * 7 % 100,
+                                                i * 13 % 100000))
+    out.write("print trace(m);\n\nend\nend\n")
+
+def loop_nests(out, scale):
+    """Nests of for and while loops, 6 deep, 300 of them."""
+    count = int(300 * scale)
+    depth = 6
+    out.write(HEADER.format("loops"))
+    out.write("begin\n\nvar sum, w: integer;\nsum := 0;\n")
+    for nest in range(count):
+        for level in range(depth):
+            if level % 3 == 2:
+                out.write("w := 0;\nwhile w < 2 do\nbegin\nw := w + 1;\n")
+            else:
+                out.write("for i{}x{} := 0 to {} do\nbegin\n".format(
+                    nest, level, level + 2))
+        out.write("sum := sum + {} * (i{}x0 - i{}x1) mod 7;\n".format(
+            nest % 11 + 1, nest, nest))
+        for level in reversed(range(depth)):
+            out.write("end\nend do\n")
+    out.write("print sum;\n\nend\nend\n")
+
+WORKLOADS = {
+    "globals": globals_,
+    "nested_ifs": nested_ifs,
+    "expression_chains": expression_chains,
+    "functions": functions,
+    "arrays": arrays,
+    "loop_nests": loop_nests,
+}
+
+def generate(workload, path, scale = 1.0):
+    with open(path, "w") as out:
+        WORKLOADS[workload](out, scale)
+
+def main():
+    parser = ArgumentParser(description = __doc__)
+    parser.add_argument("workload", choices = sorted(WORKLOADS))
+    parser.add_argument("output", help = "where to write the program")
+    parser.add_argument("--scale", type = float, default = 1.0,
+                        help = "multiplies the size of the program")
+    args = parser.parse_args()
+    generate(args.workload, args.output, args.scale)
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+
+"""Measure scanner throughput on a generated multi-megabyte P source.
+
+The generated program turns the source listing, token echo and symbol table
+dump off with pseudocomments and the compiler is run with --lex-only, so the
+time is spent in the scanner (plus mapping the file).
+"""
+
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+from argparse import ArgumentParser
+
+STATEMENTS = [
+    "sum := sum + counter * 3 - (counter mod 7);",
+    "if sum > 1000000 then sum := sum / 2; else sum := sum + 1; end if",
+    "while counter < 10 do counter := counter + 1; end do",
+    "print \"a string literal with \"\"quotes\"\" in it\";",
+    "// a line comment",
+    "/* a block comment */ flag := flag and not (sum <= 0);",
+    "ratio := 3.14159 * 2.0e3;",
+]
+
+def generate(path, megabytes):
+    target = megabytes * 1024 * 1024
+    with open(path, "w") as out:
+        out.write("//&S-\n//&T-\n//&D-\nbench;\n")
+        out.write("var sum, counter: integer;\nvar flag: boolean;\n")
+        out.write("var ratio: real;\nbegin\n")
+        written = out.tell()
+        i = 0
+        while written < target:
+            line = "    " + STATEMENTS[i % len(STATEMENTS)] + "\n"
+            out.write(line)
+            written += len(line)
+            i += 1
+        out.write("end\nend\n")
+
+def run(compiler, source):
+    start = time.perf_counter()
+    result = subprocess.run([compiler, source, "--lex-only"],
+                            stdout = subprocess.DEVNULL,
+                            stderr = subprocess.PIPE, check = True)
+    elapsed = time.perf_counter() - start
+    num_tokens = int(result.stderr.split()[0])
+    return elapsed, num_tokens
+
+def main():
+    parser = ArgumentParser(description = __doc__)
+    parser.add_argument("--compiler", default = "../src/compiler",
+                        help = "path to the compiler")
+    parser.add_argument("--size", type = int, default = 16,
+                        help = "size of the generated source in MiB")
+    parser.add_argument("--runs", type = int, default = 5,
+                        help = "number of timed runs")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        source = os.path.join(tmp_dir, "bench.p")
+        generate(source, args.size)
+        size = os.path.getsize(source)
+
+        # warm the page cache
+        run(args.compiler, source)
+        times = []
+        for _ in range(args.runs):
+            elapsed, num_tokens = run(args.compiler, source)
+            times.append(elapsed)
+
+    best = min(times)
+    median = statistics.median(times)
+    print("{} bytes, {} tokens".format(size, num_tokens))
+    print("best   {:8.3f} s  {:8.1f} MiB/s  {:8.2f} Mtokens/s".format(
+        best, size / best / 2**20, num_tokens / best / 1e6))
+    print("median {:8.3f} s  {:8.1f} MiB/s  {:8.2f} Mtokens/s".format(
+        median, size / median / 2**20, num_tokens / median / 1e6))
+
+if __name__ == "__main__":
+    sys.exit(main())
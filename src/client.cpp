@@ -0,0 +1,177 @@
+// compiler-client: has a running `compiler --serve <socket>` compile on its
+// behalf, so that it can stand in for ./compiler at the cost of a connect
+// instead of a full start-up of the compiler.
+//
+// The socket is taken from $P2LLVM_SERVER. Without it, or if no server
+// answers there, the compiler next to this executable is run instead.
+// $P2LLVM_CACHE_DIR is passed on as --cache-dir, since the server does not
+// see our environment.
+//
+// Only the C library is used so that the client itself starts quickly.
+
+#include "driver/ServerProtocol.hpp"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static void runCompiler(const char *argv[]) {
+    // the compiler lives in the same directory as the client
+    char path[PATH_MAX];
+    const char *slash = strrchr(argv[0], '/');
+    const int dir_length = slash ? static_cast<int>(slash - argv[0] + 1) : 0;
+    snprintf(path, sizeof(path), "%.*scompiler", dir_length, argv[0]);
+
+    argv[0] = path;
+    execv(path, const_cast<char *const *>(argv));
+    perror("compiler-client: execv() failed");
+    exit(-1);
+}
+
+static int connectToServer(const char *p_socket_path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(p_socket_path) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strcpy(address.sun_path, p_socket_path);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<const struct sockaddr *>(&address),
+                sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// the size of the request, then the working directory and the arguments
+static char *buildRequest(const int argc, const char *argv[], size_t &p_size) {
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        return nullptr;
+    }
+    // ahead of the arguments, so that a --cache-dir among them still wins
+    const char *cache_directory = getenv(kCacheDirectoryVariable);
+
+    size_t payload_size = strlen(cwd) + 1;
+    if (cache_directory) {
+        payload_size += sizeof("--cache-dir") + strlen(cache_directory) + 1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        payload_size += strlen(argv[i]) + 1;
+    }
+    if (payload_size > kMaxRequestSize) {
+        return nullptr;
+    }
+
+    const uint32_t size = static_cast<uint32_t>(payload_size);
+    p_size = sizeof(size) + size;
+    char *request = static_cast<char *>(malloc(p_size));
+    memcpy(request, &size, sizeof(size));
+    char *cursor = request + sizeof(size);
+    cursor = stpcpy(cursor, cwd) + 1;
+    if (cache_directory) {
+        cursor = stpcpy(cursor, "--cache-dir") + 1;
+        cursor = stpcpy(cursor, cache_directory) + 1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        cursor = stpcpy(cursor, argv[i]) + 1;
+    }
+    return request;
+}
+
+static bool sendRequest(const int p_fd, const char *p_request, size_t p_size) {
+    // our stdout and stderr go along with the first byte
+    const int fds[2] = {STDOUT_FILENO, STDERR_FILENO};
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+
+    struct iovec iov;
+    iov.iov_base = const_cast<char *>(p_request);
+    iov.iov_len = p_size;
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t n;
+    do {
+        n = sendmsg(p_fd, &message, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+
+    p_request += n;
+    p_size -= static_cast<size_t>(n);
+    while (p_size) {
+        n = write(p_fd, p_request, p_size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p_request += n;
+        p_size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+int main(int argc, const char *argv[]) {
+    const char *socket_path = getenv(kServerSocketVariable);
+    const int fd = socket_path ? connectToServer(socket_path) : -1;
+    if (fd < 0) {
+        runCompiler(argv);
+    }
+
+    size_t request_size;
+    char *request = buildRequest(argc, argv, request_size);
+    if (!request) {
+        close(fd);
+        runCompiler(argv);
+    }
+    fflush(stdout);
+    if (!sendRequest(fd, request, request_size)) {
+        // nothing has been compiled yet
+        close(fd);
+        runCompiler(argv);
+    }
+    free(request);
+
+    int32_t status;
+    size_t received = 0;
+    while (received < sizeof(status)) {
+        const ssize_t n = read(fd, reinterpret_cast<char *>(&status) + received,
+                               sizeof(status) - received);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            fprintf(stderr, "compiler-client: the server went away\n");
+            exit(-1);
+        }
+        received += static_cast<size_t>(n);
+    }
+    close(fd);
+    return status;
+}
@@ -0,0 +1,73 @@
+#ifndef AST_AST_ARENA_H
+#define AST_AST_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*
+ * Bump-pointer allocator backing every AstNode of a compilation.
+ *
+ * AstNode::operator new takes its memory from the arena installed on the
+ * current thread (see AstArena::Scope) and AstNode::operator delete does
+ * nothing, so the whole tree is released at once by dropping the arena.
+ */
+class AstArena {
+  public:
+    // installs an arena as the current one for the lifetime of the scope
+    class Scope {
+      private:
+        AstArena *m_previous;
+
+      public:
+        ~Scope();
+        Scope(AstArena &p_arena);
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+  private:
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    char *m_cursor = nullptr;
+    char *m_end = nullptr;
+
+    // bytes handed out / bytes reserved in chunks
+    size_t m_allocated_bytes = 0;
+    size_t m_reserved_bytes = 0;
+    size_t m_first_chunk_size = 0;
+    size_t m_num_allocations = 0;
+
+  public:
+    ~AstArena() = default;
+    AstArena() = default;
+
+    AstArena(const AstArena &) = delete;
+    AstArena &operator=(const AstArena &) = delete;
+
+    static AstArena *getCurrent();
+
+    void *allocate(const size_t size, const size_t alignment);
+
+    size_t getAllocatedBytes() const { return m_allocated_bytes; }
+    // only grows until reset() or release(), so it is the most memory the
+    // arena has held during a compilation
+    size_t getReservedBytes() const { return m_reserved_bytes; }
+    // one per AstNode
+    size_t getNumAllocations() const { return m_num_allocations; }
+
+    // free all chunks; destructors of the objects in them are not run
+    void release();
+    // Like release(), but the first chunk is kept for the next allocations.
+    void reset();
+
+    // Arenas kept around by a long-running process (a batch or the compile
+    // server), so that later compilations start on memory that is already
+    // mapped in. acquire() creates a new arena if none is free.
+    static std::unique_ptr<AstArena> acquire();
+    static void recycle(std::unique_ptr<AstArena> p_arena);
+};
+
+#endif
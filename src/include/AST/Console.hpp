@@ -0,0 +1,32 @@
+#ifndef AST_CONSOLE_H
+#define AST_CONSOLE_H
+
+#include <cstdio>
+
+/*
+ * Where a compilation prints its source listing, tokens, dumps and
+ * diagnostics: stdout and stderr, unless a Console::Scope on the current
+ * thread redirects them. The batch driver gives every compilation its own
+ * streams so that the output of each input stays together.
+ */
+class Console {
+  public:
+    // installs a pair of streams for the lifetime of the scope
+    class Scope {
+      private:
+        FILE *m_previous_out;
+        FILE *m_previous_err;
+
+      public:
+        ~Scope();
+        Scope(FILE *const p_out, FILE *const p_err);
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    static FILE *out();
+    static FILE *err();
+};
+
+#endif
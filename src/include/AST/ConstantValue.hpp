@@ -19,9 +19,6 @@ class ConstantValueNode final : public ExpressionNode {
         : ExpressionNode{line, col}, m_constant_ptr(p_constant) {}
 
     const PType *getTypePtr() const { return m_constant_ptr->getTypePtr(); }
-    const PTypeSharedPtr &getTypeSharedPtr() const {
-        return m_constant_ptr->getTypeSharedPtr();
-    }
 
     const char *getConstantValueCString() const {
         return m_constant_ptr->getConstantValueCString();
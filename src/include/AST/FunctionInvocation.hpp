@@ -1,6 +1,7 @@
 #ifndef AST_FUNCTION_INVOCATION_NODE_H
 #define AST_FUNCTION_INVOCATION_NODE_H
 
+#include "AST/Identifier.hpp"
 #include "AST/expression.hpp"
 #include "visitor/AstNodeVisitor.hpp"
 
@@ -8,25 +9,36 @@
 #include <string>
 #include <vector>
 
+class SymbolEntry;
+
 class FunctionInvocationNode final : public ExpressionNode {
   public:
     using ExprNodes = std::vector<std::unique_ptr<ExpressionNode>>;
 
   private:
-    std::string m_name;
+    Identifier m_name;
     ExprNodes m_args;
 
+    const SymbolEntry *m_symbol_entry_ptr = nullptr;
+
   public:
     ~FunctionInvocationNode() = default;
     FunctionInvocationNode(const uint32_t line, const uint32_t col,
-                           const char *const p_name, ExprNodes &p_args)
+                           const Identifier p_name, ExprNodes &p_args)
         : ExpressionNode{line, col}, m_name(p_name), m_args(std::move(p_args)){}
 
-    const std::string &getName() const { return m_name; }
+    Identifier getIdentifier() const { return m_name; }
+    const std::string &getName() const { return m_name.str(); }
     const char *getNameCString() const { return m_name.c_str(); }
 
     const ExprNodes &getArguments() const { return m_args; }
 
+    // resolved by the semantic analyzer
+    const SymbolEntry *getSymbolEntry() const { return m_symbol_entry_ptr; }
+    void setSymbolEntry(const SymbolEntry *p_entry) {
+        m_symbol_entry_ptr = p_entry;
+    }
+
     void accept(AstNodeVisitor &p_visitor) override { p_visitor.visit(*this); }
     void visitChildNodes(AstNodeVisitor &p_visitor) override;
 };
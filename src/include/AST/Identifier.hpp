@@ -0,0 +1,51 @@
+#ifndef AST_IDENTIFIER_H
+#define AST_IDENTIFIER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+/*
+ * Handle to an interned identifier. The scanner interns every ID token, so
+ * each distinct name is stored once and two identifiers are the same name
+ * iff their handles compare equal (a pointer comparison).
+ *
+ * Interned names live until the process exits.
+ */
+class Identifier {
+  private:
+    const std::string *m_name;
+
+    explicit Identifier(const std::string *p_name) : m_name(p_name) {}
+
+  public:
+    // trivial, so that it can be carried in the yylval union
+    Identifier() = default;
+
+    static Identifier get(const char *const p_name, const size_t length);
+    static Identifier get(const std::string &p_name) {
+        return get(p_name.data(), p_name.size());
+    }
+
+    const std::string &str() const { return *m_name; }
+    const char *c_str() const { return m_name->c_str(); }
+
+    bool operator==(const Identifier p_other) const {
+        return m_name == p_other.m_name;
+    }
+    bool operator!=(const Identifier p_other) const {
+        return m_name != p_other.m_name;
+    }
+    // an arbitrary but consistent order, for ordered containers
+    bool operator<(const Identifier p_other) const {
+        return std::less<const std::string *>()(m_name, p_other.m_name);
+    }
+
+    struct Hash {
+        size_t operator()(const Identifier p_identifier) const {
+            return std::hash<const std::string *>()(p_identifier.m_name);
+        }
+    };
+};
+
+#endif
@@ -1,14 +1,17 @@
 #ifndef AST_P_TYPE_H
 #define AST_P_TYPE_H
 
-#include <memory>
+#include <cstdint>
 #include <string>
 #include <vector>
 
-class PType;
-
-using PTypeSharedPtr = std::shared_ptr<PType>;
-
+/*
+ * Types are interned: PType::get() hands out one shared, immutable instance
+ * per (primitive type, dimensions), so two types are identical iff their
+ * pointers compare equal and nobody owns or frees a PType.
+ *
+ * Interned types live until the process exits.
+ */
 class PType {
   public:
     enum class PrimitiveTypeEnum : uint8_t {
@@ -22,23 +25,32 @@ class PType {
   private:
     PrimitiveTypeEnum m_type;
     std::vector<uint64_t> m_dimensions;
-    mutable std::string m_type_string;
-    mutable bool m_type_string_is_valid = false;
+    std::string m_type_string;
+    // the type with the first dimension dropped, nullptr for scalars
+    const PType *m_element_type = nullptr;
+
+    PType(const PrimitiveTypeEnum type, std::vector<uint64_t> p_dims);
+
+    static const PType *intern(const PrimitiveTypeEnum type,
+                               const std::vector<uint64_t> &p_dims);
 
   public:
     ~PType() = default;
-    PType(const PrimitiveTypeEnum type) : m_type(type) {}
 
-    void setDimensions(std::vector<uint64_t> &p_dims) {
-        m_dimensions = std::move(p_dims);
-    }
+    PType(const PType &) = delete;
+    PType &operator=(const PType &) = delete;
+
+    static const PType *get(const PrimitiveTypeEnum type);
+    static const PType *get(const PrimitiveTypeEnum type,
+                            const std::vector<uint64_t> &p_dims);
 
     PrimitiveTypeEnum getPrimitiveType() const { return m_type; }
-    const char *getPTypeCString() const;
+    const char *getPTypeCString() const { return m_type_string.c_str(); }
 
     const std::vector<uint64_t> &getDimensions() const { return m_dimensions; }
 
-    PType *getStructElementType(const std::size_t nth) const;
+    // the type after subscripting the first nth dimensions
+    const PType *getStructElementType(const std::size_t nth) const;
 
     bool isPrimitiveInteger() const {
         return m_type == PrimitiveTypeEnum::kIntegerType;
@@ -69,6 +81,7 @@ class PType {
         return m_dimensions.empty() && m_type != PrimitiveTypeEnum::kVoidType;
     }
 
+    // equality, except that integer and real are interchangeable
     bool compare(const PType *p_type) const;
 };
 
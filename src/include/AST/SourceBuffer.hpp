@@ -0,0 +1,70 @@
+#ifndef AST_SOURCE_BUFFER_H
+#define AST_SOURCE_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * The contents of a source file, memory-mapped copy-on-write (or read into
+ * memory if the file cannot be mapped) and followed by two NUL bytes, so
+ * that flex can scan it in place with yy_scan_buffer().
+ *
+ * Lines are looked up through an index of where each line starts. The
+ * index is only built when a line is first asked for, which normally means
+ * on the first diagnostic.
+ */
+class SourceBuffer {
+  public:
+    // installs a buffer as the current one for the lifetime of the scope
+    class Scope {
+      private:
+        const SourceBuffer *m_previous;
+
+      public:
+        ~Scope();
+        Scope(const SourceBuffer &p_buffer);
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+  private:
+    char *m_data = nullptr;
+    size_t m_size = 0;
+    // length of the mapping, 0 if the contents are not mapped
+    size_t m_mapped_size = 0;
+    // used when the file cannot be mapped (e.g. it is a pipe)
+    std::vector<char> m_fallback;
+
+    // offset of the first character of line n + 1 (lines are 1-based)
+    mutable std::vector<size_t> m_line_starts;
+
+    void buildLineIndex() const;
+
+  public:
+    ~SourceBuffer();
+    SourceBuffer() = default;
+
+    SourceBuffer(const SourceBuffer &) = delete;
+    SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+    static const SourceBuffer *getCurrent();
+
+    // false if the file cannot be read
+    bool open(const char *const p_path);
+
+    const char *getData() const { return m_data; }
+    // the scanner temporarily writes NULs into the contents while scanning
+    char *getScanBuffer() { return m_data; }
+    // excluding the two trailing NUL bytes
+    size_t getSize() const { return m_size; }
+
+    // the text of a 1-based line without its line terminator; false if the
+    // source has no such line
+    bool getLine(const uint32_t line, const char *&p_begin,
+                 size_t &p_length) const;
+};
+
+#endif
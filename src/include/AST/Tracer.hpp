@@ -0,0 +1,123 @@
+#ifndef AST_TRACER_H
+#define AST_TRACER_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Spans of time inside the compiler, written out as Chrome trace_event JSON
+ * (see --trace-out) for chrome://tracing or Perfetto.
+ *
+ * A Tracer collects the spans of a whole run. Each compilation records
+ * into a buffer of its own, installed on its thread by a Tracer::Scope and
+ * handed to the Tracer when the compilation is done, so the threads of a
+ * batch do not contend for it.
+ *
+ * Spans are placed with TRACE_SPAN. Without a buffer on the current thread
+ * a span is a thread-local load and a branch; built with -DNO_TRACE, it is
+ * nothing at all.
+ */
+class Tracer {
+  public:
+    struct Event {
+        const char *category;
+        const char *name;
+        // shown in the arguments of the span, e.g. the name of a function
+        std::string detail;
+        uint64_t start_ns;
+        uint64_t duration_ns;
+    };
+
+    struct Buffer {
+        std::vector<Event> events;
+        int32_t thread_id;
+    };
+
+    // installs a buffer for the spans of a compilation for the lifetime of
+    // the scope; does nothing without a tracer
+    class Scope {
+      private:
+        Tracer *m_tracer;
+        Buffer *m_previous;
+        std::unique_ptr<Buffer> m_buffer;
+
+      public:
+        ~Scope();
+        Scope(Tracer *p_tracer);
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    class Span {
+      private:
+        Buffer *m_buffer;
+        const char *m_category;
+        const char *m_name;
+        const char *m_detail;
+        uint64_t m_start_ns;
+
+        void finish();
+
+      public:
+        ~Span() {
+            if (m_buffer) {
+                finish();
+            }
+        }
+        // p_detail may be null and has to outlive the span
+        Span(const char *p_category, const char *p_name,
+             const char *p_detail = nullptr)
+            : m_buffer(getCurrentBuffer()) {
+            if (m_buffer) {
+                m_category = p_category;
+                m_name = p_name;
+                m_detail = p_detail;
+                m_start_ns = getTime();
+            }
+        }
+
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+    };
+
+  private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Buffer>> m_buffers;
+    // what the timestamps in the trace count from
+    uint64_t m_start_ns;
+
+    static Buffer *&getCurrentBuffer() {
+        static thread_local Buffer *buffer = nullptr;
+        return buffer;
+    }
+    // on the monotonic clock
+    static uint64_t getTime();
+
+  public:
+    ~Tracer() = default;
+    Tracer() : m_start_ns(getTime()) {}
+
+    Tracer(const Tracer &) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+
+    // write the spans of every compilation done so far; false on failure,
+    // with errno set
+    bool write(const std::string &p_path);
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+// TRACE_SPAN(category, name[, detail]) traces the rest of the block
+#ifdef NO_TRACE
+#define TRACE_SPAN(...) ((void)0)
+#else
+#define TRACE_SPAN(...)                                                        \
+    Tracer::Span TRACE_CONCAT(trace_span_, __LINE__)(__VA_ARGS__)
+#endif
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef AST_VARIABLE_REFERENCE_NODE_H
 #define AST_VARIABLE_REFERENCE_NODE_H
 
+#include "AST/Identifier.hpp"
 #include "AST/expression.hpp"
 #include "visitor/AstNodeVisitor.hpp"
 
@@ -8,33 +9,44 @@
 #include <string>
 #include <vector>
 
+class SymbolEntry;
+
 class VariableReferenceNode final : public ExpressionNode {
   public:
     using ExprNodes = std::vector<std::unique_ptr<ExpressionNode>>;
 
   private:
-    std::string m_name;
+    Identifier m_name;
     ExprNodes m_indices;
 
+    const SymbolEntry *m_symbol_entry_ptr = nullptr;
+
   public:
     ~VariableReferenceNode() = default;
 
     // normal reference
     VariableReferenceNode(const uint32_t line, const uint32_t col,
-                          const char *const p_name)
+                          const Identifier p_name)
         : ExpressionNode{line, col}, m_name(p_name){}
 
     // array reference
     VariableReferenceNode(const uint32_t line, const uint32_t col,
-                          const char *const p_name, ExprNodes &p_indices)
+                          const Identifier p_name, ExprNodes &p_indices)
         : ExpressionNode{line, col}, m_name(p_name),
           m_indices(std::move(p_indices)){}
 
-    const std::string &getName() const { return m_name; }
+    Identifier getIdentifier() const { return m_name; }
+    const std::string &getName() const { return m_name.str(); }
     const char *getNameCString() const { return m_name.c_str(); }
 
     const ExprNodes &getIndices() const { return m_indices; }
 
+    // resolved by the semantic analyzer
+    const SymbolEntry *getSymbolEntry() const { return m_symbol_entry_ptr; }
+    void setSymbolEntry(const SymbolEntry *p_entry) {
+        m_symbol_entry_ptr = p_entry;
+    }
+
     void accept(AstNodeVisitor &p_visitor) override { p_visitor.visit(*this); }
     void visitChildNodes(AstNodeVisitor &p_visitor) override;
 };
@@ -1,6 +1,7 @@
 #ifndef AST_AST_NODE_H
 #define AST_AST_NODE_H
 
+#include <cstddef>
 #include <cstdint>
 
 class AstNodeVisitor;
@@ -26,6 +27,10 @@ class AstNode {
     AstNode &operator=(const AstNode &) = delete;
     AstNode &operator=(AstNode &&) = delete;
 
+    // nodes live in the current AstArena and are released along with it
+    static void *operator new(const size_t size);
+    static void operator delete(void *) {}
+
     const Location &getLocation() const;
 
     virtual void accept(AstNodeVisitor &p_visitor) = 0;
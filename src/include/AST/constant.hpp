@@ -16,7 +16,7 @@ class Constant {
     };
 
   private:
-    PTypeSharedPtr m_type;
+    const PType *m_type;
     ConstantValue m_value;
     mutable std::string m_constant_value_string;
     mutable bool m_constant_value_string_is_valid = false;
@@ -28,11 +28,10 @@ class Constant {
             free(m_value.string);
         }
     }
-    Constant(const PTypeSharedPtr &p_type, const ConstantValue value)
+    Constant(const PType *const p_type, const ConstantValue value)
         : m_type(p_type), m_value(value) {}
 
-    const PType *getTypePtr() const { return m_type.get(); }
-    const PTypeSharedPtr &getTypeSharedPtr() const { return m_type; }
+    const PType *getTypePtr() const { return m_type; }
     const char *getConstantValueCString() const;
 
     decltype(m_value.integer) integer() const { return m_value.integer; }
@@ -18,7 +18,7 @@ class DeclNode final : public AstNode {
 
   private:
     void init(const std::vector<IdInfo> *const p_ids,
-              const PTypeSharedPtr &p_type,
+              const PType *const p_type,
               ConstantValueNode *const p_constant);
 
   public:
@@ -26,9 +26,9 @@ class DeclNode final : public AstNode {
 
     // variable declaration
     DeclNode(const uint32_t line, const uint32_t col,
-             const std::vector<IdInfo> *const p_ids, PType *p_type)
+             const std::vector<IdInfo> *const p_ids, const PType *p_type)
         : AstNode{line, col} {
-        init(p_ids, PTypeSharedPtr{p_type}, nullptr);
+        init(p_ids, p_type, nullptr);
     }
 
     // constant variable declaration
@@ -36,7 +36,7 @@ class DeclNode final : public AstNode {
              const std::vector<IdInfo> *const p_ids,
              ConstantValueNode *const p_constant)
         : AstNode{line, col} {
-        init(p_ids, p_constant->getTypeSharedPtr(), p_constant);
+        init(p_ids, p_constant->getTypePtr(), p_constant);
     }
 
     const VarNodes &getVariables() { return m_var_nodes; }
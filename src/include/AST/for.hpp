@@ -7,6 +7,7 @@
 #include "AST/expression.hpp"
 #include "AST/CompoundStatement.hpp"
 
+class SymbolEntry;
 class SymbolTable;
 
 class ForNode final : public AstNode {
@@ -30,7 +31,9 @@ class ForNode final : public AstNode {
     const ConstantValueNode &getLowerBound() const;
     const ConstantValueNode &getUpperBound() const;
 
+    Identifier getLoopVarIdentifier() const;
     const std::string &getLoopVarName() const;
+    const SymbolEntry *getLoopVarSymbolEntry() const;
 
     const DeclNode &getLoopVarDecl() const { return *m_loop_var_decl.get(); }
     const AssignmentNode &getLoopVarInitStmt() const {
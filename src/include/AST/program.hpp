@@ -1,6 +1,7 @@
 #ifndef AST_PROGRAM_NODE_H
 #define AST_PROGRAM_NODE_H
 
+#include "AST/Identifier.hpp"
 #include "AST/ast.hpp"
 #include "AST/decl.hpp"
 #include "AST/function.hpp"
@@ -17,8 +18,8 @@ class ProgramNode final : public AstNode {
     using FuncNodes = std::vector<std::unique_ptr<FunctionNode>>;
 
   private:
-    std::string m_name;
-    std::unique_ptr<PType> m_ret_type;
+    Identifier m_name;
+    const PType *m_ret_type;
     DeclNodes m_decl_nodes;
     FuncNodes m_func_nodes;
     std::unique_ptr<CompoundStatementNode> m_body;
@@ -28,7 +29,7 @@ class ProgramNode final : public AstNode {
   public:
     ~ProgramNode() = default;
     ProgramNode(const uint32_t line, const uint32_t col,
-                const char *const p_name, PType *const p_ret_type,
+                const Identifier p_name, const PType *const p_ret_type,
                 DeclNodes &p_decl_nodes, FuncNodes &p_func_nodes,
                 CompoundStatementNode *const p_body)
         : AstNode{line, col}, m_name(p_name), m_ret_type(p_ret_type),
@@ -36,9 +37,10 @@ class ProgramNode final : public AstNode {
           m_func_nodes(std::move(p_func_nodes)), m_body(p_body) {}
 
     const char *getNameCString() const { return m_name.c_str(); }
-    const std::string &getName() const { return m_name; }
+    Identifier getIdentifier() const { return m_name; }
+    const std::string &getName() const { return m_name.str(); }
 
-    const PType *getTypePtr() const { return m_ret_type.get(); }
+    const PType *getTypePtr() const { return m_ret_type; }
 
     const DeclNodes &getDeclNodes() const { return m_decl_nodes; }
     const FuncNodes &getFuncNodes() const { return m_func_nodes; }
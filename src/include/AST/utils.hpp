@@ -1,6 +1,7 @@
 #ifndef AST_UTILS_H
 #define AST_UTILS_H
 
+#include "AST/Identifier.hpp"
 #include "AST/ast.hpp"
 
 #include <cstdint>
@@ -9,9 +10,9 @@
 // for carrying identifier info through IdList
 struct IdInfo {
     Location location;
-    std::string id;
+    Identifier id;
 
-    IdInfo(const uint32_t line, const uint32_t col, const char * const p_id)
+    IdInfo(const uint32_t line, const uint32_t col, const Identifier p_id)
         : location(line, col), id(p_id) {}
 };
 
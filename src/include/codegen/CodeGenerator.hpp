@@ -1,15 +1,19 @@
 #ifndef CODEGEN_CODE_GENERATOR_H
 #define CODEGEN_CODE_GENERATOR_H
 
+#include "codegen/Ir.hpp"
+#include "codegen/IrBuilder.hpp"
+#include "codegen/SsaBuilder.hpp"
+#include "opt/Optimizer.hpp"
 #include "sema/SymbolTable.hpp"
 #include "visitor/AstNodeVisitor.hpp"
 
-#include <map>
 #include <memory>
 #include <stack>
 #include <utility>
 
-int fclose(FILE *);
+class ExpressionNode;
+class TimeReport;
 
 class CodeGenerator final : public AstNodeVisitor {
   private:
@@ -18,63 +22,79 @@ class CodeGenerator final : public AstNodeVisitor {
         kLocal
     };
 
-    struct FileDeleter {
-        void operator()(FILE *fp) const {
-            fclose(fp);
-        }
-    };
-
   private:
     union StackValue {
       int d;
       bool b;
-      int reg; // llvm register
+      IrValue *reg; // llvm value
       float f;
       const char *str;
-      const char *global_var;
     };
     std::stack<StackValue> m_value_stack;
+    // INT and BOOL entries are literals known at compile time
     enum class CurrentValueType {
       INT,
       BOOL,
       REG,
       FLOAT,
-      STR,
-      GLOBAL
+      STR
     };
     std::stack<CurrentValueType> m_type_stack;
 
-    // In llvm ir, we can't put br after ret or generate a label for empty basic blocks.
-    // To deal with if statements that constain ret, we need a variabel to indicate
-    // weather there are any ret in "if clause" or "else clause".
-    bool has_ret; 
-
-    // When an array is passed as an argument, it is "passed by pointer",
-    // the corresponding llvm ir is different with the case when dealing main function.
-    std::stack<bool> call_stack; // it should be empty when dealing main function
-
-    bool dealing_params = false;
-
-    const SymbolManager *m_symbol_manager_ptr;
     std::string m_source_file_path;
-    std::unique_ptr<FILE, FileDeleter> m_output_file;
+    // not owned, the module is written to it in one go once it is complete
+    int m_output_fd;
+    // not owned, where the same bytes go for the compile cache
+    int m_module_copy_fd = -1;
+    bool m_is_module_copied = false;
+    // what is done to the module before it is written
+    OptimizerOptions m_optimizer_options;
+    // not owned, the optimizer is charged to kOptimize there if set
+    TimeReport *m_time_report = nullptr;
+
+    // The whole module is built in memory and written out once at the end.
+    IrModule m_module;
+    IrBuilder m_builder;
+    IrFunction *m_printf = nullptr;
+    IrFunction *m_scanf = nullptr;
+    IrValue *m_format_string = nullptr;
+
+    // keep scalar locals in SSA registers instead of allocas
+    bool m_use_ssa;
+    SsaBuilder m_ssa;
 
     std::stack<CodegenContext> m_context_stack;
 
-    size_t m_local_var_offset = 0;
-    std::map<const SymbolEntry *, size_t> m_local_var_offset_map;
+    // The address of each variable (alloca or global) and each function is
+    // kept in the codegen slot of its symbol entry, scalar locals tracked by
+    // m_ssa have none.
 
     bool m_ref_to_value = false;
 
-    size_t m_label_sequence = 1;
-    size_t m_comp_branch_true_label = 0;
-    size_t m_comp_branch_false_label = 0;
-
   public:
     ~CodeGenerator() = default;
-    CodeGenerator(const std::string source_file_name,
-                  const std::string save_path,
-                  const SymbolManager *const p_symbol_manager);
+    CodeGenerator(const std::string source_file_name, const int output_fd,
+                  const bool use_ssa = false);
+
+    // <save_path>/<source file name without extension>.ll
+    static std::string getOutputFilePath(const std::string &source_file_name,
+                                         const std::string &save_path);
+
+    // also write the module to p_fd, see CompileCache
+    void setModuleCopyFd(const int p_fd) { m_module_copy_fd = p_fd; }
+    void setOptimizerOptions(const OptimizerOptions &p_options) {
+        m_optimizer_options = p_options;
+    }
+    // see --time-report
+    void setTimeReport(TimeReport *const p_report) {
+        m_time_report = p_report;
+    }
+    // whether all of the module made it to the copy
+    bool isModuleCopied() const { return m_is_module_copied; }
+    // in the module generated, see --time-report
+    size_t getNumInstructions() const {
+        return m_module.getNumInstructions();
+    }
 
     void visit(ProgramNode &p_program) override;
     void visit(DeclNode &p_decl) override;
@@ -104,13 +124,31 @@ class CodeGenerator final : public AstNodeVisitor {
     // void
     // storeArgumentsToParameters(const FunctionNode::DeclNodes &p_parameters);
 
+    const IrType *getIrType(const PType *const p_type,
+                            const bool is_parameter);
+
+    void generateShortCircuit(BinaryOperatorNode &p_bin_op);
+    // branch on p_condition without materializing and/or/not as values
+    void generateCondition(const ExpressionNode &p_condition,
+                           IrBasicBlock *const p_true_block,
+                           IrBasicBlock *const p_false_block);
+
     void pushIntToStack(int d);
     void pushBoolToStack(int b);
-    void pushRegToStack(int reg);
+    void pushRegToStack(IrValue *reg);
+    // constants are pushed as literals so that they can be folded
+    void pushIrValueToStack(IrValue *value);
     void pushFloatToStack(float f);
     void pushStrToStack(const char *str);
-    void pushGlobalVarToStack(const char *global_var);
     std::pair<StackValue, CurrentValueType> popFromStack();
+    static bool isLiteral(const CurrentValueType type) {
+        return type == CurrentValueType::INT || type == CurrentValueType::BOOL;
+    }
+    static int32_t
+    getLiteral(const std::pair<StackValue, CurrentValueType> &value_type);
+    // pop a value and materialize literals as IR constants
+    IrValue *popIrValueFromStack();
+    IrValue *materialize(const std::pair<StackValue, CurrentValueType> &value_type);
 };
 
 #endif
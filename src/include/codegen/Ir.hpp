@@ -0,0 +1,477 @@
+#ifndef CODEGEN_IR_H
+#define CODEGEN_IR_H
+
+#include "codegen/OutputBuffer.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * A small in-memory representation of the LLVM IR we emit. The code
+ * generator fills it in while walking the AST; nothing is written until the
+ * whole module has been built, so branch targets can be referenced before
+ * their blocks exist and value/label numbers are only assigned when the
+ * module is printed.
+ */
+
+class IrModule;
+class IrFunction;
+class IrBasicBlock;
+
+class IrType {
+  public:
+    enum class TypeEnum : uint8_t {
+        kVoidType,
+        kIntegerType,
+        kPointerType,
+        kArrayType,
+        kLabelType
+    };
+
+  private:
+    TypeEnum m_type;
+    uint32_t m_bits = 0;
+    const IrType *m_element_type = nullptr;
+    uint64_t m_num_elements = 0;
+    std::string m_name;
+
+  public:
+    ~IrType() = default;
+    IrType(const TypeEnum type, const uint32_t bits,
+           const IrType *const p_element_type, const uint64_t num_elements);
+
+    TypeEnum getType() const { return m_type; }
+    uint32_t getBits() const { return m_bits; }
+    const IrType *getElementType() const { return m_element_type; }
+    uint64_t getNumElements() const { return m_num_elements; }
+
+    const std::string &getName() const { return m_name; }
+    const char *getNameCString() const { return m_name.c_str(); }
+
+    bool isVoid() const { return m_type == TypeEnum::kVoidType; }
+    bool isInteger() const { return m_type == TypeEnum::kIntegerType; }
+    bool isPointer() const { return m_type == TypeEnum::kPointerType; }
+    bool isArray() const { return m_type == TypeEnum::kArrayType; }
+
+    // natural alignment used for alloca/load/store
+    uint32_t getAlignment() const;
+};
+
+class IrValue {
+  public:
+    enum class KindEnum : uint8_t {
+        kConstantInt,
+        kConstantExpr,
+        kGlobalVariable,
+        kFunction,
+        kArgument,
+        kBasicBlock,
+        kInstruction
+    };
+
+  private:
+    KindEnum m_kind;
+    const IrType *m_type;
+
+  protected:
+    // assigned by the printer, see IrFunction::numberValues()
+    mutable int64_t m_slot = -1;
+
+    friend class IrFunction;
+
+  public:
+    virtual ~IrValue() = default;
+    IrValue(const KindEnum kind, const IrType *const p_type)
+        : m_kind(kind), m_type(p_type) {}
+
+    IrValue(const IrValue &) = delete;
+    IrValue &operator=(const IrValue &) = delete;
+
+    KindEnum getKind() const { return m_kind; }
+    const IrType *getType() const { return m_type; }
+
+    int64_t getSlot() const { return m_slot; }
+
+    // prints the reference form, e.g. "%3", "@gv" or "42"
+    virtual void printAsOperand(OutputBuffer &p_out) const;
+};
+
+class IrConstantInt final : public IrValue {
+  private:
+    int64_t m_value;
+
+  public:
+    ~IrConstantInt() = default;
+    IrConstantInt(const IrType *const p_type, const int64_t value)
+        : IrValue(KindEnum::kConstantInt, p_type), m_value(value) {}
+
+    int64_t getValue() const { return m_value; }
+
+    void printAsOperand(OutputBuffer &p_out) const override;
+};
+
+// an opaque constant expression kept in its textual form
+class IrConstantExpr final : public IrValue {
+  private:
+    std::string m_text;
+
+  public:
+    ~IrConstantExpr() = default;
+    IrConstantExpr(const IrType *const p_type, const std::string &p_text)
+        : IrValue(KindEnum::kConstantExpr, p_type), m_text(p_text) {}
+
+    void printAsOperand(OutputBuffer &p_out) const override {
+        p_out.append(m_text);
+    }
+};
+
+class IrGlobalVariable final : public IrValue {
+  private:
+    std::string m_name;
+    const IrType *m_value_type;
+    // printed verbatim, e.g. "global i32 0, align 4"
+    std::string m_definition;
+
+  public:
+    ~IrGlobalVariable() = default;
+    IrGlobalVariable(const IrType *const p_pointer_type,
+                     const IrType *const p_value_type,
+                     const std::string &p_name,
+                     const std::string &p_definition)
+        : IrValue(KindEnum::kGlobalVariable, p_pointer_type), m_name(p_name),
+          m_value_type(p_value_type), m_definition(p_definition) {}
+
+    const std::string &getName() const { return m_name; }
+    const IrType *getValueType() const { return m_value_type; }
+
+    void printAsOperand(OutputBuffer &p_out) const override {
+        p_out.append("@").append(m_name);
+    }
+    void print(OutputBuffer &p_out) const;
+};
+
+class IrArgument final : public IrValue {
+  public:
+    ~IrArgument() = default;
+    IrArgument(const IrType *const p_type)
+        : IrValue(KindEnum::kArgument, p_type) {}
+};
+
+class IrInstruction final : public IrValue {
+  public:
+    enum class OpcodeEnum : uint8_t {
+        kAlloca,
+        kLoad,
+        kStore,
+        kGetElementPtr,
+        kAdd,
+        kSub,
+        kMul,
+        kSDiv,
+        kSRem,
+        kAnd,
+        kOr,
+        kXor,
+        kICmp,
+        kPhi,
+        kCall,
+        kBr,
+        kCondBr,
+        kRet,
+        kUnreachable
+    };
+
+    enum class PredicateEnum : uint8_t {
+        kEq,
+        kNe,
+        kSlt,
+        kSle,
+        kSgt,
+        kSge
+    };
+
+    // what a call may do to the frame of the caller, see
+    // TailCallElimination
+    enum class TailCallEnum : uint8_t { kNone, kTail, kMustTail };
+
+  private:
+    OpcodeEnum m_opcode;
+    std::vector<IrValue *> m_operands;
+    IrBasicBlock *m_parent = nullptr;
+
+    // opcode specific data
+    PredicateEnum m_predicate = PredicateEnum::kEq;
+    TailCallEnum m_tail_call = TailCallEnum::kNone;
+    // allocated type of alloca, source element type of getelementptr
+    const IrType *m_aux_type = nullptr;
+    std::string m_comment;
+
+  public:
+    ~IrInstruction() = default;
+    IrInstruction(const OpcodeEnum opcode, const IrType *const p_type,
+                  std::vector<IrValue *> p_operands)
+        : IrValue(KindEnum::kInstruction, p_type), m_opcode(opcode),
+          m_operands(std::move(p_operands)) {}
+
+    OpcodeEnum getOpcode() const { return m_opcode; }
+    const char *getOpcodeCString() const;
+
+    // the same instruction with the same operands, not in any block yet
+    IrInstruction *clone() const;
+
+    const std::vector<IrValue *> &getOperands() const { return m_operands; }
+    IrValue *getOperand(const size_t nth) const { return m_operands[nth]; }
+    void setOperand(const size_t nth, IrValue *const p_value) {
+        m_operands[nth] = p_value;
+    }
+
+    // phi operands are stored as (value, incoming block) pairs
+    void addIncoming(IrValue *const p_value, IrBasicBlock *const p_block);
+    // drop one pair coming from p_block
+    void removeIncoming(IrBasicBlock *const p_block);
+    // the value coming from p_block, null if there is none
+    IrValue *getIncomingValue(const IrBasicBlock *const p_block) const;
+    void setIncomingValue(const IrBasicBlock *const p_block,
+                          IrValue *const p_value);
+
+    IrBasicBlock *getParent() const { return m_parent; }
+    void setParent(IrBasicBlock *const p_parent) { m_parent = p_parent; }
+
+    PredicateEnum getPredicate() const { return m_predicate; }
+    void setPredicate(const PredicateEnum predicate) {
+        m_predicate = predicate;
+    }
+
+    TailCallEnum getTailCall() const { return m_tail_call; }
+    void setTailCall(const TailCallEnum tail_call) { m_tail_call = tail_call; }
+
+    const IrType *getAuxType() const { return m_aux_type; }
+    void setAuxType(const IrType *const p_type) { m_aux_type = p_type; }
+
+    void setComment(const std::string &p_comment) { m_comment = p_comment; }
+
+    bool isTerminator() const {
+        return m_opcode == OpcodeEnum::kBr ||
+               m_opcode == OpcodeEnum::kCondBr ||
+               m_opcode == OpcodeEnum::kRet ||
+               m_opcode == OpcodeEnum::kUnreachable;
+    }
+    bool isPhi() const { return m_opcode == OpcodeEnum::kPhi; }
+    bool hasResult() const { return !getType()->isVoid(); }
+    // whether it may be removed once its result is unused
+    bool hasSideEffects() const {
+        return m_opcode == OpcodeEnum::kStore ||
+               m_opcode == OpcodeEnum::kCall || isTerminator();
+    }
+    bool isCommutative() const;
+
+    void print(OutputBuffer &p_out) const;
+};
+
+class IrBasicBlock final : public IrValue {
+  public:
+    using Instructions = std::vector<std::unique_ptr<IrInstruction>>;
+
+  private:
+    Instructions m_instructions;
+    IrFunction *m_parent;
+    std::string m_comment;
+    // one entry per incoming edge, in the order the branches were created
+    std::vector<IrBasicBlock *> m_predecessors;
+
+  public:
+    ~IrBasicBlock() = default;
+    IrBasicBlock(const IrType *const p_label_type, IrFunction *const p_parent,
+                 const std::string &p_comment)
+        : IrValue(KindEnum::kBasicBlock, p_label_type), m_parent(p_parent),
+          m_comment(p_comment) {}
+
+    IrFunction *getParent() const { return m_parent; }
+
+    const Instructions &getInstructions() const { return m_instructions; }
+    bool empty() const { return m_instructions.empty(); }
+
+    IrInstruction *getTerminator() const;
+    // the targets of the terminator, one entry per edge
+    std::vector<IrBasicBlock *> getSuccessors() const;
+
+    IrInstruction *append(IrInstruction *const p_inst);
+    // phi nodes have to stay grouped at the top of the block
+    IrInstruction *insertPhi(IrInstruction *const p_phi);
+    IrInstruction *insertBefore(IrInstruction *const p_position,
+                                IrInstruction *const p_inst);
+    std::unique_ptr<IrInstruction> remove(IrInstruction *const p_inst);
+    // the same for all of p_insts found here, appended to p_removed
+    void remove(const std::unordered_set<IrInstruction *> &p_insts,
+                Instructions &p_removed);
+    // move all instructions of p_block to the end of this one
+    void splice(IrBasicBlock *const p_block);
+    // move the instructions after p_position to the end of p_block
+    void splitAfter(IrInstruction *const p_position,
+                    IrBasicBlock *const p_block);
+
+    const std::vector<IrBasicBlock *> &getPredecessors() const {
+        return m_predecessors;
+    }
+    void addPredecessor(IrBasicBlock *const p_block) {
+        m_predecessors.emplace_back(p_block);
+    }
+    // drop one edge from p_block, along with its incoming values in the phis
+    void removePredecessor(IrBasicBlock *const p_block);
+    // the edges from p_from come from p_to now, in the phis as well
+    void replacePredecessor(IrBasicBlock *const p_from,
+                            IrBasicBlock *const p_to);
+
+    void print(OutputBuffer &p_out, const bool print_label) const;
+};
+
+class IrFunction final : public IrValue {
+  public:
+    using Arguments = std::vector<std::unique_ptr<IrArgument>>;
+    using BasicBlocks = std::vector<std::unique_ptr<IrBasicBlock>>;
+
+  private:
+    std::string m_name;
+    const IrType *m_return_type;
+    Arguments m_arguments;
+    bool m_is_var_arg = false;
+
+    // blocks in layout order
+    BasicBlocks m_blocks;
+    // blocks that have been created but not placed yet
+    BasicBlocks m_detached_blocks;
+    // instructions taken out of their blocks; kept alive since callers may
+    // still hold pointers to them
+    IrBasicBlock::Instructions m_erased_instructions;
+    // the same for blocks taken out of the layout
+    BasicBlocks m_erased_blocks;
+
+    IrModule &m_module;
+
+  public:
+    ~IrFunction() = default;
+    IrFunction(IrModule &p_module, const std::string &p_name,
+               const IrType *const p_return_type,
+               const std::vector<const IrType *> &p_param_types,
+               const bool is_var_arg);
+
+    const std::string &getName() const { return m_name; }
+    const IrType *getReturnType() const { return m_return_type; }
+
+    const Arguments &getArguments() const { return m_arguments; }
+    IrArgument *getArgument(const size_t nth) const {
+        return m_arguments[nth].get();
+    }
+
+    bool isVarArg() const { return m_is_var_arg; }
+    bool isDeclaration() const { return m_blocks.empty(); }
+
+    const BasicBlocks &getBasicBlocks() const { return m_blocks; }
+    IrBasicBlock *getEntryBlock() const { return m_blocks.front().get(); }
+
+    // create a block that is not yet part of the layout
+    IrBasicBlock *createBasicBlock(const std::string &p_comment = "");
+    // place a block created by createBasicBlock() in the layout, before
+    // p_position or at the end
+    void insertBasicBlock(IrBasicBlock *const p_block,
+                          IrBasicBlock *const p_position = nullptr);
+    // the same for several blocks, in this order, in one go
+    void insertBasicBlocks(const std::vector<IrBasicBlock *> &p_blocks,
+                           IrBasicBlock *const p_position = nullptr);
+
+    // rewrite every operand referring to p_from, returns the instructions
+    // that have been changed
+    std::vector<IrInstruction *> replaceAllUsesWith(IrValue *const p_from,
+                                                    IrValue *const p_to);
+    // the same for a whole set of values at once, following chains of
+    // replacements (a -> b, b -> c rewrites a to c)
+    void replaceAllUsesWith(
+        const std::unordered_map<IrValue *, IrValue *> &p_replacements);
+    void eraseInstruction(IrInstruction *const p_inst);
+    // in one sweep over the function, keeping the order of the rest
+    void eraseInstructions(
+        const std::unordered_set<IrInstruction *> &p_insts);
+    // take p_block out of the layout; its instructions go with it
+    void eraseBasicBlock(IrBasicBlock *const p_block);
+    // in one sweep over the layout, keeping the order of the rest
+    void eraseBasicBlocks(const std::unordered_set<IrBasicBlock *> &p_blocks);
+
+    // "i32 (i8*, ...)" for variadic callees, otherwise just the return type
+    void printCallSignature(OutputBuffer &p_out) const;
+
+    void printAsOperand(OutputBuffer &p_out) const override {
+        p_out.append("@").append(m_name);
+    }
+    void print(OutputBuffer &p_out) const;
+
+  private:
+    void numberValues() const;
+};
+
+class IrModule {
+  public:
+    using GlobalVariables = std::vector<std::unique_ptr<IrGlobalVariable>>;
+    using Functions = std::vector<std::unique_ptr<IrFunction>>;
+
+  private:
+    // source_filename, datalayout and target triple lines
+    std::string m_header;
+
+    GlobalVariables m_globals;
+    Functions m_functions;
+
+    // uniqued types and constants
+    std::map<std::tuple<IrType::TypeEnum, uint32_t, const IrType *, uint64_t>,
+             std::unique_ptr<IrType>>
+        m_types;
+    std::map<std::pair<const IrType *, int64_t>,
+             std::unique_ptr<IrConstantInt>>
+        m_constants;
+    std::vector<std::unique_ptr<IrConstantExpr>> m_constant_exprs;
+
+  public:
+    ~IrModule() = default;
+    IrModule(const std::string &p_header) : m_header(p_header) {}
+
+    IrModule(const IrModule &) = delete;
+    IrModule &operator=(const IrModule &) = delete;
+
+    const IrType *getVoidType();
+    const IrType *getLabelType();
+    const IrType *getIntegerType(const uint32_t bits);
+    const IrType *getPointerType(const IrType *const p_element_type);
+    const IrType *getArrayType(const IrType *const p_element_type,
+                               const uint64_t num_elements);
+
+    IrConstantInt *getConstantInt(const IrType *const p_type,
+                                  const int64_t value);
+    IrConstantExpr *createConstantExpr(const IrType *const p_type,
+                                       const std::string &p_text);
+
+    IrGlobalVariable *createGlobalVariable(const IrType *const p_value_type,
+                                           const std::string &p_name,
+                                           const std::string &p_definition);
+    IrFunction *createFunction(const std::string &p_name,
+                               const IrType *const p_return_type,
+                               const std::vector<const IrType *> &p_param_types,
+                               const bool is_var_arg = false);
+
+    const Functions &getFunctions() const { return m_functions; }
+    // in the bodies of all functions
+    size_t getNumInstructions() const;
+
+    void print(OutputBuffer &p_out) const;
+
+  private:
+    const IrType *getType(const IrType::TypeEnum type, const uint32_t bits,
+                          const IrType *const p_element_type,
+                          const uint64_t num_elements);
+};
+
+#endif
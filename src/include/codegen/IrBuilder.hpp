@@ -0,0 +1,74 @@
+#ifndef CODEGEN_IR_BUILDER_H
+#define CODEGEN_IR_BUILDER_H
+
+#include "codegen/Ir.hpp"
+
+#include <string>
+#include <vector>
+
+/*
+ * Appends instructions to the current insertion block and derives result
+ * types, so the code generator only has to name the operation.
+ */
+class IrBuilder {
+  private:
+    IrModule &m_module;
+    IrFunction *m_function = nullptr;
+    IrBasicBlock *m_insert_block = nullptr;
+
+  public:
+    ~IrBuilder() = default;
+    IrBuilder(IrModule &p_module) : m_module(p_module) {}
+
+    IrModule &getModule() const { return m_module; }
+
+    IrFunction *getFunction() const { return m_function; }
+    IrBasicBlock *getInsertBlock() const { return m_insert_block; }
+
+    // start filling the entry block of p_function
+    void setFunction(IrFunction *const p_function);
+
+    IrBasicBlock *createBasicBlock(const std::string &p_comment = "");
+    // place p_block after the current blocks and continue inserting there
+    void setInsertPoint(IrBasicBlock *const p_block);
+
+    bool isTerminated() const;
+
+    IrConstantInt *getInt1(const bool value);
+    IrConstantInt *getInt32(const int64_t value);
+    IrConstantInt *getInt64(const int64_t value);
+
+    IrInstruction *createAlloca(const IrType *const p_type,
+                                const std::string &p_comment = "");
+    // at the top of the entry block, so it is allocated once per call
+    // wherever it is asked for
+    IrInstruction *createEntryAlloca(const IrType *const p_type,
+                                     const std::string &p_comment = "");
+    IrInstruction *createLoad(IrValue *const p_ptr);
+    IrInstruction *createStore(IrValue *const p_value, IrValue *const p_ptr,
+                               const std::string &p_comment = "");
+    IrInstruction *createGetElementPtr(IrValue *const p_ptr,
+                                       const std::vector<IrValue *> &p_indices);
+
+    IrInstruction *createBinary(const IrInstruction::OpcodeEnum opcode,
+                                IrValue *const p_lhs, IrValue *const p_rhs);
+    IrInstruction *createICmp(const IrInstruction::PredicateEnum predicate,
+                              IrValue *const p_lhs, IrValue *const p_rhs);
+    // an empty phi at the top of p_block, see IrInstruction::addIncoming()
+    IrInstruction *createPhi(IrBasicBlock *const p_block,
+                             const IrType *const p_type);
+    IrInstruction *createCall(IrFunction *const p_callee,
+                              const std::vector<IrValue *> &p_args);
+
+    IrInstruction *createBr(IrBasicBlock *const p_target);
+    IrInstruction *createCondBr(IrValue *const p_condition,
+                                IrBasicBlock *const p_true_block,
+                                IrBasicBlock *const p_false_block);
+    IrInstruction *createRet(IrValue *const p_value);
+    IrInstruction *createUnreachable();
+
+  private:
+    IrInstruction *insert(IrInstruction *const p_inst);
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef CODEGEN_OUTPUT_BUFFER_H
+#define CODEGEN_OUTPUT_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Append-only buffer the module is printed into. Text goes into fixed-size
+ * chunks, so growing never copies what has been written, and the chunks
+ * are handed to the kernel in one writev(2) at the end.
+ */
+class OutputBuffer {
+  private:
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    // sizes of all chunks but the last one, which ends at m_cursor
+    std::vector<size_t> m_chunk_sizes;
+    char *m_cursor = nullptr;
+    char *m_end = nullptr;
+
+    void appendSlow(const char *p_data, size_t length);
+
+  public:
+    ~OutputBuffer() = default;
+    OutputBuffer() = default;
+
+    OutputBuffer(const OutputBuffer &) = delete;
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    OutputBuffer &append(const char *p_data, const size_t length) {
+        if (length <= static_cast<size_t>(m_end - m_cursor)) {
+            memcpy(m_cursor, p_data, length);
+            m_cursor += length;
+        } else {
+            appendSlow(p_data, length);
+        }
+        return *this;
+    }
+    OutputBuffer &append(const char *p_str) {
+        return append(p_str, strlen(p_str));
+    }
+    OutputBuffer &append(const std::string &p_str) {
+        return append(p_str.data(), p_str.size());
+    }
+    OutputBuffer &append(const char c) {
+        if (m_cursor == m_end) {
+            appendSlow(&c, 1);
+        } else {
+            *m_cursor++ = c;
+        }
+        return *this;
+    }
+
+    // decimal formatting without going through std::to_string or printf
+    OutputBuffer &appendInt(const int64_t value);
+    OutputBuffer &appendUInt(uint64_t value);
+
+    size_t size() const;
+
+    // write everything to p_fd, retrying on partial writes; false on error
+    bool writeTo(const int p_fd) const;
+};
+
+#endif
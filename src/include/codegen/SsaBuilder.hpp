@@ -0,0 +1,70 @@
+#ifndef CODEGEN_SSA_BUILDER_H
+#define CODEGEN_SSA_BUILDER_H
+
+#include "codegen/Ir.hpp"
+#include "codegen/IrBuilder.hpp"
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+class SymbolEntry;
+
+/*
+ * On-the-fly SSA construction as described by Braun et al., "Simple and
+ * Efficient Construction of Static Single Assignment Form" (CC 2013).
+ *
+ * Scalar locals are tracked as a current definition per basic block instead
+ * of living in an alloca. Reading a variable in a block without a local
+ * definition looks it up in the predecessors and places a phi where they
+ * may disagree. Blocks whose predecessors are not all known yet (loop
+ * heads) must be marked as unsealed; the phis requested there stay
+ * incomplete until sealBlock() is called.
+ */
+class SsaBuilder {
+  private:
+    using Variable = const SymbolEntry *;
+
+    IrBuilder &m_builder;
+
+    std::map<Variable, const IrType *> m_variable_types;
+    std::map<Variable, std::map<IrBasicBlock *, IrValue *>> m_current_defs;
+
+    std::set<IrBasicBlock *> m_unsealed_blocks;
+    std::map<IrBasicBlock *, std::vector<std::pair<Variable, IrInstruction *>>>
+        m_incomplete_phis;
+
+  public:
+    ~SsaBuilder() = default;
+    SsaBuilder(IrBuilder &p_builder) : m_builder(p_builder) {}
+
+    void declareVariable(Variable p_variable, const IrType *const p_type);
+    bool isTracked(Variable p_variable) const {
+        return m_variable_types.count(p_variable);
+    }
+    const IrType *getVariableType(Variable p_variable) const {
+        return m_variable_types.at(p_variable);
+    }
+
+    void writeVariable(Variable p_variable, IrBasicBlock *const p_block,
+                       IrValue *const p_value);
+    IrValue *readVariable(Variable p_variable, IrBasicBlock *const p_block);
+
+    void addUnsealedBlock(IrBasicBlock *const p_block) {
+        m_unsealed_blocks.insert(p_block);
+    }
+    // all predecessors of p_block are known, complete its pending phis
+    void sealBlock(IrBasicBlock *const p_block);
+
+    // forget everything about the previous function
+    void clear();
+
+  private:
+    IrValue *readVariableRecursive(Variable p_variable,
+                                   IrBasicBlock *const p_block);
+    IrValue *addPhiOperands(Variable p_variable, IrInstruction *const p_phi);
+    IrValue *tryRemoveTrivialPhi(IrInstruction *const p_phi);
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef DRIVER_ALLOCATION_COUNTER_H
+#define DRIVER_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+/*
+ * Counts what the current thread allocates through operator new, which is
+ * what the standard containers of the passes and the chunks of the
+ * AstArena go through. The counters only ever grow; take the difference
+ * over a stretch of code to see what it allocated, see TimeReport.
+ *
+ * The replacement operator new that keeps them is always linked in; it
+ * costs two thread-local additions per allocation.
+ */
+class AllocationCounter {
+  public:
+    static uint64_t getNumAllocations();
+    static uint64_t getAllocatedBytes();
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef DRIVER_COMPILATION_CONTEXT_H
+#define DRIVER_COMPILATION_CONTEXT_H
+
+#include "AST/AstArena.hpp"
+#include "AST/SourceBuffer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class ProgramNode;
+class TimeReport;
+
+// A production build (-DPRODUCTION) compiles the source listing and the
+// token echo out of the scanner; //&S and //&T are accepted but ignored, and
+// the symbol table dump is off unless //&D+ asks for it.
+#ifdef PRODUCTION
+constexpr bool kScannerEcho = false;
+#else
+constexpr bool kScannerEcho = true;
+#endif
+
+// what the reentrant scanner keeps between tokens, see scanner.l
+struct ScannerState {
+    uint32_t line_num = 1;
+    uint32_t col_num = 1;
+    // The source is scanned in place, so the current line is the text from
+    // here up to the current token.
+    const char *line_start = nullptr;
+
+    // set by the pseudocomments //&S, //&T and //&D
+    bool opt_src = kScannerEcho;
+    bool opt_tok = kScannerEcho;
+    bool opt_dmp = kScannerEcho;
+
+    // a bad character has been reported, the parse is being aborted
+    bool has_lexical_error = false;
+
+    // the tokens returned so far
+    size_t num_tokens = 0;
+    // what the scanner takes is charged to TimeReport::PhaseEnum::kLex if
+    // set, see --time-report
+    TimeReport *time_report = nullptr;
+};
+
+/*
+ * Everything a single compilation owns: the source, the AST and the state
+ * of the scanner and the parser working on them. The scanner and the parser
+ * are reentrant and keep nothing in globals, so compilations with separate
+ * contexts can run at the same time on different threads.
+ */
+class CompilationContext {
+  private:
+    std::string m_source_path;
+    SourceBuffer m_source;
+    std::unique_ptr<AstArena> m_arena;
+    ScannerState m_scanner_state;
+    ProgramNode *m_root = nullptr;
+
+    // A one-shot compiler leaves what the tree owns to the exit of the
+    // process. A long-running one destroys the tree and hands the arena
+    // back for the next compilation.
+    bool m_recycle_memory;
+
+  public:
+    ~CompilationContext();
+    CompilationContext(const std::string &p_source_path,
+                       const bool p_recycle_memory = false)
+        : m_source_path(p_source_path), m_arena(AstArena::acquire()),
+          m_recycle_memory(p_recycle_memory) {}
+
+    CompilationContext(const CompilationContext &) = delete;
+    CompilationContext &operator=(const CompilationContext &) = delete;
+
+    // map the source file; false if it cannot be read
+    bool open() { return open(m_source_path); }
+    // the same, but the file is at p_file_path, e.g. when the source path is
+    // relative to the working directory of a client of the server
+    bool open(const std::string &p_file_path) {
+        return m_source.open(p_file_path.c_str());
+    }
+
+    // Build the AST of the source into the arena of this context. false on
+    // a lexical or syntax error, which has been reported already. Defined
+    // in parser.y, next to the grammar.
+    bool parse();
+    // run the scanner alone over the whole source, see --lex-only
+    size_t countTokens();
+
+    const std::string &getSourcePath() const { return m_source_path; }
+    const SourceBuffer &getSource() const { return m_source; }
+    SourceBuffer &getSource() { return m_source; }
+    const AstArena &getArena() const { return *m_arena; }
+
+    ScannerState &getScannerState() { return m_scanner_state; }
+    const ScannerState &getScannerState() const { return m_scanner_state; }
+
+    ProgramNode *getRoot() const { return m_root; }
+    // set by the parser
+    void setRoot(ProgramNode *const p_root) { m_root = p_root; }
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef DRIVER_COMPILE_CACHE_H
+#define DRIVER_COMPILE_CACHE_H
+
+#include "driver/Sha256.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * An on-disk store of compilation results, addressed by a hash of all they
+ * depend on: the bytes of the source, its path (the module names it in
+ * source_filename), the options that change the output and the identity of
+ * the compiler executable.
+ *
+ * An entry is a pair of files named by its key: <key>.ll is the module as
+ * written by the CodeGenerator (missing if there were errors) and <key>.log
+ * the exit status and whatever the compilation printed, so that a hit can
+ * be replayed without even lexing the source. The modification time of the
+ * log is the last use; once the store grows past its limit, the least
+ * recently used entries are evicted.
+ *
+ * The store may be shared by any number of compilers at once: entries are
+ * renamed into place and the statistics are updated under flock(2).
+ */
+class CompileCache {
+  public:
+    using Key = Sha256::Digest;
+
+    struct Statistics {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t evictions = 0;
+        uint64_t num_entries = 0;
+        uint64_t size_bytes = 0;
+    };
+
+    // what a compilation produced besides the module
+    struct Result {
+        int32_t status = 0;
+        bool has_module = false;
+        std::string out;
+        std::string err;
+    };
+
+  private:
+    std::string m_directory;
+    uint64_t m_max_bytes;
+
+    std::string getEntryPath(const Key &p_key, const char *p_suffix) const;
+    // run p_update on the statistics with the store locked
+    template <typename Update> void updateStatistics(Update p_update) const;
+    // remove the least recently used entries until the store is well under
+    // its limit; called with the store locked
+    void evict(Statistics &p_statistics) const;
+
+  public:
+    ~CompileCache() = default;
+    CompileCache(const std::string &p_directory, const uint64_t p_max_bytes)
+        : m_directory(p_directory), m_max_bytes(p_max_bytes) {}
+
+    // create the directory of the store if needed; false if that fails
+    bool open() const;
+
+    // p_options: whatever else the output depends on, see Driver
+    static Key computeKey(const char *p_source, const size_t p_source_size,
+                          const std::string &p_source_path,
+                          const std::string &p_options);
+
+    // false on a miss
+    bool lookup(const Key &p_key, Result &p_result) const;
+
+    // Put the module of an entry found by lookup() at p_output_path,
+    // hardlinked if the file system allows, or write it to p_output_fd if
+    // that is not negative. false if the entry has been evicted meanwhile.
+    bool installModule(const Key &p_key, const std::string &p_output_path,
+                       const int p_output_fd) const;
+
+    // A file in the store for the CodeGenerator to write a copy of the
+    // module into; -1 if it cannot be created.
+    int createModuleFile(std::string &p_path) const;
+    // add an entry; p_module_path is the file from createModuleFile(),
+    // which is taken over or removed
+    void store(const Key &p_key, const Result &p_result,
+               const std::string &p_module_path) const;
+
+    Statistics getStatistics() const;
+    const std::string &getDirectory() const { return m_directory; }
+    uint64_t getMaxBytes() const { return m_max_bytes; }
+};
+
+#endif
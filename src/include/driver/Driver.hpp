@@ -0,0 +1,113 @@
+#ifndef DRIVER_DRIVER_H
+#define DRIVER_DRIVER_H
+
+#include "AST/Tracer.hpp"
+#include "driver/CompileCache.hpp"
+#include "opt/Optimizer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CompilationContext;
+class TimeReport;
+
+// the command line options, shared by every compilation of a run
+struct DriverOptions {
+    std::string save_path;
+    // only with a single input, "-" for stdout
+    std::string output_path;
+    // the original stdout if the module goes there, see main()
+    int ir_stdout_fd = -1;
+    size_t num_jobs = 1;
+    bool dump_ast = false;
+    bool use_ssa = false;
+    // -O<level>, see Optimizer
+    int opt_level = 0;
+    uint64_t unroll_budget = OptimizerOptions().unroll_budget;
+    bool no_inline = false;
+    bool inline_report = false;
+    bool arena_report = false;
+    bool lex_only = false;
+    bool quiet = false;
+    // see TimeReport, as a table or as JSON
+    bool time_report = false;
+    bool time_report_json = false;
+    // see Tracer, no trace if empty
+    std::string trace_path;
+    // see Server
+    std::string serve_socket_path;
+    // what relative paths are relative to if not the working directory of
+    // the process, for the server
+    std::string working_directory;
+    // see CompileCache, no cache if empty
+    std::string cache_directory;
+    uint64_t cache_max_bytes = 64 << 20;
+    bool cache_stats = false;
+};
+
+/*
+ * Runs the passes over the inputs of a run. Every compilation has its own
+ * CompilationContext, SemanticAnalyzer and CodeGenerator, so several of
+ * them can run at the same time.
+ */
+class Driver {
+  private:
+    DriverOptions m_options;
+    // destroy the trees and reuse the arenas, see CompilationContext
+    bool m_recycle_memory;
+    std::unique_ptr<CompileCache> m_cache;
+    std::unique_ptr<Tracer> m_tracer;
+
+    int compile(const std::string &p_source_path,
+                const bool p_recycle_memory) const;
+    int compileCached(CompilationContext &p_context) const;
+    // see compileAll()
+    int compileInParallel(const std::vector<std::string> &p_source_paths) const;
+    // Everything after opening the source. p_has_module tells whether a
+    // module has been generated and p_is_module_copied whether it has also
+    // been written to p_module_copy_fd in full.
+    int runPasses(CompilationContext &p_context, const int p_module_copy_fd,
+                  bool &p_has_module, bool &p_is_module_copied) const;
+    // the same, timed phase by phase if p_time_report is not null
+    int runPasses(CompilationContext &p_context, TimeReport *p_time_report,
+                  const int p_module_copy_fd, bool &p_has_module,
+                  bool &p_is_module_copied) const;
+
+    std::string resolvePath(const std::string &p_path) const;
+    // where the module of a source goes, resolved
+    std::string getOutputPath(const std::string &p_source_path) const;
+
+  public:
+    ~Driver() = default;
+    Driver(const DriverOptions &p_options,
+           const bool p_recycle_memory = false);
+
+    // Parses the arguments after argv[0] into p_options and p_source_paths.
+    // false if they are malformed.
+    static bool parseArguments(const std::vector<std::string> &p_arguments,
+                               DriverOptions &p_options,
+                               std::vector<std::string> &p_source_paths);
+
+    // Compiles a single source, printing to the Console of the calling
+    // thread. The exit status is -1 if the source cannot be read or has a
+    // lexical or syntax error, 0 otherwise; semantic errors are reported
+    // but do not change it.
+    int compile(const std::string &p_source_path) const {
+        return compile(p_source_path, m_recycle_memory);
+    }
+
+    // Compiles the sources on a pool of m_options.num_jobs threads. What
+    // each compilation prints is held back and written out in the order of
+    // the inputs, so the output does not depend on the scheduling. The exit
+    // status is -1 if any compilation failed. The trace, if any, is written
+    // once all are done.
+    int compileAll(const std::vector<std::string> &p_source_paths) const;
+
+    // to the Console, see --cache-stats
+    void printCacheStatistics() const;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef DRIVER_SERVER_H
+#define DRIVER_SERVER_H
+
+#include <cstddef>
+#include <string>
+
+/*
+ * A compiler that stays up and compiles on behalf of compiler-client, so
+ * that a build running it thousands of times does not pay the process
+ * start-up each time. Identifiers, types and AST arenas are kept from one
+ * request to the next. See ServerProtocol.hpp for the protocol.
+ */
+class Server {
+  private:
+    std::string m_socket_path;
+    size_t m_num_threads;
+    int m_listen_fd = -1;
+
+    void serve(const int p_connection_fd) const;
+
+  public:
+    ~Server();
+    Server(const std::string &p_socket_path, const size_t p_num_threads)
+        : m_socket_path(p_socket_path), m_num_threads(p_num_threads) {}
+
+    Server(const Server &) = delete;
+    Server &operator=(const Server &) = delete;
+
+    // Serves requests on m_num_threads threads until the process is
+    // killed. false if the socket cannot be set up.
+    bool run();
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef DRIVER_SERVER_PROTOCOL_H
+#define DRIVER_SERVER_PROTOCOL_H
+
+#include <cstdint>
+
+/*
+ * What the compile server (compiler --serve <socket>) and its client
+ * (compiler-client) exchange over a Unix domain socket, one request per
+ * connection:
+ *
+ *   request  uint32_t size, then size bytes: the working directory of the
+ *            client followed by its arguments without argv[0], each one
+ *            NUL-terminated. The server does not see the environment of
+ *            the client, so the client puts "--cache-dir <dir>" in front
+ *            of the arguments if kCacheDirectoryVariable is set, as
+ *            ./compiler would take it from there. The stdout and the
+ *            stderr of the client are passed along with the first byte
+ *            (SCM_RIGHTS); the server prints to them directly and writes
+ *            the modules itself.
+ *   reply    int32_t exit status, once the compilation is done.
+ */
+
+// the environment variable the client takes the socket path from
+constexpr const char *kServerSocketVariable = "P2LLVM_SERVER";
+// the default of --cache-dir, see main()
+constexpr const char *kCacheDirectoryVariable = "P2LLVM_CACHE_DIR";
+
+constexpr uint32_t kMaxRequestSize = 1 << 20;
+
+#endif
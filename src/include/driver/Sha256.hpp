@@ -0,0 +1,41 @@
+#ifndef DRIVER_SHA256_H
+#define DRIVER_SHA256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// SHA-256 (FIPS 180-4), for naming the entries of the CompileCache
+class Sha256 {
+  public:
+    using Digest = std::array<uint8_t, 32>;
+
+  private:
+    uint32_t m_state[8];
+    uint8_t m_block[64];
+    size_t m_block_size = 0;
+    uint64_t m_total_size = 0;
+
+    void processBlock(const uint8_t *p_block);
+
+  public:
+    ~Sha256() = default;
+    Sha256();
+
+    Sha256 &update(const void *p_data, size_t p_size);
+    Sha256 &update(const std::string &p_str) {
+        // with the terminating NUL, so that consecutive strings stay apart
+        return update(p_str.c_str(), p_str.size() + 1);
+    }
+    template <typename T> Sha256 &updateValue(const T &p_value) {
+        return update(&p_value, sizeof(p_value));
+    }
+
+    Digest finish();
+
+    // lowercase hexadecimal
+    static std::string toString(const Digest &p_digest);
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef DRIVER_THREAD_POOL_H
+#define DRIVER_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * A fixed set of worker threads, each with its own queue of tasks.
+ *
+ * Submitted tasks are dealt out to the queues in turn. A worker takes the
+ * oldest task from its own queue, so tasks finish roughly in the order they
+ * were submitted, and once that is empty, steals the oldest one from the
+ * queue of another worker, so that a few long compilations do not leave the
+ * other workers idle.
+ */
+class ThreadPool {
+  public:
+    using Task = std::function<void()>;
+
+  private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // guards the counters below, idle workers sleep on m_wake_up
+    std::mutex m_mutex;
+    std::condition_variable m_wake_up;
+    std::condition_variable m_all_done;
+    // tasks in the queues / tasks not finished yet
+    size_t m_num_queued = 0;
+    size_t m_num_unfinished = 0;
+    size_t m_next_worker = 0;
+    bool m_is_stopping = false;
+
+    bool takeTask(const size_t p_worker_index, Task &p_task);
+    void run(const size_t p_worker_index);
+
+  public:
+    // finishes the tasks submitted so far before joining the workers
+    ~ThreadPool();
+    ThreadPool(const size_t p_num_threads);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // the number of hardware threads, at least 1
+    static size_t getDefaultSize();
+
+    size_t getSize() const { return m_threads.size(); }
+
+    void submit(Task p_task);
+    // block until every submitted task has finished
+    void wait();
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef DRIVER_TIME_REPORT_H
+#define DRIVER_TIME_REPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/*
+ * Where a compilation spends its time and memory, see --time-report.
+ *
+ * Each phase is timed on the monotonic clock and charged with what the
+ * compiling thread allocates during it (see AllocationCounter). Phases may
+ * nest: the scanner runs inside the parser a token at a time, and what it
+ * takes is charged to the lexer alone and not to the parser as well. The
+ * two clock reads around every token make the lexer look a little slower
+ * than it is, compare --lex-only. The optimizer runs inside the code
+ * generator in the same way, and is charged to a phase of its own.
+ *
+ * The peak RSS of a phase is the high-water mark of the whole process once
+ * the phase is done, so in a batch it covers the other compilations running
+ * at the time too.
+ */
+class TimeReport {
+  public:
+    enum class PhaseEnum : uint8_t {
+        kLex,
+        kParse,
+        kDumpAst,
+        kSema,
+        kCodegen,
+        kOptimize,
+        kNumPhases
+    };
+
+    // charges what happens during its lifetime to a phase; does nothing
+    // without a report
+    class Scope {
+      private:
+        TimeReport *m_report;
+        PhaseEnum m_phase;
+        bool m_samples_rss;
+        Scope *m_parent;
+        uint64_t m_start_ns;
+        uint64_t m_start_allocations;
+        uint64_t m_start_bytes;
+
+      public:
+        ~Scope();
+        // p_samples_rss: whether to read the peak RSS at the end, which is
+        // a system call, too much for every token
+        Scope(TimeReport *p_report, const PhaseEnum p_phase,
+              const bool p_samples_rss = true);
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    struct Phase {
+        bool is_run = false;
+        uint64_t time_ns = 0;
+        uint64_t num_allocations = 0;
+        uint64_t allocated_bytes = 0;
+        // in KiB, 0 if not sampled
+        long peak_rss = 0;
+    };
+
+    // the size of what went through the phases
+    struct Counts {
+        size_t source_bytes = 0;
+        size_t num_tokens = 0;
+        size_t num_ast_nodes = 0;
+        size_t num_symbols = 0;
+        size_t num_instructions = 0;
+    };
+
+  private:
+    Phase m_phases[static_cast<size_t>(PhaseEnum::kNumPhases)];
+    Counts m_counts;
+    // the innermost Scope running
+    Scope *m_current_scope = nullptr;
+
+  public:
+    ~TimeReport() = default;
+    TimeReport() = default;
+
+    TimeReport(const TimeReport &) = delete;
+    TimeReport &operator=(const TimeReport &) = delete;
+
+    static const char *getPhaseName(const PhaseEnum p_phase);
+
+    const Phase &getPhase(const PhaseEnum p_phase) const {
+        return m_phases[static_cast<size_t>(p_phase)];
+    }
+    Counts &getCounts() { return m_counts; }
+    const Counts &getCounts() const { return m_counts; }
+
+    // a table for people
+    void print(FILE *p_out, const std::string &p_source_path) const;
+    // a single line of JSON for scripts, see bench/
+    void printJson(FILE *p_out, const std::string &p_source_path) const;
+};
+
+#endif
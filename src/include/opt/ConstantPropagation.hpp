@@ -0,0 +1,43 @@
+#ifndef OPT_CONSTANT_PROPAGATION_H
+#define OPT_CONSTANT_PROPAGATION_H
+
+#include "codegen/Ir.hpp"
+
+/*
+ * Constant and copy propagation. Instructions whose operands are constants
+ * are evaluated, identities such as x + 0 or x * 1 are reduced to their
+ * operand, and a phi whose incoming values are all the same is replaced by
+ * that value; the uses then refer to the result directly. A conditional
+ * branch on a constant becomes an unconditional one, and the edge not taken
+ * is removed, which DeadCodeElimination then follows up on. Constants
+ * added one after the other, as in the copies of a loop body made by
+ * LoopUnroll, are added up first.
+ *
+ * The code generator folds expressions of literals already; what is left
+ * here is what only becomes constant once LocalCse has forwarded a stored
+ * value to its loads.
+ */
+class ConstantPropagation {
+  private:
+    IrModule &m_module;
+
+  public:
+    ~ConstantPropagation() = default;
+    ConstantPropagation(IrModule &p_module) : m_module(p_module) {}
+
+    // whether the function has been changed
+    bool run(IrFunction &p_function);
+
+  private:
+    // what p_inst always evaluates to, null if not known
+    IrValue *fold(const IrInstruction &p_inst);
+    IrValue *foldBinary(const IrInstruction &p_inst);
+    IrValue *foldICmp(const IrInstruction &p_inst);
+    IrValue *foldPhi(const IrInstruction &p_inst);
+    // rewrite (x + c1) + c2 to x + (c1 + c2); whether p_inst has changed
+    bool reassociate(IrInstruction &p_inst);
+    // replace a conditional branch that always goes the same way
+    bool foldBranch(IrFunction &p_function, IrInstruction *const p_branch);
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef OPT_DEAD_CODE_ELIMINATION_H
+#define OPT_DEAD_CODE_ELIMINATION_H
+
+#include "codegen/Ir.hpp"
+
+/*
+ * Removes what cannot affect the behavior of a function:
+ *   - blocks no path from the entry reaches, e.g. code after a return or
+ *     the arm of an if on a constant,
+ *   - instructions without side effects whose result nothing needs, found
+ *     by marking from the stores, calls and terminators backwards, so that
+ *     dead cycles of phis go as well,
+ *   - stores to local allocas that are never loaded, and then the allocas.
+ * Straight-line chains of blocks, where a block is the only way into the
+ * next, are merged into one, which gives LocalCse more to work with.
+ */
+class DeadCodeElimination {
+  public:
+    ~DeadCodeElimination() = default;
+    DeadCodeElimination() = default;
+
+    // whether the function has been changed
+    bool run(IrFunction &p_function);
+
+  private:
+    bool removeUnreachableBlocks(IrFunction &p_function);
+    bool mergeBlocks(IrFunction &p_function);
+    bool removeDeadInstructions(IrFunction &p_function);
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef OPT_DOMINATOR_TREE_H
+#define OPT_DOMINATOR_TREE_H
+
+#include "codegen/Ir.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+/*
+ * The immediate dominator of each block reachable from the entry, computed
+ * with the iterative algorithm of Cooper, Harvey and Kennedy, "A Simple,
+ * Fast Dominance Algorithm". The CFGs of P programs are small and shallow,
+ * so dominance queries just walk up the tree.
+ */
+class DominatorTree {
+  private:
+    std::vector<IrBasicBlock *> m_reverse_post_order;
+    std::unordered_map<const IrBasicBlock *, size_t> m_order;
+    // the entry is its own immediate dominator
+    std::vector<size_t> m_idoms;
+
+  public:
+    ~DominatorTree() = default;
+    DominatorTree(const IrFunction &p_function);
+
+    // the blocks reachable from the entry; a block comes after its
+    // dominators
+    const std::vector<IrBasicBlock *> &getReversePostOrder() const {
+        return m_reverse_post_order;
+    }
+    bool isReachable(const IrBasicBlock *p_block) const {
+        return m_order.count(p_block);
+    }
+
+    // whether every path from the entry to p_block goes through p_dominator,
+    // which holds for p_block itself
+    bool dominates(const IrBasicBlock *p_dominator,
+                   const IrBasicBlock *p_block) const;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef OPT_INLINER_H
+#define OPT_INLINER_H
+
+#include "codegen/Ir.hpp"
+
+#include <cstdint>
+
+/*
+ * Inlining of calls to small functions.
+ *
+ * A call is replaced by a copy of the body of the function it calls, with
+ * the arguments in place of the parameters and a branch to what follows the
+ * call in place of every return; with several returns, the result is a phi
+ * there. The copy has values of its own, so the locals of the callee need
+ * no renaming, and its allocas go to the entry block of the caller.
+ *
+ * A call is inlined if the callee, less a bonus for every constant argument
+ * since what depends on it folds away afterwards, is no larger than
+ * kThreshold instructions. Recursive functions are left alone; so are the
+ * calls in the copies, which have been looked at in the callee already.
+ *
+ * P declares a function before it is called, so the callees of a function
+ * come before it in the module and have been through the optimizer by the
+ * time it gets there: the sizes are those of the optimized bodies, and
+ * what is copied is already simplified.
+ */
+class Inliner {
+  private:
+    // print every decision to the console, see --inline-report
+    bool m_report;
+
+  public:
+    ~Inliner() = default;
+    Inliner(const bool p_report) : m_report(p_report) {}
+
+    // whether the function has been changed
+    bool run(IrFunction &p_function);
+
+  private:
+    // whether p_callee is inlined at p_call, along with why not if it isn't
+    bool decide(const IrFunction &p_caller, const IrInstruction &p_call,
+                const IrFunction &p_callee) const;
+    // replaces p_call with a copy of p_callee, returns the result of it
+    IrValue *inlineCall(IrFunction &p_caller, IrInstruction *const p_call,
+                        const IrFunction &p_callee);
+};
+
+#endif
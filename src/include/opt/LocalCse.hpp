@@ -0,0 +1,30 @@
+#ifndef OPT_LOCAL_CSE_H
+#define OPT_LOCAL_CSE_H
+
+#include "codegen/Ir.hpp"
+
+/*
+ * Local common subexpression elimination: within a basic block, an
+ * arithmetic, comparison or getelementptr instruction that repeats an
+ * earlier one with the same operands is replaced by it.
+ *
+ * Memory is handled the same way. A load of an address already loaded from
+ * or stored to in the block takes that value instead, as long as nothing
+ * that may alias it has been stored in between (see MemoryAnalysis), and a
+ * call forgets everything but the local allocas. This is what turns the
+ * load of a variable per use into one per block, and propagates what was
+ * stored to where it is read back.
+ */
+class LocalCse {
+  private:
+    class KnownValues;
+
+  public:
+    ~LocalCse() = default;
+    LocalCse() = default;
+
+    // whether the function has been changed
+    bool run(IrFunction &p_function);
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef OPT_LOOP_INFO_H
+#define OPT_LOOP_INFO_H
+
+#include "codegen/Ir.hpp"
+#include "opt/DominatorTree.hpp"
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * The natural loops of a function: a back edge goes to a block that
+ * dominates its source, the header, and the loop is every block that
+ * reaches the source without going through the header. Loops sharing a
+ * header are one loop. The code generator only makes loops of for and
+ * while statements, whose head block is the header.
+ */
+class Loop {
+  private:
+    IrBasicBlock *m_header;
+    // the header first, then in reverse post order
+    std::vector<IrBasicBlock *> m_blocks;
+    std::unordered_set<const IrBasicBlock *> m_block_set;
+    // the sources of the back edges
+    std::vector<IrBasicBlock *> m_latches;
+    Loop *m_parent = nullptr;
+
+    friend class LoopInfo;
+
+  public:
+    ~Loop() = default;
+    Loop(IrBasicBlock *const p_header) : m_header(p_header) {}
+
+    IrBasicBlock *getHeader() const { return m_header; }
+    const std::vector<IrBasicBlock *> &getBlocks() const { return m_blocks; }
+    const std::vector<IrBasicBlock *> &getLatches() const {
+        return m_latches;
+    }
+    Loop *getParent() const { return m_parent; }
+
+    bool contains(const IrBasicBlock *p_block) const {
+        return m_block_set.count(p_block);
+    }
+    // whether p_value is the same on every iteration since it is computed
+    // before the loop
+    bool isDefinedOutside(const IrValue *p_value) const;
+
+    // The block outside the loop that is the only way into it and only
+    // leads to the header, where code run once before the loop goes; null
+    // if there is none, see LoopInfo::insertPreheaders().
+    IrBasicBlock *getPreheader() const;
+    // null unless there is a single back edge
+    IrBasicBlock *getLatch() const {
+        return m_latches.size() == 1 ? m_latches.front() : nullptr;
+    }
+};
+
+class LoopInfo {
+  private:
+    std::vector<std::unique_ptr<Loop>> m_loops;
+
+  public:
+    ~LoopInfo() = default;
+    LoopInfo(const DominatorTree &p_dominator_tree);
+
+    // inner loops come before the loops around them
+    std::vector<Loop *> getLoops() const;
+
+    // Gives every loop entered by a single edge a preheader, splitting the
+    // edge if its source branches elsewhere too. Returns whether blocks
+    // have been added, in which case both analyses have to be redone.
+    static bool insertPreheaders(IrFunction &p_function);
+};
+
+#endif
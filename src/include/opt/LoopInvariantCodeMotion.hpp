@@ -0,0 +1,39 @@
+#ifndef OPT_LOOP_INVARIANT_CODE_MOTION_H
+#define OPT_LOOP_INVARIANT_CODE_MOTION_H
+
+#include "codegen/Ir.hpp"
+
+class Loop;
+class MemoryAnalysis;
+
+/*
+ * Moves what computes the same value on every iteration of a loop to its
+ * preheader, inner loops first so that the code can keep moving out
+ * through the loops around them:
+ *   - arithmetic, comparisons and getelementptr whose operands are defined
+ *     outside the loop, e.g. the address of the row of a[i][j] in the loop
+ *     over j,
+ *   - loads of such an address if nothing in the loop may store to it (see
+ *     MemoryAnalysis) and the load cannot fault even if the loop is never
+ *     entered, which is the case for variables and constant indices in
+ *     bounds, such as the pointer an array parameter holds.
+ * Division is only moved for a constant divisor, since the loop may be the
+ * only thing that keeps it from dividing by zero.
+ *
+ * Allocas of variables declared in a loop body go to the entry block, so
+ * that they are allocated once and not on every iteration.
+ */
+class LoopInvariantCodeMotion {
+  public:
+    ~LoopInvariantCodeMotion() = default;
+    LoopInvariantCodeMotion() = default;
+
+    // whether the function has been changed
+    bool run(IrFunction &p_function);
+
+  private:
+    bool hoistAllocas(IrFunction &p_function);
+    bool hoist(const Loop &p_loop, const MemoryAnalysis &p_memory);
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef OPT_LOOP_STRENGTH_REDUCTION_H
+#define OPT_LOOP_STRENGTH_REDUCTION_H
+
+#include "codegen/Ir.hpp"
+
+class Loop;
+
+/*
+ * Strength reduction of array addresses in counted loops.
+ *
+ * An induction variable is a phi in the loop header that starts at some
+ * value before the loop and has a constant added to it on the back edge,
+ * like the variable of a for loop once it lives in SSA form. The address of
+ * a[i] or of the row a[i] in a[i][j], a getelementptr whose last index is
+ * such a variable and whose other operands are the same on every
+ * iteration, becomes a pointer of its own: computed once in the preheader
+ * and advanced by the step on the back edge, instead of being recomputed
+ * from the index each time. The address of a[i + k], as in the copies of
+ * the body made by LoopUnroll, is k elements on from that pointer, and
+ * that of a[i - k] k elements back.
+ *
+ * LoopInvariantCodeMotion has to run first, so that the row address of
+ * a[i][j] is already out of the loop over j.
+ */
+class LoopStrengthReduction {
+  private:
+    IrModule &m_module;
+
+  public:
+    ~LoopStrengthReduction() = default;
+    LoopStrengthReduction(IrModule &p_module) : m_module(p_module) {}
+
+    // whether the function has been changed
+    bool run(IrFunction &p_function);
+
+  private:
+    bool reduce(IrFunction &p_function, const Loop &p_loop);
+};
+
+#endif
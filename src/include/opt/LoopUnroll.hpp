@@ -0,0 +1,75 @@
+#ifndef OPT_LOOP_UNROLL_H
+#define OPT_LOOP_UNROLL_H
+
+#include "codegen/Ir.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Loop;
+
+/*
+ * Unrolling of loops that run a number of times known at compile time.
+ *
+ * That is a loop whose header compares an induction variable (see
+ * LoopStrengthReduction) with a constant, starting from a constant, and
+ * leaves the loop only from there: every for loop of P, since its bounds
+ * are literals, once the code generator keeps its variable in SSA form.
+ *
+ * If the trip count times the size of the loop, in instructions, is within
+ * the budget, the loop is unrolled fully: one copy of the body for each
+ * iteration, one after the other, and no branch back. Otherwise an
+ * innermost loop is unrolled by a factor N that fits in the budget: the
+ * trip count modulo N iterations are peeled off in front of the loop, and
+ * the body runs N times on every trip around the rest of it, which checks
+ * the condition once per N iterations since the count left is a multiple
+ * of N. ConstantPropagation then sees the constant value of the variable
+ * in each copy, and adds up the increments of the variable between copies.
+ */
+class LoopUnroll {
+  private:
+    using ValueMap = std::unordered_map<IrValue *, IrValue *>;
+
+    // the header and the latch of a copy of a loop
+    struct Iteration {
+        IrBasicBlock *header;
+        IrBasicBlock *latch;
+    };
+
+    uint64_t m_budget;
+    // the headers of loops unrolled by a factor, which still look like
+    // they could be, and of their copies
+    std::unordered_set<const IrBasicBlock *> m_unrolled;
+
+  public:
+    ~LoopUnroll() = default;
+    // p_budget is the size a loop may grow to, 0 for no unrolling
+    LoopUnroll(const uint64_t p_budget) : m_budget(p_budget) {}
+
+    // whether the function has been changed
+    bool run(IrFunction &p_function);
+
+  private:
+    bool unroll(IrFunction &p_function, const Loop &p_loop,
+                const bool is_innermost);
+    // the number of times the body of p_loop runs, -1 if not known
+    int64_t getTripCount(const Loop &p_loop) const;
+
+    // Copies the blocks of p_loop for one iteration, appended to p_blocks
+    // to be placed by the caller. p_values maps the header phis to their
+    // values at the start of it, and gets the copies of the rest of the
+    // loop added. The copy of the header goes on into the body; the copy
+    // of the latch still branches to it, without being one of its
+    // predecessors yet.
+    Iteration cloneIteration(IrFunction &p_function, const Loop &p_loop,
+                             ValueMap &p_values,
+                             std::vector<IrBasicBlock *> &p_blocks);
+    // peels p_count iterations off the front of p_loop, placed in front of
+    // its header, which is then entered from the last of them
+    void peel(IrFunction &p_function, const Loop &p_loop,
+              const int64_t p_count);
+};
+
+#endif
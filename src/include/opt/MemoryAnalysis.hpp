@@ -0,0 +1,50 @@
+#ifndef OPT_MEMORY_ANALYSIS_H
+#define OPT_MEMORY_ANALYSIS_H
+
+#include "codegen/Ir.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Which memory the loads and stores of a function may touch.
+ *
+ * Every pointer is a base object with getelementptr on top: an alloca, a
+ * global variable, or a pointer the function cannot see through (an array
+ * parameter, loaded from its alloca), whose base is unknown. An alloca
+ * whose address is only loaded from and stored to, directly or through
+ * getelementptr, is local: nothing but the function itself touches it, and
+ * no other pointer points into it. Globals, the other allocas and unknown
+ * pointers are shared, a call may change any of them.
+ *
+ * Accesses of the same base are told apart only by constant indices, since
+ * the code generator indexes a variable the same way everywhere.
+ */
+class MemoryAnalysis {
+  private:
+    struct Alloca {
+        bool is_escaped = false;
+        bool is_loaded = false;
+    };
+    std::unordered_map<const IrValue *, Alloca> m_allocas;
+
+  public:
+    ~MemoryAnalysis() = default;
+    MemoryAnalysis(const IrFunction &p_function);
+
+    // the alloca or global p_ptr points into, null if unknown
+    static IrValue *getBase(IrValue *p_ptr);
+
+    bool isLocal(const IrValue *p_base) const;
+    // whether anything may read p_base, false for local allocas that are
+    // only ever stored to
+    bool isLoaded(const IrValue *p_base) const;
+
+    bool mayAlias(IrValue *p_lhs, IrValue *p_rhs) const;
+
+  private:
+    // of the getelementptr chain down to the base
+    static void getIndices(IrValue *p_ptr, std::vector<IrValue *> &p_indices);
+};
+
+#endif
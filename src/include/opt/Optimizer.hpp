@@ -0,0 +1,56 @@
+#ifndef OPT_OPTIMIZER_H
+#define OPT_OPTIMIZER_H
+
+#include "codegen/Ir.hpp"
+
+#include <cstdint>
+
+class LoopUnroll;
+
+// what to do to the module before it is printed, see -O
+struct OptimizerOptions {
+    // 0 leaves the module as the code generator built it
+    int level = 0;
+    // how large a loop may grow by unrolling, in instructions, see
+    // --unroll-budget and LoopUnroll
+    uint64_t unroll_budget = 256;
+    // see --no-inline, --inline-report and Inliner
+    bool inline_functions = true;
+    bool inline_report = false;
+};
+
+/*
+ * Runs the passes over the IR of a module once the code generator has built
+ * all of it, before it is printed.
+ *
+ * At -O1, the calls in each function to small functions are inlined first,
+ * see Inliner. Then each function goes through LocalCse,
+ * ConstantPropagation and DeadCodeElimination in turn until none of them
+ * finds anything more to do: what one pass leaves behind (a load forwarded
+ * to a constant, a branch on it, the block behind the branch) is what the
+ * next one picks up. TailCallElimination then turns self recursion into
+ * loops, and the loop passes, LoopInvariantCodeMotion, LoopUnroll and
+ * LoopStrengthReduction, run the same way, with the others cleaning up
+ * after each round of them.
+ *
+ * The loop passes need the variables of for loops in SSA form, so at -O1
+ * the code generator keeps scalar locals in registers as with --ssa.
+ */
+class Optimizer {
+  private:
+    OptimizerOptions m_options;
+
+  public:
+    ~Optimizer() = default;
+    Optimizer(const OptimizerOptions &p_options) : m_options(p_options) {}
+
+    void run(IrModule &p_module);
+
+  private:
+    void runScalarPasses(IrModule &p_module, IrFunction &p_function);
+    // whether the function has been changed
+    bool runLoopPasses(IrModule &p_module, IrFunction &p_function,
+                       LoopUnroll &p_unroll);
+};
+
+#endif
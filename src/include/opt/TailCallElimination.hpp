@@ -0,0 +1,40 @@
+#ifndef OPT_TAIL_CALL_ELIMINATION_H
+#define OPT_TAIL_CALL_ELIMINATION_H
+
+#include "codegen/Ir.hpp"
+
+#include <vector>
+
+/*
+ * Turns the calls of a function to itself whose result it returns right
+ * away, as in "return gcd(b, a mod b);", into a branch back to its start:
+ * the entry block becomes the header of a loop, with a phi for each
+ * parameter that takes the arguments of the call on the way around, and a
+ * new entry block in front of it keeps the allocas. The recursion then
+ * runs in a single frame, and the loop passes see a loop.
+ *
+ * The rest of the calls returned right away are marked for LLVM to reuse
+ * the frame of the caller: musttail if the callee takes and returns the
+ * same types as the caller and all of its arguments are passed in
+ * registers, tail otherwise.
+ *
+ * Both hold only if the callee cannot reach the frame of the caller, so a
+ * function whose allocas have their address taken anywhere other than by
+ * its own loads and stores (see MemoryAnalysis), e.g. an array passed on
+ * to a call, is left alone.
+ */
+class TailCallElimination {
+  public:
+    ~TailCallElimination() = default;
+    TailCallElimination() = default;
+
+    // whether the function has been changed
+    bool run(IrFunction &p_function);
+
+  private:
+    // p_calls are the calls to p_function followed by a return of them
+    void eliminate(IrFunction &p_function,
+                   const std::vector<IrInstruction *> &p_calls);
+};
+
+#endif
@@ -1,16 +1,17 @@
 #ifndef SEMA_SYMBOL_TABLE_H
 #define SEMA_SYMBOL_TABLE_H
 
+#include "AST/Identifier.hpp"
 #include "AST/PType.hpp"
 #include "AST/function.hpp"
 
 #include <cstdint>
-#include <map>
 #include <memory>
-#include <stack>
 #include <string>
 #include <vector>
 
+class IrValue;
+
 /*
  * Conform to C++ Core Guidelines C.182
  */
@@ -50,28 +51,36 @@ class SymbolEntry {
     };
 
   private:
-    const std::string &m_name;
+    Identifier m_name;
     KindEnum m_kind;
     size_t m_level;
     const PType *m_p_type;
     Attribute m_attribute;
 
+    // the entry of the same name this one hides while it is visible
+    SymbolEntry *m_hidden_entry = nullptr;
+
+    // storage the code generator assigned to the symbol: the alloca or
+    // global of a variable, the function itself
+    mutable IrValue *m_codegen_slot = nullptr;
+
   public:
     ~SymbolEntry() = default;
 
-    SymbolEntry(const std::string &p_name, const KindEnum kind,
+    SymbolEntry(const Identifier p_name, const KindEnum kind,
                 const size_t level, const PType *const p_type,
                 const Constant *const p_constant)
         : m_name(p_name), m_kind(kind), m_level(level), m_p_type(p_type),
           m_attribute(p_constant) {}
 
-    SymbolEntry(const std::string &p_name, const KindEnum kind,
+    SymbolEntry(const Identifier p_name, const KindEnum kind,
                 const size_t level, const PType *const p_type,
                 const FunctionNode::DeclNodes *const p_parameters)
         : m_name(p_name), m_kind(kind), m_level(level), m_p_type(p_type),
           m_attribute(p_parameters) {}
 
-    const std::string &getName() const { return m_name; };
+    Identifier getIdentifier() const { return m_name; };
+    const std::string &getName() const { return m_name.str(); };
     const char *getNameCString() const { return m_name.c_str(); };
 
     const KindEnum getKind() const { return m_kind; };
@@ -81,6 +90,12 @@ class SymbolEntry {
     const PType *getTypePtr() const { return m_p_type; };
 
     const Attribute &getAttribute() const { return m_attribute; };
+
+    SymbolEntry *getHiddenEntry() const { return m_hidden_entry; }
+    void setHiddenEntry(SymbolEntry *const p_entry) { m_hidden_entry = p_entry; }
+
+    IrValue *getCodegenSlot() const { return m_codegen_slot; }
+    void setCodegenSlot(IrValue *const p_slot) const { m_codegen_slot = p_slot; }
 };
 
 class SymbolTable {
@@ -97,20 +112,50 @@ class SymbolTable {
 
     const Entries &getEntries() const { return m_entries; };
 
-    SymbolEntry *addSymbol(const std::string &p_name,
+    SymbolEntry *addSymbol(const Identifier p_name,
                            const SymbolEntry::KindEnum kind, const size_t level,
                            const PType *const p_type,
                            const Constant *const p_constant);
-    SymbolEntry *addSymbol(const std::string &p_name,
+    SymbolEntry *addSymbol(const Identifier p_name,
                            const SymbolEntry::KindEnum kind, const size_t level,
                            const PType *const p_type,
                            const FunctionNode::DeclNodes *const p_parameters);
 };
 
+/*
+ * Maps each name to its innermost visible entry. Open addressing with
+ * linear probing over interned identifiers, so a lookup hashes a pointer
+ * and usually touches a single slot. Entries hidden by an inner
+ * declaration are chained through SymbolEntry::getHiddenEntry().
+ */
+class SymbolHashTable {
+  private:
+    struct Slot {
+        Identifier name;
+        SymbolEntry *entry; // nullptr if the slot is free
+    };
+
+    std::vector<Slot> m_slots;
+    size_t m_size = 0;
+
+  public:
+    ~SymbolHashTable() = default;
+    SymbolHashTable();
+
+    SymbolEntry *find(const Identifier p_name) const;
+    // insert or replace
+    void assign(const Identifier p_name, SymbolEntry *const p_entry);
+    void erase(const Identifier p_name);
+
+  private:
+    size_t getHomeSlot(const Identifier p_name) const;
+    size_t findSlot(const Identifier p_name) const;
+    void grow();
+};
+
 class SymbolManager {
   public:
     using Tables = std::vector<std::unique_ptr<SymbolTable>>;
-    using NameEntryMap = std::map<std::string, SymbolEntry *>;
 
   private:
     Tables m_in_use_tables;
@@ -118,11 +163,12 @@ class SymbolManager {
     // hold tables for other visitors to use
     Tables m_popped_tables;
 
-    mutable NameEntryMap m_hash_entries;
-    mutable std::map<std::string, std::stack<SymbolEntry *>> m_hidden_entries;
+    mutable SymbolHashTable m_hash_entries;
 
     SymbolTable *m_current_table = nullptr;
     size_t m_current_level = 0;
+    // every symbol added, in any scope
+    size_t m_num_symbols = 0;
 
     const bool m_opt_dmp;
 
@@ -144,24 +190,25 @@ class SymbolManager {
 
     template <typename AttributeType>
     friend SymbolEntry *
-    genericAddSymbol(SymbolManager &p_manager, const std::string &p_name,
+    genericAddSymbol(SymbolManager &p_manager, const Identifier p_name,
                      const SymbolEntry::KindEnum kind,
                      const PType *const p_type,
                      const AttributeType *const p_attribute);
 
-    SymbolEntry *addSymbol(const std::string &p_name,
+    SymbolEntry *addSymbol(const Identifier p_name,
                            const SymbolEntry::KindEnum kind,
                            const PType *const p_type,
                            const Constant *const p_constant);
-    SymbolEntry *addSymbol(const std::string &p_name,
+    SymbolEntry *addSymbol(const Identifier p_name,
                            const SymbolEntry::KindEnum kind,
                            const PType *const p_type,
                            const FunctionNode::DeclNodes *const p_parameters);
 
-    const SymbolEntry *lookup(const std::string &p_name) const;
+    const SymbolEntry *lookup(const Identifier p_name) const;
 
     const SymbolTable *getCurrentTable() const { return m_current_table; }
     size_t getCurrentLevel() const { return m_current_level; }
+    size_t getNumSymbols() const { return m_num_symbols; }
 
     void
     reconstructHashTableFromSymbolTable(const SymbolTable *const p_table) const;
@@ -169,7 +216,7 @@ class SymbolManager {
 
   private:
     std::pair<bool, SymbolEntry *>
-    checkExistence(const std::string &p_name, const size_t current_level) const;
+    checkExistence(const Identifier p_name, const size_t current_level) const;
 };
 
 #endif
@@ -0,0 +1,89 @@
+#include "AST/AstArena.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+
+static thread_local AstArena *current_arena = nullptr;
+
+static std::mutex free_arenas_mutex;
+static std::vector<std::unique_ptr<AstArena>> free_arenas;
+
+AstArena::Scope::Scope(AstArena &p_arena) : m_previous(current_arena) {
+    current_arena = &p_arena;
+}
+
+AstArena::Scope::~Scope() { current_arena = m_previous; }
+
+AstArena *AstArena::getCurrent() { return current_arena; }
+
+void *AstArena::allocate(const size_t size, const size_t alignment) {
+    assert(alignment && (alignment & (alignment - 1)) == 0 &&
+           "alignment should be a power of two");
+
+    auto aligned = [alignment](char *p_ptr) {
+        const auto address = reinterpret_cast<uintptr_t>(p_ptr);
+        return reinterpret_cast<char *>((address + alignment - 1) &
+                                        ~(uintptr_t)(alignment - 1));
+    };
+
+    char *ptr = m_cursor ? aligned(m_cursor) : nullptr;
+    if (!ptr || ptr + size > m_end) {
+        // oversized requests get a chunk of their own
+        const size_t chunk_size = std::max(kChunkSize, size + alignment);
+        if (m_chunks.empty()) {
+            m_first_chunk_size = chunk_size;
+        }
+        m_chunks.emplace_back(new char[chunk_size]);
+        m_cursor = m_chunks.back().get();
+        m_end = m_cursor + chunk_size;
+        m_reserved_bytes += chunk_size;
+        ptr = aligned(m_cursor);
+    }
+
+    m_cursor = ptr + size;
+    m_allocated_bytes += size;
+    ++m_num_allocations;
+    return ptr;
+}
+
+void AstArena::release() {
+    m_chunks.clear();
+    m_cursor = m_end = nullptr;
+    m_allocated_bytes = 0;
+    m_reserved_bytes = 0;
+    m_num_allocations = 0;
+}
+
+void AstArena::reset() {
+    if (m_chunks.empty()) {
+        return;
+    }
+
+    m_chunks.resize(1);
+    m_cursor = m_chunks.front().get();
+    m_end = m_cursor + m_first_chunk_size;
+    m_allocated_bytes = 0;
+    m_reserved_bytes = m_first_chunk_size;
+    m_num_allocations = 0;
+}
+
+std::unique_ptr<AstArena> AstArena::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(free_arenas_mutex);
+        if (!free_arenas.empty()) {
+            auto arena = std::move(free_arenas.back());
+            free_arenas.pop_back();
+            return arena;
+        }
+    }
+    return std::unique_ptr<AstArena>(new AstArena);
+}
+
+void AstArena::recycle(std::unique_ptr<AstArena> p_arena) {
+    p_arena->reset();
+
+    std::lock_guard<std::mutex> lock(free_arenas_mutex);
+    free_arenas.push_back(std::move(p_arena));
+}
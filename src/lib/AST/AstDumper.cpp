@@ -1,4 +1,5 @@
 #include "AST/AstDumper.hpp"
+#include "AST/Console.hpp"
 #include "visitor/AstNodeInclude.hpp"
 
 #include <cstdio>
@@ -12,15 +13,15 @@ void AstDumper::decrementIndentation() {
 }
 
 static void outputIndentationSpace(const uint32_t indentation) {
-    std::printf("%*s", indentation, "");
+    std::fprintf(Console::out(), "%*s", indentation, "");
 }
 
 void AstDumper::visit(ProgramNode &p_program) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("program <line: %u, col: %u> %s %s\n",
-                p_program.getLocation().line, p_program.getLocation().col,
-                p_program.getNameCString(), "void");
+    std::fprintf(Console::out(), "program <line: %u, col: %u> %s %s\n",
+                 p_program.getLocation().line, p_program.getLocation().col,
+                 p_program.getNameCString(), "void");
 
     incrementIndentation();
     p_program.visitChildNodes(*this);
@@ -30,8 +31,8 @@ void AstDumper::visit(ProgramNode &p_program) {
 void AstDumper::visit(DeclNode &p_decl) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("declaration <line: %u, col: %u>\n", p_decl.getLocation().line,
-                p_decl.getLocation().col);
+    std::fprintf(Console::out(), "declaration <line: %u, col: %u>\n",
+                 p_decl.getLocation().line, p_decl.getLocation().col);
 
     incrementIndentation();
     p_decl.visitChildNodes(*this);
@@ -41,9 +42,9 @@ void AstDumper::visit(DeclNode &p_decl) {
 void AstDumper::visit(VariableNode &p_variable) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("variable <line: %u, col: %u> %s %s\n",
-                p_variable.getLocation().line, p_variable.getLocation().col,
-                p_variable.getNameCString(), p_variable.getTypeCString());
+    std::fprintf(Console::out(), "variable <line: %u, col: %u> %s %s\n",
+                 p_variable.getLocation().line, p_variable.getLocation().col,
+                 p_variable.getNameCString(), p_variable.getTypeCString());
 
     incrementIndentation();
     p_variable.visitChildNodes(*this);
@@ -53,18 +54,19 @@ void AstDumper::visit(VariableNode &p_variable) {
 void AstDumper::visit(ConstantValueNode &p_constant_value) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("constant <line: %u, col: %u> %s\n",
-                p_constant_value.getLocation().line,
-                p_constant_value.getLocation().col,
-                p_constant_value.getConstantValueCString());
+    std::fprintf(Console::out(), "constant <line: %u, col: %u> %s\n",
+                 p_constant_value.getLocation().line,
+                 p_constant_value.getLocation().col,
+                 p_constant_value.getConstantValueCString());
 }
 
 void AstDumper::visit(FunctionNode &p_function) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("function declaration <line: %u, col: %u> %s %s\n",
-                p_function.getLocation().line, p_function.getLocation().col,
-                p_function.getNameCString(), p_function.getPrototypeCString());
+    std::fprintf(Console::out(),
+                 "function declaration <line: %u, col: %u> %s %s\n",
+                 p_function.getLocation().line, p_function.getLocation().col,
+                 p_function.getNameCString(), p_function.getPrototypeCString());
 
     incrementIndentation();
     p_function.visitChildNodes(*this);
@@ -74,9 +76,9 @@ void AstDumper::visit(FunctionNode &p_function) {
 void AstDumper::visit(CompoundStatementNode &p_compound_statement) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("compound statement <line: %u, col: %u>\n",
-                p_compound_statement.getLocation().line,
-                p_compound_statement.getLocation().col);
+    std::fprintf(Console::out(), "compound statement <line: %u, col: %u>\n",
+                 p_compound_statement.getLocation().line,
+                 p_compound_statement.getLocation().col);
 
     incrementIndentation();
     p_compound_statement.visitChildNodes(*this);
@@ -86,8 +88,8 @@ void AstDumper::visit(CompoundStatementNode &p_compound_statement) {
 void AstDumper::visit(PrintNode &p_print) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("print statement <line: %u, col: %u>\n",
-                p_print.getLocation().line, p_print.getLocation().col);
+    std::fprintf(Console::out(), "print statement <line: %u, col: %u>\n",
+                 p_print.getLocation().line, p_print.getLocation().col);
 
     incrementIndentation();
     p_print.visitChildNodes(*this);
@@ -97,9 +99,9 @@ void AstDumper::visit(PrintNode &p_print) {
 void AstDumper::visit(BinaryOperatorNode &p_bin_op) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("binary operator <line: %u, col: %u> %s\n",
-                p_bin_op.getLocation().line, p_bin_op.getLocation().col,
-                p_bin_op.getOpCString());
+    std::fprintf(Console::out(), "binary operator <line: %u, col: %u> %s\n",
+                 p_bin_op.getLocation().line, p_bin_op.getLocation().col,
+                 p_bin_op.getOpCString());
 
     incrementIndentation();
     p_bin_op.visitChildNodes(*this);
@@ -109,9 +111,9 @@ void AstDumper::visit(BinaryOperatorNode &p_bin_op) {
 void AstDumper::visit(UnaryOperatorNode &p_un_op) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("unary operator <line: %u, col: %u> %s\n",
-                p_un_op.getLocation().line, p_un_op.getLocation().col,
-                p_un_op.getOpCString());
+    std::fprintf(Console::out(), "unary operator <line: %u, col: %u> %s\n",
+                 p_un_op.getLocation().line, p_un_op.getLocation().col,
+                 p_un_op.getOpCString());
 
     incrementIndentation();
     p_un_op.visitChildNodes(*this);
@@ -121,10 +123,10 @@ void AstDumper::visit(UnaryOperatorNode &p_un_op) {
 void AstDumper::visit(FunctionInvocationNode &p_func_invocation) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("function invocation <line: %u, col: %u> %s\n",
-                p_func_invocation.getLocation().line,
-                p_func_invocation.getLocation().col,
-                p_func_invocation.getNameCString());
+    std::fprintf(Console::out(), "function invocation <line: %u, col: %u> %s\n",
+                 p_func_invocation.getLocation().line,
+                 p_func_invocation.getLocation().col,
+                 p_func_invocation.getNameCString());
 
     incrementIndentation();
     p_func_invocation.visitChildNodes(*this);
@@ -134,10 +136,10 @@ void AstDumper::visit(FunctionInvocationNode &p_func_invocation) {
 void AstDumper::visit(VariableReferenceNode &p_variable_ref) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("variable reference <line: %u, col: %u> %s\n",
-                p_variable_ref.getLocation().line,
-                p_variable_ref.getLocation().col,
-                p_variable_ref.getNameCString());
+    std::fprintf(Console::out(), "variable reference <line: %u, col: %u> %s\n",
+                 p_variable_ref.getLocation().line,
+                 p_variable_ref.getLocation().col,
+                 p_variable_ref.getNameCString());
 
     incrementIndentation();
     p_variable_ref.visitChildNodes(*this);
@@ -147,9 +149,9 @@ void AstDumper::visit(VariableReferenceNode &p_variable_ref) {
 void AstDumper::visit(AssignmentNode &p_assignment) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("assignment statement <line: %u, col: %u>\n",
-                p_assignment.getLocation().line,
-                p_assignment.getLocation().col);
+    std::fprintf(Console::out(), "assignment statement <line: %u, col: %u>\n",
+                 p_assignment.getLocation().line,
+                 p_assignment.getLocation().col);
 
     incrementIndentation();
     p_assignment.visitChildNodes(*this);
@@ -159,8 +161,8 @@ void AstDumper::visit(AssignmentNode &p_assignment) {
 void AstDumper::visit(ReadNode &p_read) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("read statement <line: %u, col: %u>\n",
-                p_read.getLocation().line, p_read.getLocation().col);
+    std::fprintf(Console::out(), "read statement <line: %u, col: %u>\n",
+                 p_read.getLocation().line, p_read.getLocation().col);
 
     incrementIndentation();
     p_read.visitChildNodes(*this);
@@ -170,8 +172,8 @@ void AstDumper::visit(ReadNode &p_read) {
 void AstDumper::visit(IfNode &p_if) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("if statement <line: %u, col: %u>\n", p_if.getLocation().line,
-                p_if.getLocation().col);
+    std::fprintf(Console::out(), "if statement <line: %u, col: %u>\n",
+                 p_if.getLocation().line, p_if.getLocation().col);
 
     incrementIndentation();
     p_if.visitChildNodes(*this);
@@ -181,8 +183,8 @@ void AstDumper::visit(IfNode &p_if) {
 void AstDumper::visit(WhileNode &p_while) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("while statement <line: %u, col: %u>\n",
-                p_while.getLocation().line, p_while.getLocation().col);
+    std::fprintf(Console::out(), "while statement <line: %u, col: %u>\n",
+                 p_while.getLocation().line, p_while.getLocation().col);
 
     incrementIndentation();
     p_while.visitChildNodes(*this);
@@ -192,8 +194,8 @@ void AstDumper::visit(WhileNode &p_while) {
 void AstDumper::visit(ForNode &p_for) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("for statement <line: %u, col: %u>\n", p_for.getLocation().line,
-                p_for.getLocation().col);
+    std::fprintf(Console::out(), "for statement <line: %u, col: %u>\n",
+                 p_for.getLocation().line, p_for.getLocation().col);
 
     incrementIndentation();
     p_for.visitChildNodes(*this);
@@ -203,8 +205,8 @@ void AstDumper::visit(ForNode &p_for) {
 void AstDumper::visit(ReturnNode &p_return) {
     outputIndentationSpace(m_indentation);
 
-    std::printf("return statement <line: %u, col: %u>\n",
-                p_return.getLocation().line, p_return.getLocation().col);
+    std::fprintf(Console::out(), "return statement <line: %u, col: %u>\n",
+                 p_return.getLocation().line, p_return.getLocation().col);
 
     incrementIndentation();
     p_return.visitChildNodes(*this);
@@ -0,0 +1,20 @@
+#include "AST/Console.hpp"
+
+// nullptr means stdout / stderr, which are not constant expressions
+static thread_local FILE *current_out = nullptr;
+static thread_local FILE *current_err = nullptr;
+
+Console::Scope::Scope(FILE *const p_out, FILE *const p_err)
+    : m_previous_out(current_out), m_previous_err(current_err) {
+    current_out = p_out;
+    current_err = p_err;
+}
+
+Console::Scope::~Scope() {
+    current_out = m_previous_out;
+    current_err = m_previous_err;
+}
+
+FILE *Console::out() { return current_out ? current_out : stdout; }
+
+FILE *Console::err() { return current_err ? current_err : stderr; }
@@ -0,0 +1,20 @@
+#include "AST/Identifier.hpp"
+
+#include <mutex>
+#include <unordered_set>
+
+Identifier Identifier::get(const char *const p_name, const size_t length) {
+    // node-based, so the strings never move once inserted
+    static std::unordered_set<std::string> names;
+    static std::mutex names_mutex;
+    // reused for the lookup, so that a name seen before costs no allocation
+    static std::string key;
+
+    std::lock_guard<std::mutex> lock(names_mutex);
+    key.assign(p_name, length);
+    auto search = names.find(key);
+    if (search == names.end()) {
+        search = names.emplace(key).first;
+    }
+    return Identifier(&*search);
+}
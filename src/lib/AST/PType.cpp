@@ -1,44 +1,90 @@
 #include "AST/PType.hpp"
 
 #include <cassert>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
 
 const char *kTypeString[] = {"void", "integer", "real", "boolean", "string"};
 
-// logical constness
-const char *PType::getPTypeCString() const {
-    if (!m_type_string_is_valid) {
-        m_type_string += kTypeString[static_cast<size_t>(m_type)];
+static constexpr size_t kNumPrimitiveTypes =
+    sizeof(kTypeString) / sizeof(kTypeString[0]);
 
-        if (m_dimensions.size() != 0) {
-            m_type_string += " ";
+PType::PType(const PrimitiveTypeEnum type, std::vector<uint64_t> p_dims)
+    : m_type(type), m_dimensions(std::move(p_dims)) {
+    m_type_string += kTypeString[static_cast<size_t>(m_type)];
 
-            for (const auto &dim : m_dimensions) {
-                m_type_string += "[" + std::to_string(dim) + "]";
-            }
+    if (m_dimensions.size() != 0) {
+        m_type_string += " ";
+
+        for (const auto &dim : m_dimensions) {
+            m_type_string += "[" + std::to_string(dim) + "]";
         }
-        m_type_string_is_valid = true;
     }
+}
+
+static std::mutex types_mutex;
+
+// the caller holds types_mutex
+const PType *PType::intern(const PrimitiveTypeEnum type,
+                           const std::vector<uint64_t> &p_dims) {
+    if (p_dims.empty()) {
+        return get(type);
+    }
+
+    static std::map<std::pair<PrimitiveTypeEnum, std::vector<uint64_t>>,
+                    std::unique_ptr<PType>>
+        array_types;
 
-    return m_type_string.c_str();
+    auto &slot = array_types[{type, p_dims}];
+    if (!slot) {
+        slot.reset(new PType(type, p_dims));
+        slot->m_element_type = intern(
+            type, std::vector<uint64_t>(p_dims.begin() + 1, p_dims.end()));
+    }
+    return slot.get();
 }
 
-PType *PType::getStructElementType(const std::size_t nth) const {
-    if (nth > m_dimensions.size()) {
-        return nullptr;
+const PType *PType::get(const PrimitiveTypeEnum type) {
+    // scalar types are looked up without locking or allocating
+    static const std::unique_ptr<PType> scalar_types[kNumPrimitiveTypes] = {
+        std::unique_ptr<PType>(new PType(PrimitiveTypeEnum::kVoidType, {})),
+        std::unique_ptr<PType>(new PType(PrimitiveTypeEnum::kIntegerType, {})),
+        std::unique_ptr<PType>(new PType(PrimitiveTypeEnum::kRealType, {})),
+        std::unique_ptr<PType>(new PType(PrimitiveTypeEnum::kBoolType, {})),
+        std::unique_ptr<PType>(new PType(PrimitiveTypeEnum::kStringType, {}))};
+
+    return scalar_types[static_cast<size_t>(type)].get();
+}
+
+const PType *PType::get(const PrimitiveTypeEnum type,
+                        const std::vector<uint64_t> &p_dims) {
+    if (p_dims.empty()) {
+        return get(type);
     }
 
-    auto *type_ptr = new PType(m_type);
+    std::lock_guard<std::mutex> lock(types_mutex);
+    return intern(type, p_dims);
+}
 
-    std::vector<uint64_t> dims;
-    for (std::size_t i = nth; i < m_dimensions.size(); ++i) {
-        dims.emplace_back(m_dimensions[i]);
+const PType *PType::getStructElementType(const std::size_t nth) const {
+    if (nth > m_dimensions.size()) {
+        return nullptr;
     }
-    type_ptr->setDimensions(dims);
 
+    const PType *type_ptr = this;
+    for (std::size_t i = 0; i < nth; ++i) {
+        type_ptr = type_ptr->m_element_type;
+    }
     return type_ptr;
 }
 
 bool PType::compare(const PType *p_type) const {
+    if (this == p_type) {
+        return true;
+    }
+
     // primitive type comparison
     switch(m_type) {
     case PrimitiveTypeEnum::kIntegerType:
@@ -48,30 +94,15 @@ bool PType::compare(const PType *p_type) const {
         }
         break;
     case PrimitiveTypeEnum::kBoolType:
-        if (!p_type->isPrimitiveBool()) {
-            return false;
-        }
-        break;
     case PrimitiveTypeEnum::kStringType:
-        if (!p_type->isPrimitiveString()) {
-            return false;
-        }
-        break;
+        // interned types with the same primitive type and dimensions would
+        // have been the same pointer
+        return false;
     default:
         assert(false && "comparing unknown primitive type or void type");
         return false;
     }
 
     // dimensions comparison
-    auto &dimensions = p_type->getDimensions();
-    if (m_dimensions.size() != dimensions.size()) {
-        return false;
-    }
-    for (decltype(m_dimensions)::size_type i = 0; i < m_dimensions.size(); ++i) {
-        if (m_dimensions[i] != dimensions[i]) {
-            return false;
-        }
-    }
-
-    return true;
+    return m_dimensions == p_type->getDimensions();
 }
@@ -0,0 +1,117 @@
+#include "AST/SourceBuffer.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static thread_local const SourceBuffer *current_buffer = nullptr;
+
+SourceBuffer::Scope::Scope(const SourceBuffer &p_buffer)
+    : m_previous(current_buffer) {
+    current_buffer = &p_buffer;
+}
+
+SourceBuffer::Scope::~Scope() { current_buffer = m_previous; }
+
+const SourceBuffer *SourceBuffer::getCurrent() { return current_buffer; }
+
+SourceBuffer::~SourceBuffer() {
+    if (m_mapped_size) {
+        munmap(m_data, m_mapped_size);
+    }
+}
+
+// Maps p_size bytes of p_fd followed by at least two zero bytes. The bytes
+// between the end of the file and the end of its last page read as zero;
+// reserving an anonymous (zero-filled) region first and mapping the file
+// over its beginning covers files that end on a page boundary.
+static char *mapWithTrailingNuls(const int p_fd, const size_t p_size,
+                                 size_t &p_mapped_size) {
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    p_mapped_size = (p_size + 2 + page_size - 1) / page_size * page_size;
+
+    void *region = mmap(nullptr, p_mapped_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        return nullptr;
+    }
+    if (mmap(region, p_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+             p_fd, 0) == MAP_FAILED) {
+        munmap(region, p_mapped_size);
+        return nullptr;
+    }
+    return static_cast<char *>(region);
+}
+
+bool SourceBuffer::open(const char *const p_path) {
+    const int fd = ::open(p_path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+        file_stat.st_size > 0) {
+        m_data = mapWithTrailingNuls(fd, file_stat.st_size, m_mapped_size);
+        if (m_data) {
+            m_size = file_stat.st_size;
+            close(fd);
+            return true;
+        }
+        m_mapped_size = 0;
+    }
+
+    char chunk[64 * 1024];
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+        m_fallback.insert(m_fallback.end(), chunk, chunk + n);
+    }
+    close(fd);
+    if (n < 0) {
+        return false;
+    }
+
+    m_size = m_fallback.size();
+    m_fallback.resize(m_size + 2, '\0');
+    m_data = m_fallback.data();
+    return true;
+}
+
+void SourceBuffer::buildLineIndex() const {
+    m_line_starts.emplace_back(0);
+
+    const char *cursor = m_data;
+    const char *const end = m_data + m_size;
+    while (cursor != end) {
+        const auto *newline =
+            static_cast<const char *>(memchr(cursor, '\n', end - cursor));
+        if (!newline) {
+            break;
+        }
+        cursor = newline + 1;
+        m_line_starts.emplace_back(cursor - m_data);
+    }
+}
+
+bool SourceBuffer::getLine(const uint32_t line, const char *&p_begin,
+                           size_t &p_length) const {
+    if (m_line_starts.empty()) {
+        buildLineIndex();
+    }
+    if (line == 0 || line > m_line_starts.size()) {
+        return false;
+    }
+
+    const size_t begin = m_line_starts[line - 1];
+    size_t end = (line < m_line_starts.size()) ? m_line_starts[line] - 1
+                                                : m_size;
+    if (end > begin && m_data[end - 1] == '\r') {
+        --end;
+    }
+
+    p_begin = m_data + begin;
+    p_length = end - begin;
+    return true;
+}
@@ -0,0 +1,83 @@
+#include "AST/Tracer.hpp"
+
+#include <cstdio>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+uint64_t Tracer::getTime() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+Tracer::Scope::Scope(Tracer *p_tracer)
+    : m_tracer(p_tracer), m_previous(getCurrentBuffer()) {
+    if (!m_tracer) {
+        return;
+    }
+    m_buffer.reset(new Buffer);
+    m_buffer->thread_id = static_cast<int32_t>(syscall(SYS_gettid));
+    getCurrentBuffer() = m_buffer.get();
+}
+
+Tracer::Scope::~Scope() {
+    if (!m_tracer) {
+        return;
+    }
+    getCurrentBuffer() = m_previous;
+    std::lock_guard<std::mutex> lock(m_tracer->m_mutex);
+    m_tracer->m_buffers.push_back(std::move(m_buffer));
+}
+
+void Tracer::Span::finish() {
+    const uint64_t end_ns = getTime();
+    m_buffer->events.push_back(Event{m_category, m_name,
+                                     m_detail ? m_detail : std::string(),
+                                     m_start_ns, end_ns - m_start_ns});
+}
+
+// enough for paths and identifiers, which have no control characters
+static void printJsonString(FILE *p_out, const std::string &p_string) {
+    std::fputc('"', p_out);
+    for (const char c : p_string) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', p_out);
+        }
+        std::fputc(c, p_out);
+    }
+    std::fputc('"', p_out);
+}
+
+bool Tracer::write(const std::string &p_path) {
+    FILE *out = std::fopen(p_path.c_str(), "w");
+    if (!out) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int pid = getpid();
+    // timestamps and durations are in microseconds
+    std::fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    const char *separator = "\n";
+    for (const auto &buffer : m_buffers) {
+        for (const auto &event : buffer->events) {
+            std::fprintf(out,
+                         "%s{\"ph\": \"X\", \"pid\": %d, \"tid\": %d, "
+                         "\"ts\": %.3f, \"dur\": %.3f, \"cat\": \"%s\", "
+                         "\"name\": \"%s\"",
+                         separator, pid, buffer->thread_id,
+                         (event.start_ns - m_start_ns) / 1e3,
+                         event.duration_ns / 1e3, event.category, event.name);
+            if (!event.detail.empty()) {
+                std::fprintf(out, ", \"args\": {\"detail\": ");
+                printJsonString(out, event.detail);
+                std::fprintf(out, "}");
+            }
+            std::fprintf(out, "}");
+            separator = ",\n";
+        }
+    }
+    std::fprintf(out, "\n]}\n");
+    return std::fclose(out) == 0;
+}
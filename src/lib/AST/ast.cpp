@@ -1,4 +1,7 @@
 #include <AST/ast.hpp>
+#include <AST/AstArena.hpp>
+
+#include <cassert>
 
 // prevent the linker from complaining
 AstNode::~AstNode() {}
@@ -7,3 +10,9 @@ AstNode::AstNode(const uint32_t line, const uint32_t col)
     : location(line, col) {}
 
 const Location &AstNode::getLocation() const { return location; }
+
+void *AstNode::operator new(const size_t size) {
+    auto *arena = AstArena::getCurrent();
+    assert(arena && "AST nodes can only be created inside an AstArena::Scope");
+    return arena->allocate(size, alignof(std::max_align_t));
+}
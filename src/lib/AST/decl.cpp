@@ -3,7 +3,7 @@
 #include <algorithm>
 
 void DeclNode::init(const std::vector<IdInfo> *const p_ids,
-                    const PTypeSharedPtr &p_type,
+                    const PType *const p_type,
                     ConstantValueNode *const p_constant) {
     std::shared_ptr<ConstantValueNode> shared_constant(p_constant);
 
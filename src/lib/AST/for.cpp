@@ -2,9 +2,18 @@
 
 #include <cassert>
 
+Identifier ForNode::getLoopVarIdentifier() const {
+    const auto variable_it = m_loop_var_decl->getVariables().begin();
+    return (*variable_it)->getIdentifier();
+}
+
 const std::string &ForNode::getLoopVarName() const {
+    return getLoopVarIdentifier().str();
+}
+
+const SymbolEntry *ForNode::getLoopVarSymbolEntry() const {
     const auto variable_it = m_loop_var_decl->getVariables().begin();
-    return (*variable_it)->getName();
+    return (*variable_it)->getSymbolEntry();
 }
 
 const ConstantValueNode &ForNode::getLowerBound() const {
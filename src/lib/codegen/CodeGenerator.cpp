@@ -1,19 +1,29 @@
 #include "codegen/CodeGenerator.hpp"
+#include "AST/Tracer.hpp"
 #include "AST/operator.hpp"
+#include "driver/TimeReport.hpp"
 #include "visitor/AstNodeInclude.hpp"
 
 #include <algorithm>
 #include <cassert>
-#include <cstdarg>
-#include <cstdio>
-#include <sstream>
-#include <iostream>
+
+static std::string makeModuleHeader(const std::string &source_file_name) {
+    // clang-format off
+    return "source_filename = \"" + source_file_name + "\"\n"
+           "target datalayout = \"e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128\"\n"
+           "target triple = \"x86_64-pc-linux-gnu\"\n";
+    // clang-format on
+}
 
 CodeGenerator::CodeGenerator(const std::string source_file_name,
-                             const std::string save_path,
-                             const SymbolManager *const p_symbol_manager)
-    : m_symbol_manager_ptr(p_symbol_manager),
-      m_source_file_path(source_file_name) {
+                             const int output_fd, const bool use_ssa)
+    : m_source_file_path(source_file_name), m_output_fd(output_fd),
+      m_module(makeModuleHeader(source_file_name)), m_builder(m_module),
+      m_use_ssa(use_ssa), m_ssa(m_builder) {}
+
+std::string
+CodeGenerator::getOutputFilePath(const std::string &source_file_name,
+                                 const std::string &save_path) {
     // FIXME: assume that the source file is always xxxx.p
     const std::string &real_path =
         (save_path == "") ? std::string{"."} : save_path;
@@ -25,38 +35,53 @@ CodeGenerator::CodeGenerator(const std::string source_file_name,
     } else {
         slash_pos = 0;
     }
-    std::string output_file_path(
-        real_path + "/" +
-        source_file_name.substr(slash_pos, dot_pos - slash_pos) + ".ll");
-    m_output_file.reset(fopen(output_file_path.c_str(), "w"));
-    assert(m_output_file.get() && "Failed to open output file");
+    return real_path + "/" +
+           source_file_name.substr(slash_pos, dot_pos - slash_pos) + ".ll";
 }
 
-static void emitInstructions(FILE *p_out_file, const char *format, ...) {
-    va_list args;
-    va_start(args, format);
-    vfprintf(p_out_file, format, args);
-    va_end(args);
+const IrType *CodeGenerator::getIrType(const PType *const p_type,
+                                       const bool is_parameter) {
+    const IrType *element_type = nullptr;
+    if (p_type->isPrimitiveInteger())
+        element_type = m_module.getIntegerType(32);
+    else if (p_type->isPrimitiveBool())
+        element_type = m_module.getIntegerType(1);
+    else
+        assert(false && "Not supported!");
+
+    // support 1D & 2D arrays for now
+    const auto &dim = p_type->getDimensions();
+    assert(dim.size() <= 2 && "Not supported!");
+    if (dim.empty())
+        return element_type;
+    if (is_parameter) {
+        // arrays are passed by pointer to their first element
+        if (dim.size() == 2)
+            element_type = m_module.getArrayType(element_type, dim[1]);
+        return m_module.getPointerType(element_type);
+    }
+    for (auto iter = dim.rbegin(); iter != dim.rend(); ++iter)
+        element_type = m_module.getArrayType(element_type, *iter);
+    return element_type;
 }
 
 void CodeGenerator::visit(ProgramNode &p_program) {
-    // Generate RISC-V instructions for program header
-    // clang-format off
-    constexpr const char*const llvm_ir_file_prologue =
-        "source_filename = \"%s\"\n"
-        "target datalayout = \"e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128\"\n"
-        "target triple = \"x86_64-pc-linux-gnu\"\n\n"
-        "declare i32 @printf(i8*, ...)\n"
-        "declare i32 @__isoc99_scanf(i8*, ...)\n\n"
-        "@.str = private unnamed_addr constant [4 x i8] c\"%%d\\0A\\00\", align 1\n";
-
-    // clang-format on
-    emitInstructions(m_output_file.get(), llvm_ir_file_prologue,
-                     m_source_file_path.c_str());
-
-    // Reconstruct the hash table for looking up the symbol entry
-    // Hint: Use symbol_manager->lookup(symbol_name) to get the symbol entry.
-    m_symbol_manager_ptr->reconstructHashTableFromSymbolTable(p_program.getSymbolTable());
+    const auto *i32_type = m_module.getIntegerType(32);
+    const auto *i8_ptr_type =
+        m_module.getPointerType(m_module.getIntegerType(8));
+    m_printf = m_module.createFunction("printf", i32_type, {i8_ptr_type},
+                                       /* is_var_arg */ true);
+    m_scanf = m_module.createFunction("__isoc99_scanf", i32_type,
+                                      {i8_ptr_type}, /* is_var_arg */ true);
+    m_module.createGlobalVariable(
+        m_module.getArrayType(m_module.getIntegerType(8), 4), ".str",
+        "private unnamed_addr constant [4 x i8] c\"%d\\0A\\00\", align 1");
+    m_format_string = m_module.createConstantExpr(
+        i8_ptr_type,
+        "getelementptr inbounds ([4 x i8], [4 x i8]* @.str, i64 0, i64 0)");
+
+    // The semantic analyzer has attached the symbol entries to the nodes that
+    // declare or reference a symbol, so no symbol table is needed here.
     m_context_stack.push(CodegenContext::kGlobal);
 
     auto visit_ast_node = [&](auto &ast_node) { ast_node->accept(*this); };
@@ -65,109 +90,84 @@ void CodeGenerator::visit(ProgramNode &p_program) {
     for_each(p_program.getFuncNodes().begin(), p_program.getFuncNodes().end(),
              visit_ast_node);
 
-    constexpr const char*const llvm_ir_main_prologue =
-        "\ndefine i32 @main() {\n";
-    emitInstructions(m_output_file.get(), llvm_ir_main_prologue,
-                     m_source_file_path.c_str());
+    {
+        TRACE_SPAN("codegen", "function", "main");
+        m_builder.setFunction(m_module.createFunction("main", i32_type, {}));
+        m_ssa.clear();
 
-    m_local_var_offset = 1;
-    const_cast<CompoundStatementNode &>(p_program.getBody()).accept(*this);
+        const_cast<CompoundStatementNode &>(p_program.getBody()).accept(*this);
 
-    constexpr const char*const llvm_ir_main_epilogue =
-        "\n  ret i32 0\n"
-        "}";
-    emitInstructions(m_output_file.get(), llvm_ir_main_epilogue,
-                     m_source_file_path.c_str());
+        m_builder.createRet(m_builder.getInt32(0));
+    }
 
-    // Remove the entries in the hash table
     m_context_stack.pop();
-    m_symbol_manager_ptr->removeSymbolsFromHashTable(p_program.getSymbolTable());
+
+    if (m_optimizer_options.level > 0) {
+        TimeReport::Scope time_scope(m_time_report,
+                                     TimeReport::PhaseEnum::kOptimize);
+        TRACE_SPAN("codegen", "optimize");
+        Optimizer(m_optimizer_options).run(m_module);
+    }
+
+    OutputBuffer output;
+    {
+        TRACE_SPAN("codegen", "print module");
+        m_module.print(output);
+    }
+    {
+        TRACE_SPAN("codegen", "flush module", "output");
+        const bool written = output.writeTo(m_output_fd);
+        assert(written && "Failed to write output file");
+        (void)written;
+    }
+    if (m_module_copy_fd >= 0) {
+        TRACE_SPAN("codegen", "flush module", "compile cache");
+        m_is_module_copied = output.writeTo(m_module_copy_fd);
+    }
 }
 
 void CodeGenerator::visit(DeclNode &p_decl) { p_decl.visitChildNodes(*this); }
 
 void CodeGenerator::visit(VariableNode &p_variable) {
     const auto *constant_ptr = p_variable.getConstantPtr();
+    const auto *entry_ptr = p_variable.getSymbolEntry();
     if (isInGlobal(m_context_stack)) {
         int init_val = 0;
         if (constant_ptr)
             init_val = constant_ptr->integer();
         if (p_variable.getTypePtr()->isInteger()) {
-            emitInstructions(m_output_file.get(), 
-                    "@%s = global i32 %d, align 4\n",
-                    p_variable.getNameCString(), init_val);
+            entry_ptr->setCodegenSlot(m_module.createGlobalVariable(
+                m_module.getIntegerType(32), p_variable.getName(),
+                "global i32 " + std::to_string(init_val) + ", align 4"));
         }
         return;
     }
 
     if (isInLocal(m_context_stack)) {
-        auto dim = p_variable.getTypePtr()->getDimensions();
-        m_local_var_offset_map.emplace(
-                std::piecewise_construct,
-                std::forward_as_tuple(
-                    m_symbol_manager_ptr->lookup(p_variable.getName())),
-                std::forward_as_tuple(m_local_var_offset));
-        if (!dim.size()) { // primitive
-            if (p_variable.getTypePtr()->isInteger()) {
-                emitInstructions(m_output_file.get(),
-                                    "  %%%d = alloca i32, align 4"
-                                    " ; allocate %s\n",
-                                    m_local_var_offset, p_variable.getName().c_str());
-            }
-            else if (p_variable.getTypePtr()->isBool()) {
-                emitInstructions(m_output_file.get(),
-                                    "  %%%d = alloca i1, align 4"
-                                    " ; allocate %s\n",
-                                    m_local_var_offset, p_variable.getName().c_str());
-            }
-            else
-                assert(false && "Not supported!");
-
+        const bool is_parameter =
+            entry_ptr->getKind() == SymbolEntry::KindEnum::kParameterKind;
+        const auto *type = getIrType(p_variable.getTypePtr(), is_parameter);
+        if (m_use_ssa && !type->isPointer() && !type->isArray()) {
+            m_ssa.declareVariable(entry_ptr, type);
             if (constant_ptr) {
-                std::stringstream target;
-                target << "%" << p_variable.getName();
-                emitInstructions(m_output_file.get(),
-                                "  store i32 %d, i32* %%%d, align 4"
-                                " ; store to %s\n",
-                                constant_ptr->integer(), m_local_var_offset, target.str().c_str());
+                m_ssa.writeVariable(
+                    entry_ptr, m_builder.getInsertBlock(),
+                    m_module.getConstantInt(type, constant_ptr->integer()));
             }
+            return;
         }
-        else {
-            if (!call_stack.size()) { // in main
-                if (dim.size() == 1) { // 1D array
-                    emitInstructions(m_output_file.get(),
-                                    "  %%%d = alloca [%d x i32], align 16"
-                                    " ; allocate %s\n",
-                                    m_local_var_offset, dim[0], p_variable.getName().c_str());
-                }
-                else if (dim.size() == 2) { // 2D array
-                    emitInstructions(m_output_file.get(),
-                                    "  %%%d = alloca [%d x [%d x i32]], align 16"
-                                    " ; allocate %s\n",
-                                    m_local_var_offset, dim[0], dim[1], p_variable.getName().c_str());
-                }
-                else
-                    assert(false && "Not Supported!");
-            }
-            else { // not in main
-                if (dim.size() == 1) { // 1D array
-                    emitInstructions(m_output_file.get(),
-                                    "  %%%d = alloca i32*, align 8"
-                                    " ; allocate %s\n",
-                                    m_local_var_offset, p_variable.getName().c_str());
-                }
-                else if (dim.size() == 2) { // 2D array
-                    emitInstructions(m_output_file.get(),
-                                    "  %%%d = alloca [%d x i32]*, align 8"
-                                    " ; allocate %s\n",
-                                    m_local_var_offset, dim[1], p_variable.getName().c_str());
-                }
-                else
-                    assert(false && "Not Supported!");
-            }
-        }
-        m_local_var_offset += 1;
 
+        auto *address =
+            m_builder.createAlloca(type, "allocate " + p_variable.getName());
+        entry_ptr->setCodegenSlot(address);
+
+        if (constant_ptr) {
+            IrValue *value = p_variable.getTypePtr()->isBool()
+                                 ? m_builder.getInt1(constant_ptr->integer())
+                                 : m_builder.getInt32(constant_ptr->integer());
+            m_builder.createStore(value, address,
+                                  "store to %" + p_variable.getName());
+        }
         return;
     }
     assert(false && "Shouln't reach here. It means that the context has wrong value");
@@ -182,746 +182,550 @@ void CodeGenerator::visit(ConstantValueNode &p_constant_value) {
 }
 
 void CodeGenerator::visit(FunctionNode &p_function) {
-    call_stack.push(1);
-
-    m_symbol_manager_ptr->reconstructHashTableFromSymbolTable(
-        p_function.getSymbolTable());
+    TRACE_SPAN("codegen", "function", p_function.getNameCString());
     m_context_stack.push(CodegenContext::kLocal);
 
-    m_local_var_offset = 0;
-
-    std::string return_type;
+    const IrType *return_type = nullptr;
     if (p_function.getTypePtr()->isInteger())
-        return_type = "i32";
+        return_type = m_module.getIntegerType(32);
     else if (p_function.getTypePtr()->isBool())
-        return_type = "i1";
+        return_type = m_module.getIntegerType(1);
     else
         assert(false && "Not supported!");
-    std::stringstream function_head;
-    function_head << "\ndefine " << return_type << " @" << p_function.getName() << "(";
-    
-    // support one decl node in function parameter list for now
-    for (auto& params : p_function.getParameters()) {
-        auto &variables = params->getVariables();
-        for (size_t i = 0; i < variables.size(); ++i) {
-            auto type_ptr = variables[i]->getTypePtr();
-            if (!type_ptr->getDimensions().size()) { // primitive
-                if (type_ptr->getPrimitiveType() == PType::PrimitiveTypeEnum::kIntegerType)
-                    function_head << "i32 %" << m_local_var_offset++;
-                else if (type_ptr->getPrimitiveType() == PType::PrimitiveTypeEnum::kBoolType)
-                    function_head << "i1 %" << m_local_var_offset++;
-                else
-                    assert(false && "Not supported!");
-            }
-            else { // array, support 1D & 2D integer array for now
-                auto dim = type_ptr->getDimensions();
-                if (dim.size() == 1) { // 1D array
-                    function_head << "i32* %" << m_local_var_offset++;
-                }
-                else if (dim.size() == 2) { // 2D array
-                    function_head << "[" << dim[1] << " x i32]* %" << m_local_var_offset++;
-                }
-                else
-                    assert(false && "Not supported!");
-            }
-            if (params != *(p_function.getParameters().end() - 1) || i != variables.size() - 1)
-                function_head << ", ";
-        }
-    }
-    function_head << ") {";
 
-    emitInstructions(m_output_file.get(), "%s\n", function_head.str().c_str());
+    std::vector<const IrType *> param_types;
+    for (auto &params : p_function.getParameters())
+        for (auto &variable : params->getVariables())
+            param_types.emplace_back(getIrType(variable->getTypePtr(), true));
 
-    m_local_var_offset += 1; // reserve one value for entry block
+    auto *function = m_module.createFunction(p_function.getName(),
+                                             return_type, param_types);
+    p_function.getSymbolEntry()->setCodegenSlot(function);
+    m_builder.setFunction(function);
+    m_ssa.clear();
 
     auto visit_ast_node = [&](auto &ast_node) { ast_node->accept(*this); };
     for_each(p_function.getParameters().begin(),
              p_function.getParameters().end(), visit_ast_node);
 
-    int offset = 0;
-    int var_num = 0;
-    for (auto& params : p_function.getParameters())
-        var_num += params->getVariables().size();
-    for (auto iter = p_function.getParameters().rbegin(); iter != p_function.getParameters().rend(); ++iter) {
-        auto &variables = (*iter)->getVariables();
-        // store parameter's value to alloca variable
-        for (int i = 0; i < variables.size(); ++i) {
-            int alloca_var_number = m_local_var_offset - offset - 1;
-            int param_number = alloca_var_number - var_num - 1;
-            offset += 1;
-            auto type_ptr = variables[i]->getTypePtr();
-            if (!type_ptr->getDimensions().size()) { // primitive
-                if (type_ptr->getPrimitiveType() == PType::PrimitiveTypeEnum::kIntegerType) {
-                    emitInstructions(m_output_file.get(),
-                                "  store i32 %%%d, i32* %%%d, align 4 ; store parameter's value to alloca variable\n",
-                                param_number, alloca_var_number);
-                }
-                else if (type_ptr->getPrimitiveType() == PType::PrimitiveTypeEnum::kBoolType) {
-                    emitInstructions(m_output_file.get(),
-                                "  store i1 %%%d, i1* %%%d, align 4 ; store parameter's value to alloca variable\n",
-                                param_number, alloca_var_number);
-                }
-                else
-                    assert(false && "Not supported!");
-            }
-            else { // array
-                auto dim = type_ptr->getDimensions();
-                if (dim.size() == 1) { // 1D array
-                    emitInstructions(m_output_file.get(),
-                                "  store i32* %%%d, i32** %%%d, align 8\n",
-                                param_number, alloca_var_number);
-                }
-                else if (dim.size() == 2) { // 2D array
-                    emitInstructions(m_output_file.get(),
-                                "  store [%d x i32]* %%%d, [%d x i32]** %%%d, align 8\n",
-                                dim[1], param_number, dim[1], alloca_var_number);
-                }
-                else
-                    assert(false && "Not supported!");
-            }
+    std::vector<const SymbolEntry *> param_entries;
+    for (auto &params : p_function.getParameters())
+        for (auto &variable : params->getVariables())
+            param_entries.emplace_back(variable->getSymbolEntry());
+
+    // store parameter's value to alloca variable
+    for (size_t i = param_entries.size(); i-- > 0;) {
+        auto *argument = function->getArgument(i);
+        if (m_ssa.isTracked(param_entries[i])) {
+            m_ssa.writeVariable(param_entries[i], m_builder.getInsertBlock(),
+                                argument);
+            continue;
         }
+        m_builder.createStore(argument, param_entries[i]->getCodegenSlot(),
+                              argument->getType()->isPointer()
+                                  ? ""
+                                  : "store parameter's value to alloca variable");
     }
 
     p_function.visitBodyChildNodes(*this);
-    emitInstructions(m_output_file.get(), "}\n");
+    // falling off the end of a function with a return type
+    if (!m_builder.isTerminated())
+        m_builder.createUnreachable();
 
     m_context_stack.pop();
-    m_symbol_manager_ptr->removeSymbolsFromHashTable(
-        p_function.getSymbolTable());
-
-    call_stack.pop();
 }
 
 void CodeGenerator::visit(CompoundStatementNode &p_compound_statement) {
-    m_symbol_manager_ptr->reconstructHashTableFromSymbolTable(
-        p_compound_statement.getSymbolTable());
     m_context_stack.push(CodegenContext::kLocal);
 
     p_compound_statement.visitChildNodes(*this);
 
     m_context_stack.pop();
-    m_symbol_manager_ptr->removeSymbolsFromHashTable(
-        p_compound_statement.getSymbolTable());
 }
 
 void CodeGenerator::visit(PrintNode &p_print) {
     m_ref_to_value = true;
     p_print.visitChildNodes(*this);
 
-    auto value_type = popFromStack();
-    CurrentValueType type = value_type.second;
-    if (type == CurrentValueType::REG) {
-        int reg = value_type.first.reg;
-        emitInstructions(m_output_file.get(), "  %%%ld = call i32 (i8*, ...) @printf(i8* getelementptr inbounds"
-                                            " ([4 x i8], [4 x i8]* @.str, i64 0, i64 0), i32 %%%d)\n",
-                                            m_local_var_offset, reg);
-        m_local_var_offset += 1;
+    auto *value = popIrValueFromStack();
+    m_builder.createCall(m_printf, {m_format_string, value});
+}
+
+// Evaluates an operator whose operands are both literals. Returns false if
+// the result is not defined at compile time (division by zero, overflow of
+// sdiv/srem), in which case the instruction is emitted as usual.
+static bool foldBinaryOperator(const Operator op, const int32_t lhs,
+                               const int32_t rhs, int32_t &result) {
+    // wrap around like the two's complement hardware would
+    auto wrap = [](const int64_t value) {
+        return static_cast<int32_t>(static_cast<uint32_t>(value));
+    };
+    switch (op) {
+    case Operator::kMultiplyOp:
+        result = wrap(static_cast<int64_t>(lhs) * rhs);
+        return true;
+    case Operator::kDivideOp:
+    case Operator::kModOp:
+        if (rhs == 0 || (lhs == INT32_MIN && rhs == -1))
+            return false;
+        result = (op == Operator::kDivideOp) ? lhs / rhs : lhs % rhs;
+        return true;
+    case Operator::kPlusOp:
+        result = wrap(static_cast<int64_t>(lhs) + rhs);
+        return true;
+    case Operator::kMinusOp:
+        result = wrap(static_cast<int64_t>(lhs) - rhs);
+        return true;
+    case Operator::kLessOp:
+        result = lhs < rhs;
+        return true;
+    case Operator::kLessOrEqualOp:
+        result = lhs <= rhs;
+        return true;
+    case Operator::kGreaterOp:
+        result = lhs > rhs;
+        return true;
+    case Operator::kGreaterOrEqualOp:
+        result = lhs >= rhs;
+        return true;
+    case Operator::kEqualOp:
+        result = lhs == rhs;
+        return true;
+    case Operator::kNotEqualOp:
+        result = lhs != rhs;
+        return true;
+    default:
+        return false;
     }
-    else
-        assert(false && "Shouldn't reach here!");
 }
 
 void CodeGenerator::visit(BinaryOperatorNode &p_bin_op) {
+    if (p_bin_op.getOp() == Operator::kAndOp ||
+        p_bin_op.getOp() == Operator::kOrOp) {
+        generateShortCircuit(p_bin_op);
+        return;
+    }
+
     p_bin_op.visitChildNodes(*this);
 
     assert(m_value_stack.size() > 1 && m_type_stack.size() > 1 &&
             "There should be at least two value on both stacks!");
 
-    auto value_type2 = popFromStack();
-    auto value_type1 = popFromStack();
-    int int1 = value_type1.first.d;
-    int int2 = value_type2.first.d;
-    int reg1 = value_type1.first.reg;
-    int reg2 = value_type2.first.reg;
+    auto rhs_value = popFromStack();
+    auto lhs_value = popFromStack();
+
+    // fold literal operands, the result stays a literal so that enclosing
+    // expressions can be folded as well
+    int32_t folded = 0;
+    if (isLiteral(lhs_value.second) && isLiteral(rhs_value.second) &&
+        foldBinaryOperator(p_bin_op.getOp(), getLiteral(lhs_value),
+                           getLiteral(rhs_value), folded)) {
+        if (p_bin_op.getInferredType()->isBool())
+            pushBoolToStack(folded);
+        else
+            pushIntToStack(folded);
+        return;
+    }
 
-    auto type1 = value_type1.second;
-    auto type2 = value_type2.second;
+    auto *rhs = materialize(rhs_value);
+    auto *lhs = materialize(lhs_value);
 
+    using Opcode = IrInstruction::OpcodeEnum;
+    using Predicate = IrInstruction::PredicateEnum;
+    IrValue *result = nullptr;
     switch (p_bin_op.getOp()) {
     case Operator::kMultiplyOp:
-        if (type1 == CurrentValueType::REG && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = mul nsw i32 %%%d, %%%d\n", m_local_var_offset, reg1, reg2);
-        else if (type1 == CurrentValueType::REG && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = mul nsw i32 %%%d, %d\n", m_local_var_offset, int1, int2);
-        else if (type1 == CurrentValueType::INT && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = mul nsw i32 %d, %%%d\n", m_local_var_offset, int1, int2);
-        else if (type1 == CurrentValueType::INT && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = mul nsw i32 %d, %d\n", m_local_var_offset, int1, int2);
-        else
-            assert(false && "Not supported!\n");
+        result = m_builder.createBinary(Opcode::kMul, lhs, rhs);
         break;
     case Operator::kDivideOp:
-        if (type1 == CurrentValueType::REG && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = sdiv exact i32 %%%d, %%%d\n", m_local_var_offset, reg1, reg2);
-        else if (type1 == CurrentValueType::INT && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = sdiv exact i32 %d, %d\n", m_local_var_offset, int1, int2);
-        else
-            assert(false && "Not supported!\n");
+        result = m_builder.createBinary(Opcode::kSDiv, lhs, rhs);
         break;
     case Operator::kModOp:
-         if (type1 == CurrentValueType::REG && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = srem i32 %%%d, %%%d\n", m_local_var_offset, reg1, reg2);
-        else if (type1 == CurrentValueType::INT && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = srem i32 %d, %d\n", m_local_var_offset, int1, int2);
-        else
-            assert(false && "Not supported!\n");
+        result = m_builder.createBinary(Opcode::kSRem, lhs, rhs);
         break;
     case Operator::kPlusOp:
-        if (type1 == CurrentValueType::REG && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = add nsw i32 %%%d, %%%d\n", m_local_var_offset, reg1, reg2);
-        else if (type1 == CurrentValueType::REG && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = add nsw i32 %%%d, %d\n", m_local_var_offset, reg1, int2);
-        else if (type1 == CurrentValueType::INT && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = add nsw i32 %d, %%%d\n", m_local_var_offset, int1, int2);
-        else if (type1 == CurrentValueType::INT && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = add nsw i32 %d, %d\n", m_local_var_offset, int1, int2);
-        else
-            assert(false && "Not supported!\n");
+        result = m_builder.createBinary(Opcode::kAdd, lhs, rhs);
         break;
     case Operator::kMinusOp:
-        if (type1 == CurrentValueType::REG && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = sub nsw i32 %%%d, %%%d\n", m_local_var_offset, reg1, reg2);
-        else if (type1 == CurrentValueType::REG && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = sub nsw i32 %%%d, %d\n", m_local_var_offset, int1, int2);
-        else if (type1 == CurrentValueType::INT && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = sub nsw i32 %d, %%%d\n", m_local_var_offset, int1, int2);
-        else if (type1 == CurrentValueType::INT && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = sub nsw i32 %d, %d\n", m_local_var_offset, int1, int2);
-        else
-            assert(false && "Not supported!\n");
+        result = m_builder.createBinary(Opcode::kSub, lhs, rhs);
         break;
     case Operator::kLessOp:
-        emitInstructions(m_output_file.get(), "  %%%d = icmp slt i32 %%%d, %d\n", m_local_var_offset, reg1, int2);
+        result = m_builder.createICmp(Predicate::kSlt, lhs, rhs);
         break;
     case Operator::kLessOrEqualOp:
-        emitInstructions(m_output_file.get(), "  %%%d = icmp sle i32 %%%d, %d\n", m_local_var_offset, reg1, int2);
+        result = m_builder.createICmp(Predicate::kSle, lhs, rhs);
         break;
     case Operator::kGreaterOp:
-        if (type1 == CurrentValueType::REG && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = icmp sgt i32 %%%d, %d\n", m_local_var_offset, reg1, int2);
-        else if (type1 == CurrentValueType::REG && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = icmp sgt i32 %%%d, %%%d\n", m_local_var_offset, reg1, reg2);
+        result = m_builder.createICmp(Predicate::kSgt, lhs, rhs);
         break;
     case Operator::kGreaterOrEqualOp:
+        result = m_builder.createICmp(Predicate::kSge, lhs, rhs);
         break;
     case Operator::kEqualOp:
-        if (type1 == CurrentValueType::REG && type2 == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = icmp eq i32 %%%d, %d\n",
-                                m_local_var_offset, reg1, int2);
+        result = m_builder.createICmp(Predicate::kEq, lhs, rhs);
         break;
     case Operator::kNotEqualOp:
-        break;
-    case Operator::kAndOp:
-        if (type1 == CurrentValueType::REG && type2 == CurrentValueType::REG)
-            emitInstructions(m_output_file.get(), "  %%%d = and  i1 %%%d, %%%d\n", m_local_var_offset, reg1, reg2);
-        else
-            assert(false && "Not supported!\n");
+        result = m_builder.createICmp(Predicate::kNe, lhs, rhs);
         break;
     default:
+        // and/or go through generateShortCircuit()
         assert(false && "unsupported binary operator");
         break;
     }
-    
-    pushRegToStack(m_local_var_offset++);
+
+    pushRegToStack(result);
+}
+
+// The right operand of and/or is only evaluated if the left one does not
+// decide the result already. Used where the value itself is needed; as a
+// condition, generateCondition() branches directly instead.
+void CodeGenerator::generateShortCircuit(BinaryOperatorNode &p_bin_op) {
+    const bool is_and = p_bin_op.getOp() == Operator::kAndOp;
+    auto &lhs_node = const_cast<ExpressionNode &>(p_bin_op.getLeftOperand());
+    auto &rhs_node = const_cast<ExpressionNode &>(p_bin_op.getRightOperand());
+
+    lhs_node.accept(*this);
+    auto lhs_value = popFromStack();
+    if (isLiteral(lhs_value.second)) {
+        // false and x, true or x
+        if (getLiteral(lhs_value) != is_and) {
+            pushBoolToStack(!is_and);
+            return;
+        }
+        // true and x, false or x
+        rhs_node.accept(*this);
+        return;
+    }
+
+    auto *rhs_block = m_builder.createBasicBlock();
+    auto *end_block = m_builder.createBasicBlock();
+    IrInstruction *branch;
+    if (is_and)
+        branch = m_builder.createCondBr(materialize(lhs_value), rhs_block,
+                                        end_block);
+    else
+        branch = m_builder.createCondBr(materialize(lhs_value), end_block,
+                                        rhs_block);
+    // not the insert block if that has been terminated already, as in dead
+    // code after a return
+    auto *lhs_end_block = branch->getParent();
+
+    m_builder.setInsertPoint(rhs_block);
+    rhs_node.accept(*this);
+    auto *rhs = popIrValueFromStack();
+    auto *rhs_end_block = m_builder.createBr(end_block)->getParent();
+
+    m_builder.setInsertPoint(end_block);
+    auto *phi = m_builder.createPhi(end_block, m_module.getIntegerType(1));
+    phi->addIncoming(m_builder.getInt1(!is_and), lhs_end_block);
+    phi->addIncoming(rhs, rhs_end_block);
+    pushRegToStack(phi);
+}
+
+void CodeGenerator::generateCondition(const ExpressionNode &p_condition,
+                                      IrBasicBlock *const p_true_block,
+                                      IrBasicBlock *const p_false_block) {
+    if (const auto *bin_op =
+            dynamic_cast<const BinaryOperatorNode *>(&p_condition)) {
+        const bool is_and = bin_op->getOp() == Operator::kAndOp;
+        if (is_and || bin_op->getOp() == Operator::kOrOp) {
+            auto *rhs_block = m_builder.createBasicBlock();
+            if (is_and)
+                generateCondition(bin_op->getLeftOperand(), rhs_block,
+                                  p_false_block);
+            else
+                generateCondition(bin_op->getLeftOperand(), p_true_block,
+                                  rhs_block);
+
+            // the left operand was a literal that decides the result
+            if (rhs_block->getPredecessors().empty())
+                return;
+
+            m_builder.setInsertPoint(rhs_block);
+            generateCondition(bin_op->getRightOperand(), p_true_block,
+                              p_false_block);
+            return;
+        }
+    }
+
+    if (const auto *un_op =
+            dynamic_cast<const UnaryOperatorNode *>(&p_condition)) {
+        if (un_op->getOp() == Operator::kNotOp) {
+            generateCondition(un_op->getOperand(), p_false_block,
+                              p_true_block);
+            return;
+        }
+    }
+
+    m_ref_to_value = true;
+    const_cast<ExpressionNode &>(p_condition).accept(*this);
+    auto condition = popFromStack();
+    if (isLiteral(condition.second)) {
+        m_builder.createBr(getLiteral(condition) ? p_true_block
+                                                 : p_false_block);
+        return;
+    }
+    m_builder.createCondBr(materialize(condition), p_true_block,
+                           p_false_block);
 }
 
 void CodeGenerator::visit(UnaryOperatorNode &p_un_op) {
     p_un_op.visitChildNodes(*this);
 
-    auto value_type = popFromStack();
-    auto type = value_type.second;
-    auto value = value_type.first;
+    auto operand_value = popFromStack();
+    if (isLiteral(operand_value.second)) {
+        const int32_t literal = getLiteral(operand_value);
+        switch (p_un_op.getOp()) {
+        case Operator::kNegOp:
+            pushIntToStack(static_cast<int32_t>(0u - static_cast<uint32_t>(literal)));
+            return;
+        case Operator::kNotOp:
+            pushBoolToStack(!literal);
+            return;
+        default:
+            break;
+        }
+    }
 
+    auto *operand = materialize(operand_value);
+
+    IrValue *result = nullptr;
     switch (p_un_op.getOp()) {
     case Operator::kNegOp:
-        if (type == CurrentValueType::INT)
-            emitInstructions(m_output_file.get(), "  %%%d = sub nsw i32 0, %d\n", m_local_var_offset, value.d);
-        else
-            assert(false && "Should not reach here!");
+        result = m_builder.createBinary(IrInstruction::OpcodeEnum::kSub,
+                                        m_builder.getInt32(0), operand);
         break;
     case Operator::kNotOp:
-        if (type == CurrentValueType::REG && p_un_op.getInferredType()->isBool())
-            emitInstructions(m_output_file.get(), "  %%%d = xor i1 1, %%%d\n", m_local_var_offset, value.d);
-        else
-            assert(false && "Should not reach here!");
+        result = m_builder.createBinary(IrInstruction::OpcodeEnum::kXor,
+                                        m_builder.getInt1(true), operand);
         break;
     default:
         assert(false && "unsupported unary operator");
         return;
     }
-    
-    pushRegToStack(m_local_var_offset++);
+
+    pushRegToStack(result);
 }
 
 void CodeGenerator::visit(FunctionInvocationNode &p_func_invocation) {
     const auto &arguments = p_func_invocation.getArguments();
     m_ref_to_value = true;
     auto visit_ast_node = [&](auto &ast_node) { ast_node->accept(*this); };
-    dealing_params = true;
     for_each(arguments.begin(), arguments.end(), visit_ast_node);
-    dealing_params = false;
 
-    std::vector<std::pair<StackValue, CurrentValueType>> args(arguments.size());
+    std::vector<IrValue *> args(arguments.size());
     for (size_t i = 0; i < arguments.size(); ++i)
-        args[arguments.size() - 1 - i] = popFromStack();
-    pushRegToStack(m_local_var_offset);
-    
-    std::string return_type;
-    if (p_func_invocation.getInferredType()->isInteger())
-        return_type = "i32";
-    else if (p_func_invocation.getInferredType()->isBool())
-        return_type = "i1";
-    else
-        assert(false && "Not supported!");
-    std::stringstream func;
-    func << "%" << m_local_var_offset++ << " = call "<< return_type <<" @" 
-        << p_func_invocation.getNameCString() << "(";
-    for (size_t i = 0; i < arguments.size(); ++i) {
-        auto value = args[i].first;
-        auto type = args[i].second;
-        if (type == CurrentValueType::INT) 
-            func << "i32 " << value.d;
-        else if (type == CurrentValueType::BOOL)
-            func << "i1 " << value.b;
-        else if (type == CurrentValueType::REG) {
-            VariableReferenceNode* var_ptr = dynamic_cast<VariableReferenceNode*>(&*arguments[i]);
-            bool is_array = false;
-            std::map<const SymbolEntry *, size_t>::iterator search;
-            if (var_ptr) {
-                const auto *entry_ptr =
-                m_symbol_manager_ptr->lookup(var_ptr->getName());
-                search = m_local_var_offset_map.find(entry_ptr);
-                if (search != m_local_var_offset_map.end()
-                    && search->first->getTypePtr()->getDimensions().size())
-                    is_array = true;
-            }
-            
-            if (!is_array) {
-                if (arguments[i]->getInferredType()->isInteger())
-                    func << "i32 %" << value.reg;
-                else if (arguments[i]->getInferredType()->isBool())
-                    func << "i1 %" << value.reg;
-                else
-                    assert(false && "Not supported!");
-            }
-            else {
-                auto dim = search->first->getTypePtr()->getDimensions();
-                if (dim.size() == 1) {
-                    func << "i32* %" << value.reg;
-                }
-                else if (dim.size() == 2) {
-                    func << "[" << dim[1] << " x i32]* %" << value.reg;
-                }
-                else
-                    assert(false && "Not supported!");
-            }
-        }
-        else
-            assert(false && "Should not reach here!");
+        args[arguments.size() - 1 - i] = popIrValueFromStack();
 
-        if (i != arguments.size() - 1)
-            func << ", ";
-    } 
-    func << ")";
-    emitInstructions(m_output_file.get(), "  %s\n", func.str().c_str());
+    auto *callee = p_func_invocation.getSymbolEntry()->getCodegenSlot();
+    assert(callee && "Should have been defined before use");
+
+    pushRegToStack(
+        m_builder.createCall(static_cast<IrFunction *>(callee), args));
 }
 
 void CodeGenerator::visit(VariableReferenceNode &p_variable_ref) {
-    // Haven't supported array reference
-
+    // indices are always rvalues, even if the reference itself is an lvalue
+    const bool ref_to_value = m_ref_to_value;
+    m_ref_to_value = true;
     p_variable_ref.visitChildNodes(*this);
-    const auto *entry_ptr =
-            m_symbol_manager_ptr->lookup(p_variable_ref.getName());
-        auto search = m_local_var_offset_map.find(entry_ptr);
-    // assume we never access pointers through array references
-    bool is_array = false;
-    if (search != m_local_var_offset_map.end()
-        && search->first->getTypePtr()->getDimensions().size())
-        is_array = true;
-    if (!is_array) { // primitive
-        // dereference to get the value if needed
-        std::string type = "i32";
-        if (search != m_local_var_offset_map.end()
-            && search->first->getTypePtr()->isBool())
-            type = "i1";
-        if (m_ref_to_value) {
-            emitInstructions(m_output_file.get(), "  %%%ld = load %s, %s* ",
-                            m_local_var_offset, type.c_str(), type.c_str());
-
-            pushRegToStack(m_local_var_offset++);
-
-            if (search == m_local_var_offset_map.end()) { // global variable reference
-                emitInstructions(m_output_file.get(), "@%s, align 4\n",
-                                p_variable_ref.getNameCString());
-            } else { // local variable reference
-                emitInstructions(m_output_file.get(), "%%%ld, align 4\n",
-                                search->second);
-            }
-        }
-        else {  // get the reg
-            if (search == m_local_var_offset_map.end()) // global variable reference
-                pushGlobalVarToStack(p_variable_ref.getNameCString());
-            else // local variable reference
-                pushRegToStack(search->second);
-        }
+    m_ref_to_value = ref_to_value;
+
+    const auto *entry_ptr = p_variable_ref.getSymbolEntry();
+    if (m_ssa.isTracked(entry_ptr)) {
+        // assignments and reads define SSA variables themselves
+        assert(m_ref_to_value && "SSA variables have no address");
+        pushIrValueToStack(
+            m_ssa.readVariable(entry_ptr, m_builder.getInsertBlock()));
+        return;
     }
-    else { // array
-        auto dim_sz = p_variable_ref.getIndices().size();
-        auto dim = search->first->getTypePtr()->getDimensions();
-        if (!call_stack.size()) { // in main
-            if (dealing_params) {
-                if (dim.size() == 1) {
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x i32], [%d x i32]* %%%d, i64 0, i64 0\n",
-                                m_local_var_offset, dim[0], dim[0], search->second);
-                }
-                else if (dim.size() == 2) {
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x [%d x i32]], [%d x [%d x i32]]* %%%d, i64 0, i64 0\n",
-                                m_local_var_offset, dim[0], dim[1], dim[0], dim[1], search->second);
-                }
-                else
-                    assert(false && "Not supported!");
-
-                pushRegToStack(m_local_var_offset++);
-            }
-            else if (m_ref_to_value) { // dereference to get the value if needed
-                auto value_type1 = popFromStack();
-                assert(value_type1.second == CurrentValueType::INT && "Must be an integer!");
-                auto index1 = value_type1.first.d;
-                if (dim_sz == 1) {
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x i32], [%d x i32]* %%%d, i64 0, i64 %d\n",
-                                m_local_var_offset++, dim[0], dim[0], search->second, index1);
-                    emitInstructions(m_output_file.get(), "  %%%d = load i32, i32* %%%d, align 4\n",
-                                m_local_var_offset, m_local_var_offset - 1);
-                }
-                else if (dim_sz == 2) {
-                    auto value_type2 = popFromStack();
-                    assert(value_type2.second == CurrentValueType::INT && "Must be an integer!");
-                    auto index2 = value_type2.first.d;
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x [%d x i32]], [%d x [%d x i32]]* %%%d, i64 0, i64 %d\n",
-                                m_local_var_offset++, dim[0], dim[1], dim[0], dim[1], search->second, index2);
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x i32], [%d x i32]* %%%d, i64 0, i64 %d\n",
-                                m_local_var_offset, dim[1], dim[1], m_local_var_offset - 1, index1);
-                    m_local_var_offset += 1;
-                    emitInstructions(m_output_file.get(), "  %%%d = load i32, i32* %%%d, align 4\n",
-                                m_local_var_offset, m_local_var_offset - 1);
-                }
-                else
-                    assert(false && "Not supported!");
-
-                pushRegToStack(m_local_var_offset++);
-            }
-            else {  // get the reg
-                auto value_type1 = popFromStack();
-                assert(value_type1.second == CurrentValueType::INT && "Must be an integer!");
-                auto index1 = value_type1.first.d;
-                if (dim_sz == 1) {
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x i32], [%d x i32]* %%%d, i64 0, i64 %d\n",
-                                m_local_var_offset, dim[0], dim[0], search->second, index1);
-                }
-                else if (dim_sz == 2) {
-                    auto value_type2 = popFromStack();
-                    assert(value_type2.second == CurrentValueType::INT && "Must be an integer!");
-                    auto index2 = value_type2.first.d;
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x [%d x i32]], [%d x [%d x i32]]* %%%d, i64 0, i64 %d\n",
-                                m_local_var_offset++, dim[0], dim[1], dim[0], dim[1], search->second, index2);
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x i32], [%d x i32]* %%%d, i64 0, i64 %d\n",
-                                m_local_var_offset, dim[1], dim[1], m_local_var_offset - 1, index1);
-                }
-                else
-                    assert(false && "Not supported!");
-
-                pushRegToStack(m_local_var_offset++);
-            }
+
+    IrValue *address = entry_ptr->getCodegenSlot();
+    assert(address && "Should have been defined before use");
+
+    if (!entry_ptr->getTypePtr()->getDimensions().empty()) { // array
+        std::vector<IrValue *> indices(p_variable_ref.getIndices().size());
+        for (size_t i = 0; i < indices.size(); ++i) {
+            auto value_type = popFromStack();
+            indices[indices.size() - 1 - i] =
+                (value_type.second == CurrentValueType::INT)
+                    ? m_builder.getInt64(value_type.first.d)
+                    : value_type.first.reg;
         }
-        else { // not in main
-            if (m_ref_to_value) {
-                auto value_type1 = popFromStack();
-                assert(value_type1.second == CurrentValueType::INT && "Must be an integer!");
-                auto index1 = value_type1.first.d;
-                if (dim_sz == 1) {
-                    emitInstructions(m_output_file.get(), "  %%%d = load i32*, i32** %%%d, align 8\n",
-                                m_local_var_offset++, search->second);
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds i32, i32* %%%d, i64 %d\n",
-                                m_local_var_offset, m_local_var_offset - 1, index1);
-                    m_local_var_offset += 1;
-                    emitInstructions(m_output_file.get(), "  %%%d = load i32, i32* %%%d, align 4\n",
-                                m_local_var_offset, m_local_var_offset - 1);
-                }
-                else if (dim_sz == 2) {
-                    auto value_type2 = popFromStack();
-                    assert(value_type2.second == CurrentValueType::INT && "Must be an integer!");
-                    auto index2 = value_type2.first.d;
-                    emitInstructions(m_output_file.get(), "  %%%d = load [%d x i32]*, [%d x i32]** %%%d, align 8\n",
-                                m_local_var_offset++, dim[1], dim[1], search->second);
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x i32], [%d x i32]* %%%d, i64 %d\n",
-                                m_local_var_offset, dim[1], dim[1], m_local_var_offset - 1, index2);
-                    m_local_var_offset += 1;
-                    emitInstructions(m_output_file.get(), "  %%%d = getelementptr inbounds [%d x i32], [%d x i32]* %%%d, i64 0, i64 %d\n",
-                                m_local_var_offset, dim[1], dim[1], m_local_var_offset - 1, index1);
-                    m_local_var_offset += 1;
-                    emitInstructions(m_output_file.get(), "  %%%d = load i32, i32* %%%d, align 4\n",
-                                m_local_var_offset, m_local_var_offset - 1);
-                }
-                else
-                    assert(false && "Not supported!");
-
-                pushRegToStack(m_local_var_offset++);
-            }
-            else {  // get the reg
-                assert(false && "Not supported!");
-            }
+
+        auto *zero = m_builder.getInt64(0);
+        size_t nth = 0;
+        if (entry_ptr->getKind() == SymbolEntry::KindEnum::kParameterKind) {
+            // the alloca holds a pointer to the first element
+            address = m_builder.createLoad(address);
+            if (!indices.empty())
+                address = m_builder.createGetElementPtr(address, {indices[nth++]});
+        } else if (indices.empty()) {
+            // passed as an argument, decay to a pointer to the first element
+            address = m_builder.createGetElementPtr(address, {zero, zero});
+        }
+        for (; nth < indices.size(); ++nth)
+            address = m_builder.createGetElementPtr(address, {zero, indices[nth]});
+
+        if (indices.empty()) {
+            pushRegToStack(address);
+            return;
         }
     }
+
+    // dereference to get the value if needed
+    if (m_ref_to_value)
+        pushRegToStack(m_builder.createLoad(address));
+    else
+        pushRegToStack(address);
 }
 
 void CodeGenerator::visit(AssignmentNode &p_assignment) {
+    const auto *entry_ptr = p_assignment.getLvalue().getSymbolEntry();
+    if (m_ssa.isTracked(entry_ptr)) {
+        m_ref_to_value = true;
+        const_cast<ExpressionNode &>(p_assignment.getExpr()).accept(*this);
+        m_ssa.writeVariable(entry_ptr, m_builder.getInsertBlock(),
+                            popIrValueFromStack());
+        return;
+    }
+
     m_ref_to_value = false; // as lval
     const_cast<VariableReferenceNode &>(p_assignment.getLvalue()).accept(*this);
     m_ref_to_value = true; // as rval
     const_cast<ExpressionNode &>(p_assignment.getExpr()).accept(*this);
 
-    auto value_type = popFromStack();
-    CurrentValueType type = value_type.second;
-
-    std::stringstream target, name;
-    const auto *entry_ptr = m_symbol_manager_ptr->lookup(p_assignment.getLvalue().getName());
-    if (!entry_ptr->getLevel()) { // global variable
-        name << "@" << p_assignment.getLvalue().getName();
-        target << "@" << p_assignment.getLvalue().getName();
-    }
-    else { // local variable
-        auto search = m_local_var_offset_map.find(entry_ptr);
-        assert(search != m_local_var_offset_map.end() &&
-                        "Should find unnamed value for the variable reference!");
-        auto dim = search->first->getTypePtr()->getDimensions();
-        if (!dim.size()) { // primitive type
-            name << "%" << search->second;
-            target << "%" << p_assignment.getLvalue().getName();
-        }
-        else { // array type
-            auto value_type = popFromStack();
-            assert(value_type.second == CurrentValueType::REG);
-            name << "%" << value_type.first.reg;
-            target << "%" << p_assignment.getLvalue().getName();
-        }
-    }
+    auto *value = popIrValueFromStack();
+    auto *address = popIrValueFromStack();
+    m_builder.createStore(value, address,
+                          "store to %" + p_assignment.getLvalue().getName());
+}
 
-    
-    if (p_assignment.getLvalue().getInferredType()->isInteger()) {
-        if (type == CurrentValueType::INT) {
-            int val = value_type.first.d;
-            emitInstructions(m_output_file.get(),
-                            "  store i32 %d, i32* %s, align 4"
-                            " ; store to %s\n",
-                            val, name.str().c_str(), target.str().c_str());
-        }
-        else if (type == CurrentValueType::REG) {
-            int reg = value_type.first.reg;
-            emitInstructions(m_output_file.get(),
-                            "  store i32 %%%d, i32* %s, align 4"
-                            " ; store to %s\n",
-                            reg, name.str().c_str(), target.str().c_str());
-        }
-        else
-            assert(false && "Should not reach here!");
-    }
-    else if (p_assignment.getLvalue().getInferredType()->isBool()) {
-        if (type == CurrentValueType::BOOL) {
-            int val = value_type.first.d;
-            emitInstructions(m_output_file.get(),
-                            "  store i1 %d, i1* %s, align 4"
-                            " ; store to %s\n",
-                            val, name.str().c_str(), target.str().c_str());
-        }
-        else if (type == CurrentValueType::REG) {
-            int reg = value_type.first.reg;
-            emitInstructions(m_output_file.get(),
-                            "  store i1 %%%d, i1* %s, align 4"
-                            " ; store to %s\n",
-                            reg, name.str().c_str(), target.str().c_str());
+void CodeGenerator::visit(ReadNode &p_read) {
+    const auto *entry_ptr = p_read.getTarget().getSymbolEntry();
+    if (m_ssa.isTracked(entry_ptr)) {
+        // scanf needs somewhere to write to: a slot of the variable's own
+        // type, shared by all the reads of it (in a loop as well)
+        auto *address = entry_ptr->getCodegenSlot();
+        if (!address) {
+            address = m_builder.createEntryAlloca(
+                m_ssa.getVariableType(entry_ptr),
+                "read into %" + p_read.getTarget().getName());
+            entry_ptr->setCodegenSlot(address);
         }
-        else
-            assert(false && "Should not reach here!");
+        m_builder.createCall(m_scanf, {m_format_string, address});
+        m_ssa.writeVariable(entry_ptr, m_builder.getInsertBlock(),
+                            m_builder.createLoad(address));
+        return;
     }
-    else
-        assert(false && "Should not reach here!");
-}
 
-void CodeGenerator::visit(ReadNode &p_read) {
-    m_ref_to_value = false; 
+    m_ref_to_value = false;
     p_read.visitChildNodes(*this);
-    auto value_type = popFromStack();
-    if (value_type.second == CurrentValueType::GLOBAL) {
-        auto var = value_type.first.global_var;
-        emitInstructions(m_output_file.get(), 
-                        "  %%%d = call i32 (i8*, ...) @__isoc99_scanf(i8* getelementptr inbounds "
-                        "([4 x i8], [4 x i8]* @.str, i64 0, i64 0), i32* @%s)\n",
-                        m_local_var_offset++, var);
-    }
-    else if (value_type.second == CurrentValueType::REG) {
-        emitInstructions(m_output_file.get(), 
-                        "  %%%d = call i32 (i8*, ...) @__isoc99_scanf(i8* getelementptr inbounds "
-                        "([4 x i8], [4 x i8]* @.str, i64 0, i64 0), i32* %%%d)\n",
-                        m_local_var_offset++, value_type.first.reg);
-    }
-    else
-        assert(false && "Note supported!");
+
+    auto *address = popIrValueFromStack();
+    m_builder.createCall(m_scanf, {m_format_string, address});
 }
 
 void CodeGenerator::visit(IfNode &p_if) {
-    // TODO: cannot handle nested compound statements
     const auto *else_body_ptr = p_if.getElseBodyPtr();
-    m_ref_to_value = true;
-    const_cast<ExpressionNode &>(p_if.getCondition()).accept(*this);
-
-    auto value_type = popFromStack();
-    auto value = value_type.first.reg;
-    assert(value_type.second == CurrentValueType::REG && "Must be reg type!");
-
-    emitInstructions(m_output_file.get(), "  ; if-else \n");
-    fpos_t pos;
-    emitInstructions(m_output_file.get(), "  br i1 %%%d, label %%%d, label %%", value, m_local_var_offset);
-    fgetpos(m_output_file.get(), &pos);
-    emitInstructions(m_output_file.get(), "               \n"); // a hack to deal with large label values
-
-    has_ret = false;
-    emitInstructions(m_output_file.get(), "%d:  ; if\n", m_local_var_offset++);
-    const_cast<CompoundStatementNode &>(p_if.getIfBody()).accept(*this);
-    if (!has_ret)
-        emitInstructions(m_output_file.get(), "  br label %%");
-    fpos_t cur_pos;
-    fgetpos(m_output_file.get(), &cur_pos);
-    fsetpos(m_output_file.get(), &pos);
-    emitInstructions(m_output_file.get(), "%d", m_local_var_offset);
-    fsetpos(m_output_file.get(), &cur_pos);
-    pos = cur_pos;
-    emitInstructions(m_output_file.get(), "               \n"); // a hack to deal with large label values
-    has_ret = false;
-
-    if (else_body_ptr) {
-        emitInstructions(m_output_file.get(), "%d:  ; else\n", m_local_var_offset++);
-        const_cast<CompoundStatementNode *>(else_body_ptr)->accept(*this);
-        if (!has_ret)
-            emitInstructions(m_output_file.get(), "  br label %%%d\n", m_local_var_offset);
-        fgetpos(m_output_file.get(), &cur_pos);
-        fsetpos(m_output_file.get(), &pos);
-        if (!has_ret)
-            emitInstructions(m_output_file.get(), "%d", m_local_var_offset);
-        fsetpos(m_output_file.get(), &cur_pos);
-        if (!has_ret)
-            emitInstructions(m_output_file.get(), "%d:\n", m_local_var_offset++);
-        has_ret = false;
-    }
+
+    auto *if_block = m_builder.createBasicBlock("if");
+    auto *else_block = else_body_ptr ? m_builder.createBasicBlock("else") : nullptr;
+    auto *end_block = m_builder.createBasicBlock();
+    generateCondition(p_if.getCondition(), if_block,
+                      else_block ? else_block : end_block);
+
+    // a clause nobody branches to (constant condition) is not generated
+    auto generate_clause = [&](IrBasicBlock *p_block,
+                               const CompoundStatementNode &p_body) {
+        if (p_block->getPredecessors().empty())
+            return;
+        m_builder.setInsertPoint(p_block);
+        const_cast<CompoundStatementNode &>(p_body).accept(*this);
+        if (!m_builder.isTerminated())
+            m_builder.createBr(end_block);
+    };
+    generate_clause(if_block, p_if.getIfBody());
+    if (else_block)
+        generate_clause(else_block, *else_body_ptr);
+
+    // In llvm ir, we can't put br after ret, and the block after the
+    // if-else is only needed when one of the clauses falls through.
+    if (!end_block->getPredecessors().empty())
+        m_builder.setInsertPoint(end_block);
 }
 
 void CodeGenerator::visit(WhileNode &p_while) {
-    // TODO: cannot handle nested compound statements
-    int head_label = m_local_var_offset;
-    emitInstructions(m_output_file.get(), "  br label %%%d\n", head_label);
-    m_ref_to_value = true;
-    emitInstructions(m_output_file.get(), "%d:  ; while head\n", m_local_var_offset++);
-    const_cast<ExpressionNode &>(p_while.getCondition()).accept(*this);
-
-    auto value_type = popFromStack();
-    auto value = value_type.first.reg;
-    assert(value_type.second == CurrentValueType::REG && "Must be reg type!");
-    
-    fpos_t pos;
-    emitInstructions(m_output_file.get(), "  br i1 %%%d, label %%%d, label %%", value, m_local_var_offset);
-    fgetpos(m_output_file.get(), &pos);
-    emitInstructions(m_output_file.get(), "               \n"); // a hack to deal with large label values
-
-    emitInstructions(m_output_file.get(), "%d:  ; while body\n", m_local_var_offset++);
+    auto *head_block = m_builder.createBasicBlock("while head");
+    auto *body_block = m_builder.createBasicBlock("while body");
+    auto *end_block = m_builder.createBasicBlock();
+    // the back edge is not known until the body has been generated
+    m_ssa.addUnsealedBlock(head_block);
+
+    m_builder.createBr(head_block);
+    m_builder.setInsertPoint(head_block);
+    generateCondition(p_while.getCondition(), body_block, end_block);
+
+    m_builder.setInsertPoint(body_block);
     const_cast<CompoundStatementNode &>(p_while.getBody()).accept(*this);
-    emitInstructions(m_output_file.get(), "  br label %%%d\n", head_label);
+    if (!m_builder.isTerminated())
+        m_builder.createBr(head_block);
+    m_ssa.sealBlock(head_block);
 
-    emitInstructions(m_output_file.get(), "%d:\n", m_local_var_offset);
-    fpos_t cur_pos;
-    fgetpos(m_output_file.get(), &cur_pos);
-    fsetpos(m_output_file.get(), &pos);
-    emitInstructions(m_output_file.get(), "%d", m_local_var_offset++);
-    fsetpos(m_output_file.get(), &cur_pos);
+    m_builder.setInsertPoint(end_block);
 }
 
 void CodeGenerator::visit(ForNode &p_for) {
-    m_symbol_manager_ptr->reconstructHashTableFromSymbolTable(
-        p_for.getSymbolTable());
     m_context_stack.push(CodegenContext::kLocal);
 
-    emitInstructions(m_output_file.get(), "  ; for init\n");
     const_cast<DeclNode &>(p_for.getLoopVarDecl()).accept(*this);
     const_cast<AssignmentNode &>(p_for.getLoopVarInitStmt()).accept(*this);
     // hand-written comparison
-    const auto *entry_ptr =
-        m_symbol_manager_ptr->lookup(p_for.getLoopVarName());
-    auto search = m_local_var_offset_map.find(entry_ptr);
-    assert(search != m_local_var_offset_map.end() && "Should have been defined before use");
-
-    int head_label = m_local_var_offset;
-    emitInstructions(m_output_file.get(), "  br label %%%d\n", head_label);
-    emitInstructions(m_output_file.get(), "%d:  ; for head\n", m_local_var_offset++);
-    int loop_var = search->second;
-    emitInstructions(m_output_file.get(), "  %%%d = load i32, i32* %%%d, align 4\n",
-                        m_local_var_offset++, loop_var);
-    emitInstructions(m_output_file.get(), "  %%%d = icmp slt i32 %%%d, %d\n",
-                        m_local_var_offset, m_local_var_offset - 1, p_for.getUpperBound().getConstantPtr()->integer());
-    m_local_var_offset += 1;
-    emitInstructions(m_output_file.get(), "  br i1 %%%d, label %%%d, label %%", 
-                        m_local_var_offset - 1, m_local_var_offset);
-    fpos_t pos;
-    fgetpos(m_output_file.get(), &pos);
-    emitInstructions(m_output_file.get(), "               \n"); // a hack to deal with large label values
-
-    emitInstructions(m_output_file.get(), "%d:  ; for body\n", m_local_var_offset++);
+    const auto *entry_ptr = p_for.getLoopVarSymbolEntry();
+    auto load_loop_var = [&]() -> IrValue * {
+        if (m_ssa.isTracked(entry_ptr))
+            return m_ssa.readVariable(entry_ptr, m_builder.getInsertBlock());
+        assert(entry_ptr->getCodegenSlot() &&
+               "Should have been defined before use");
+        return m_builder.createLoad(entry_ptr->getCodegenSlot());
+    };
+
+    auto *head_block = m_builder.createBasicBlock("for head");
+    auto *body_block = m_builder.createBasicBlock("for body");
+    auto *end_block = m_builder.createBasicBlock();
+    m_ssa.addUnsealedBlock(head_block);
+
+    m_builder.createBr(head_block);
+    m_builder.setInsertPoint(head_block);
+    auto *condition = m_builder.createICmp(
+        IrInstruction::PredicateEnum::kSlt, load_loop_var(),
+        m_builder.getInt32(p_for.getUpperBound().getConstantPtr()->integer()));
+    m_builder.createCondBr(condition, body_block, end_block);
+
+    m_builder.setInsertPoint(body_block);
     const_cast<CompoundStatementNode &>(p_for.getBody()).accept(*this);
-    emitInstructions(m_output_file.get(), "  %%%d = load i32, i32* %%%d, align 4\n",
-                        m_local_var_offset++, loop_var);
-    emitInstructions(m_output_file.get(), "  %%%d = add nsw i32 %%%d, 1\n", m_local_var_offset, m_local_var_offset - 1);
-    m_local_var_offset += 1;
-    emitInstructions(m_output_file.get(), "  store i32 %%%d, i32* %%%d, align 4\n", m_local_var_offset - 1, loop_var);
-    emitInstructions(m_output_file.get(), "  br label %%%d\n", head_label);
-
-    fpos_t cur_pos;
-    fgetpos(m_output_file.get(), &cur_pos);
-    fsetpos(m_output_file.get(), &pos);
-    emitInstructions(m_output_file.get(), "%d", m_local_var_offset);
-    fsetpos(m_output_file.get(), &cur_pos);
-    emitInstructions(m_output_file.get(), "%d:\n", m_local_var_offset++);
+    if (!m_builder.isTerminated()) {
+        auto *next = m_builder.createBinary(IrInstruction::OpcodeEnum::kAdd,
+                                            load_loop_var(),
+                                            m_builder.getInt32(1));
+        if (m_ssa.isTracked(entry_ptr))
+            m_ssa.writeVariable(entry_ptr, m_builder.getInsertBlock(), next);
+        else
+            m_builder.createStore(next, entry_ptr->getCodegenSlot());
+        m_builder.createBr(head_block);
+    }
+    m_ssa.sealBlock(head_block);
+
+    m_builder.setInsertPoint(end_block);
 
     m_context_stack.pop();
-    m_symbol_manager_ptr->removeSymbolsFromHashTable(p_for.getSymbolTable());
 }
 
 void CodeGenerator::visit(ReturnNode &p_return) {
-    has_ret = true;
     m_ref_to_value = true;
     p_return.visitChildNodes(*this);
 
-    std::stringstream function_end;
-    function_end << "  ret ";
-
-    auto value_type = popFromStack();
-    CurrentValueType type = value_type.second;
-    if (p_return.getReturnValue().getInferredType()->isInteger()) {
-        if (type == CurrentValueType::REG) 
-            function_end << "i32 %" << value_type.first.reg;
-        else if (type == CurrentValueType::INT) 
-            function_end << "i32 " << value_type.first.d;
-        else
-            assert(false && "Should not reach here!");
-    }
-    else if (p_return.getReturnValue().getInferredType()->isBool()) {
-        if (type == CurrentValueType::REG) 
-            function_end << "i1 %" << value_type.first.reg;
-        else if (type == CurrentValueType::BOOL) 
-            function_end << "i1 " << value_type.first.b;
-        else
-            assert(false && "Should not reach here!");
-    }
-    else
-        assert(false && "Should not reach here!");
-    
-    emitInstructions(m_output_file.get(), "%s\n", function_end.str().c_str());
+    m_builder.createRet(popIrValueFromStack());
 }
 
 
@@ -941,7 +745,7 @@ void CodeGenerator::pushBoolToStack(int b) {
     m_type_stack.push(CurrentValueType::BOOL);
 }
 
-void CodeGenerator::pushRegToStack(int reg) {
+void CodeGenerator::pushRegToStack(IrValue *reg) {
     StackValue value;
     value.reg = reg;
     m_value_stack.push(value);
@@ -962,13 +766,6 @@ void CodeGenerator::pushStrToStack(const char *str) {
     m_type_stack.push(CurrentValueType::STR);
 }
 
-void CodeGenerator::pushGlobalVarToStack(const char *global_var) {
-    StackValue value;
-    value.str = global_var;
-    m_value_stack.push(value);
-    m_type_stack.push(CurrentValueType::GLOBAL);
-}
-
 std::pair<CodeGenerator::StackValue, CodeGenerator::CurrentValueType>
 CodeGenerator::popFromStack() {
     assert(m_value_stack.size() && m_type_stack.size() &&
@@ -991,9 +788,6 @@ CodeGenerator::popFromStack() {
     else if (type == CurrentValueType::STR) {
         value.str = m_value_stack.top().str;
     }
-    else if (type == CurrentValueType::GLOBAL) {
-        value.global_var = m_value_stack.top().global_var;
-    }
     else
         assert (false && "Shouldn't reach here!");
 
@@ -1001,4 +795,44 @@ CodeGenerator::popFromStack() {
     m_value_stack.pop();
 
     return {value, type};
-}
\ No newline at end of file
+}
+
+void CodeGenerator::pushIrValueToStack(IrValue *value) {
+    if (value->getKind() != IrValue::KindEnum::kConstantInt) {
+        pushRegToStack(value);
+        return;
+    }
+
+    const auto *constant = static_cast<IrConstantInt *>(value);
+    if (constant->getType()->getBits() == 1)
+        pushBoolToStack(constant->getValue());
+    else
+        pushIntToStack(constant->getValue());
+}
+
+int32_t CodeGenerator::getLiteral(
+    const std::pair<StackValue, CurrentValueType> &value_type) {
+    if (value_type.second == CurrentValueType::BOOL)
+        return value_type.first.b;
+    assert(value_type.second == CurrentValueType::INT && "not a literal");
+    return value_type.first.d;
+}
+
+IrValue *CodeGenerator::popIrValueFromStack() {
+    return materialize(popFromStack());
+}
+
+IrValue *CodeGenerator::materialize(
+    const std::pair<StackValue, CurrentValueType> &value_type) {
+    switch (value_type.second) {
+    case CurrentValueType::INT:
+        return m_builder.getInt32(value_type.first.d);
+    case CurrentValueType::BOOL:
+        return m_builder.getInt1(value_type.first.b);
+    case CurrentValueType::REG:
+        return value_type.first.reg;
+    default:
+        assert(false && "Not supported!");
+        return nullptr;
+    }
+}
@@ -0,0 +1,721 @@
+#include "codegen/Ir.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+// ===========================================
+// > IrType
+// ===========================================
+IrType::IrType(const TypeEnum type, const uint32_t bits,
+               const IrType *const p_element_type, const uint64_t num_elements)
+    : m_type(type), m_bits(bits), m_element_type(p_element_type),
+      m_num_elements(num_elements) {
+    switch (m_type) {
+    case TypeEnum::kVoidType:
+        m_name = "void";
+        break;
+    case TypeEnum::kIntegerType:
+        m_name = "i" + std::to_string(m_bits);
+        break;
+    case TypeEnum::kPointerType:
+        m_name = m_element_type->getName() + "*";
+        break;
+    case TypeEnum::kArrayType:
+        m_name = "[" + std::to_string(m_num_elements) + " x " +
+                 m_element_type->getName() + "]";
+        break;
+    case TypeEnum::kLabelType:
+        m_name = "label";
+        break;
+    }
+}
+
+uint32_t IrType::getAlignment() const {
+    switch (m_type) {
+    case TypeEnum::kPointerType:
+        return 8;
+    case TypeEnum::kArrayType:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+// ===========================================
+// > IrValue
+// ===========================================
+void IrValue::printAsOperand(OutputBuffer &p_out) const {
+    assert(m_slot >= 0 && "value has not been numbered");
+    p_out.append("%").appendUInt(m_slot);
+}
+
+void IrConstantInt::printAsOperand(OutputBuffer &p_out) const {
+    if (getType()->getBits() == 1) {
+        p_out.append(m_value ? "true" : "false");
+        return;
+    }
+    p_out.appendInt(m_value);
+}
+
+static void printTypedOperand(OutputBuffer &p_out, const IrValue *const p_value) {
+    p_out.append(p_value->getType()->getName()).append(" ");
+    p_value->printAsOperand(p_out);
+}
+
+void IrGlobalVariable::print(OutputBuffer &p_out) const {
+    p_out.append("@").append(m_name).append(" = ").append(m_definition);
+    p_out.append("\n");
+}
+
+// ===========================================
+// > IrInstruction
+// ===========================================
+const char *IrInstruction::getOpcodeCString() const {
+    static const char *kOpcodeStrings[] = {
+        "alloca", "load", "store", "getelementptr", "add",
+        "sub",    "mul",  "sdiv",  "srem",          "and",
+        "or",     "xor",  "icmp",  "phi",           "call",
+        "br",     "br",   "ret",   "unreachable"};
+    return kOpcodeStrings[static_cast<size_t>(m_opcode)];
+}
+
+IrInstruction *IrInstruction::clone() const {
+    auto *inst = new IrInstruction(m_opcode, getType(), m_operands);
+    inst->m_predicate = m_predicate;
+    inst->m_tail_call = m_tail_call;
+    inst->m_aux_type = m_aux_type;
+    inst->m_comment = m_comment;
+    return inst;
+}
+
+static const char *kPredicateStrings[] = {"eq",  "ne",  "slt",
+                                          "sle", "sgt", "sge"};
+
+void IrInstruction::addIncoming(IrValue *const p_value,
+                                IrBasicBlock *const p_block) {
+    assert(isPhi() && "only phi nodes have incoming values");
+    m_operands.emplace_back(p_value);
+    m_operands.emplace_back(p_block);
+}
+
+void IrInstruction::removeIncoming(IrBasicBlock *const p_block) {
+    assert(isPhi() && "only phi nodes have incoming values");
+    for (size_t i = 0; i < m_operands.size(); i += 2) {
+        if (m_operands[i + 1] == p_block) {
+            m_operands.erase(m_operands.begin() + i,
+                             m_operands.begin() + i + 2);
+            return;
+        }
+    }
+    assert(false && "no incoming value from the block");
+}
+
+IrValue *
+IrInstruction::getIncomingValue(const IrBasicBlock *const p_block) const {
+    assert(isPhi() && "only phi nodes have incoming values");
+    for (size_t i = 0; i < m_operands.size(); i += 2) {
+        if (m_operands[i + 1] == p_block) {
+            return m_operands[i];
+        }
+    }
+    return nullptr;
+}
+
+void IrInstruction::setIncomingValue(const IrBasicBlock *const p_block,
+                                     IrValue *const p_value) {
+    assert(isPhi() && "only phi nodes have incoming values");
+    for (size_t i = 0; i < m_operands.size(); i += 2) {
+        if (m_operands[i + 1] == p_block) {
+            m_operands[i] = p_value;
+        }
+    }
+}
+
+bool IrInstruction::isCommutative() const {
+    switch (m_opcode) {
+    case OpcodeEnum::kAdd:
+    case OpcodeEnum::kMul:
+    case OpcodeEnum::kAnd:
+    case OpcodeEnum::kOr:
+    case OpcodeEnum::kXor:
+        return true;
+    case OpcodeEnum::kICmp:
+        return m_predicate == PredicateEnum::kEq ||
+               m_predicate == PredicateEnum::kNe;
+    default:
+        return false;
+    }
+}
+
+void IrInstruction::print(OutputBuffer &p_out) const {
+    p_out.append("  ");
+    if (hasResult()) {
+        printAsOperand(p_out);
+        p_out.append(" = ");
+    }
+
+    switch (m_opcode) {
+    case OpcodeEnum::kAlloca:
+        p_out.append("alloca ").append(m_aux_type->getName());
+        p_out.append(", align ")
+            .appendUInt(m_aux_type->getAlignment());
+        break;
+    case OpcodeEnum::kLoad:
+        p_out.append("load ").append(getType()->getName()).append(", ");
+        printTypedOperand(p_out, m_operands[0]);
+        p_out.append(", align ")
+            .appendUInt(getType()->getAlignment());
+        break;
+    case OpcodeEnum::kStore:
+        p_out.append("store ");
+        printTypedOperand(p_out, m_operands[0]);
+        p_out.append(", ");
+        printTypedOperand(p_out, m_operands[1]);
+        p_out.append(", align ")
+            .appendUInt(m_operands[0]->getType()->getAlignment());
+        break;
+    case OpcodeEnum::kGetElementPtr:
+        p_out.append("getelementptr inbounds ")
+            .append(m_aux_type->getName())
+            .append(", ");
+        for (size_t i = 0; i < m_operands.size(); ++i) {
+            if (i) {
+                p_out.append(", ");
+            }
+            printTypedOperand(p_out, m_operands[i]);
+        }
+        break;
+    case OpcodeEnum::kAdd:
+    case OpcodeEnum::kSub:
+    case OpcodeEnum::kMul:
+    case OpcodeEnum::kSDiv:
+    case OpcodeEnum::kSRem:
+    case OpcodeEnum::kAnd:
+    case OpcodeEnum::kOr:
+    case OpcodeEnum::kXor:
+        p_out.append(getOpcodeCString());
+        if (m_opcode == OpcodeEnum::kAdd || m_opcode == OpcodeEnum::kSub ||
+            m_opcode == OpcodeEnum::kMul) {
+            p_out.append(" nsw");
+        } else if (m_opcode == OpcodeEnum::kSDiv) {
+            p_out.append(" exact");
+        }
+        p_out.append(" ");
+        printTypedOperand(p_out, m_operands[0]);
+        p_out.append(", ");
+        m_operands[1]->printAsOperand(p_out);
+        break;
+    case OpcodeEnum::kICmp:
+        p_out.append("icmp ")
+            .append(kPredicateStrings[static_cast<size_t>(m_predicate)])
+            .append(" ");
+        printTypedOperand(p_out, m_operands[0]);
+        p_out.append(", ");
+        m_operands[1]->printAsOperand(p_out);
+        break;
+    case OpcodeEnum::kPhi:
+        p_out.append("phi ").append(getType()->getName()).append(" ");
+        for (size_t i = 0; i < m_operands.size(); i += 2) {
+            if (i) {
+                p_out.append(", ");
+            }
+            p_out.append("[ ");
+            m_operands[i]->printAsOperand(p_out);
+            p_out.append(", ");
+            m_operands[i + 1]->printAsOperand(p_out);
+            p_out.append(" ]");
+        }
+        break;
+    case OpcodeEnum::kCall: {
+        const auto *callee = static_cast<const IrFunction *>(m_operands[0]);
+        if (m_tail_call == TailCallEnum::kTail) {
+            p_out.append("tail ");
+        } else if (m_tail_call == TailCallEnum::kMustTail) {
+            p_out.append("musttail ");
+        }
+        p_out.append("call ");
+        callee->printCallSignature(p_out);
+        p_out.append(" ");
+        callee->printAsOperand(p_out);
+        p_out.append("(");
+        for (size_t i = 1; i < m_operands.size(); ++i) {
+            if (i != 1) {
+                p_out.append(", ");
+            }
+            printTypedOperand(p_out, m_operands[i]);
+        }
+        p_out.append(")");
+        break;
+    }
+    case OpcodeEnum::kBr:
+        p_out.append("br ");
+        printTypedOperand(p_out, m_operands[0]);
+        break;
+    case OpcodeEnum::kCondBr:
+        p_out.append("br ");
+        printTypedOperand(p_out, m_operands[0]);
+        p_out.append(", ");
+        printTypedOperand(p_out, m_operands[1]);
+        p_out.append(", ");
+        printTypedOperand(p_out, m_operands[2]);
+        break;
+    case OpcodeEnum::kRet:
+        p_out.append("ret ");
+        if (m_operands.empty()) {
+            p_out.append("void");
+        } else {
+            printTypedOperand(p_out, m_operands[0]);
+        }
+        break;
+    case OpcodeEnum::kUnreachable:
+        p_out.append("unreachable");
+        break;
+    }
+
+    if (!m_comment.empty()) {
+        p_out.append(" ; ").append(m_comment);
+    }
+    p_out.append("\n");
+}
+
+// ===========================================
+// > IrBasicBlock
+// ===========================================
+IrInstruction *IrBasicBlock::getTerminator() const {
+    if (m_instructions.empty() || !m_instructions.back()->isTerminator()) {
+        return nullptr;
+    }
+    return m_instructions.back().get();
+}
+
+std::vector<IrBasicBlock *> IrBasicBlock::getSuccessors() const {
+    std::vector<IrBasicBlock *> successors;
+    const auto *terminator = getTerminator();
+    if (!terminator) {
+        return successors;
+    }
+    for (auto *operand : terminator->getOperands()) {
+        if (operand->getKind() == KindEnum::kBasicBlock) {
+            successors.emplace_back(static_cast<IrBasicBlock *>(operand));
+        }
+    }
+    return successors;
+}
+
+IrInstruction *IrBasicBlock::append(IrInstruction *const p_inst) {
+    p_inst->setParent(this);
+    m_instructions.emplace_back(p_inst);
+    return p_inst;
+}
+
+IrInstruction *IrBasicBlock::insertPhi(IrInstruction *const p_phi) {
+    auto position = std::find_if(
+        m_instructions.begin(), m_instructions.end(),
+        [](const auto &p_inst) { return !p_inst->isPhi(); });
+    p_phi->setParent(this);
+    m_instructions.emplace(position, p_phi);
+    return p_phi;
+}
+
+IrInstruction *IrBasicBlock::insertBefore(IrInstruction *const p_position,
+                                          IrInstruction *const p_inst) {
+    auto search = std::find_if(
+        m_instructions.begin(), m_instructions.end(),
+        [p_position](const auto &p_owned) { return p_owned.get() == p_position; });
+    assert(search != m_instructions.end() && "position is not in the block");
+    p_inst->setParent(this);
+    m_instructions.emplace(search, p_inst);
+    return p_inst;
+}
+
+std::unique_ptr<IrInstruction> IrBasicBlock::remove(IrInstruction *const p_inst) {
+    // mostly the terminator, which is at the end of a block of any size
+    auto search = std::find_if(
+        m_instructions.rbegin(), m_instructions.rend(),
+        [p_inst](const auto &p_owned) { return p_owned.get() == p_inst; }).base();
+    assert(search != m_instructions.begin() && "instruction is not in the block");
+    --search;
+
+    std::unique_ptr<IrInstruction> inst(search->release());
+    m_instructions.erase(search);
+    inst->setParent(nullptr);
+    return inst;
+}
+
+void IrBasicBlock::remove(const std::unordered_set<IrInstruction *> &p_insts,
+                          Instructions &p_removed) {
+    auto kept = m_instructions.begin();
+    for (auto &inst : m_instructions) {
+        if (p_insts.count(inst.get())) {
+            inst->setParent(nullptr);
+            p_removed.emplace_back(std::move(inst));
+        } else {
+            *kept++ = std::move(inst);
+        }
+    }
+    m_instructions.erase(kept, m_instructions.end());
+}
+
+void IrBasicBlock::splice(IrBasicBlock *const p_block) {
+    for (auto &inst : p_block->m_instructions) {
+        inst->setParent(this);
+        m_instructions.emplace_back(std::move(inst));
+    }
+    p_block->m_instructions.clear();
+}
+
+void IrBasicBlock::splitAfter(IrInstruction *const p_position,
+                              IrBasicBlock *const p_block) {
+    auto search = std::find_if(
+        m_instructions.begin(), m_instructions.end(),
+        [p_position](const auto &p_owned) { return p_owned.get() == p_position; });
+    assert(search != m_instructions.end() && "position is not in the block");
+    for (auto iter = std::next(search); iter != m_instructions.end(); ++iter) {
+        (*iter)->setParent(p_block);
+        p_block->m_instructions.emplace_back(std::move(*iter));
+    }
+    m_instructions.erase(std::next(search), m_instructions.end());
+}
+
+void IrBasicBlock::removePredecessor(IrBasicBlock *const p_block) {
+    auto search =
+        std::find(m_predecessors.begin(), m_predecessors.end(), p_block);
+    assert(search != m_predecessors.end() && "not a predecessor");
+    m_predecessors.erase(search);
+    for (const auto &inst : m_instructions) {
+        if (!inst->isPhi()) {
+            break;
+        }
+        inst->removeIncoming(p_block);
+    }
+}
+
+void IrBasicBlock::replacePredecessor(IrBasicBlock *const p_from,
+                                      IrBasicBlock *const p_to) {
+    std::replace(m_predecessors.begin(), m_predecessors.end(), p_from, p_to);
+    for (const auto &inst : m_instructions) {
+        if (!inst->isPhi()) {
+            break;
+        }
+        for (size_t i = 1; i < inst->getOperands().size(); i += 2) {
+            if (inst->getOperand(i) == p_from) {
+                inst->setOperand(i, p_to);
+            }
+        }
+    }
+}
+
+void IrBasicBlock::print(OutputBuffer &p_out, const bool print_label) const {
+    if (print_label) {
+        p_out.appendUInt(m_slot).append(":");
+        if (!m_comment.empty()) {
+            p_out.append("  ; ").append(m_comment);
+        }
+        p_out.append("\n");
+    }
+    for (const auto &inst : m_instructions) {
+        inst->print(p_out);
+    }
+}
+
+// ===========================================
+// > IrFunction
+// ===========================================
+IrFunction::IrFunction(IrModule &p_module, const std::string &p_name,
+                       const IrType *const p_return_type,
+                       const std::vector<const IrType *> &p_param_types,
+                       const bool is_var_arg)
+    : IrValue(KindEnum::kFunction, p_return_type), m_name(p_name),
+      m_return_type(p_return_type), m_is_var_arg(is_var_arg),
+      m_module(p_module) {
+    for (const auto *type : p_param_types) {
+        m_arguments.emplace_back(new IrArgument(type));
+    }
+}
+
+IrBasicBlock *IrFunction::createBasicBlock(const std::string &p_comment) {
+    m_detached_blocks.emplace_back(
+        new IrBasicBlock(m_module.getLabelType(), this, p_comment));
+    return m_detached_blocks.back().get();
+}
+
+void IrFunction::insertBasicBlock(IrBasicBlock *const p_block,
+                                  IrBasicBlock *const p_position) {
+    insertBasicBlocks({p_block}, p_position);
+}
+
+void IrFunction::insertBasicBlocks(const std::vector<IrBasicBlock *> &p_blocks,
+                                   IrBasicBlock *const p_position) {
+    // mostly the last ones created, so they are looked for from the back
+    BasicBlocks blocks(p_blocks.size());
+    for (size_t i = p_blocks.size(); i-- > 0;) {
+        auto search = std::find_if(m_detached_blocks.rbegin(),
+                                   m_detached_blocks.rend(),
+                                   [&p_blocks, i](const auto &p_detached) {
+                                       return p_detached.get() == p_blocks[i];
+                                   });
+        assert(search != m_detached_blocks.rend() &&
+               "block is not detached or belongs to another function");
+        blocks[i].reset(search->release());
+        m_detached_blocks.erase(std::next(search).base());
+    }
+
+    auto position = m_blocks.end();
+    if (p_position) {
+        position = std::find_if(m_blocks.begin(), m_blocks.end(),
+                                [p_position](const auto &p_placed) {
+                                    return p_placed.get() == p_position;
+                                });
+    }
+    m_blocks.insert(position, std::make_move_iterator(blocks.begin()),
+                    std::make_move_iterator(blocks.end()));
+}
+
+std::vector<IrInstruction *> IrFunction::replaceAllUsesWith(IrValue *const p_from,
+                                                           IrValue *const p_to) {
+    std::vector<IrInstruction *> users;
+    for (const auto &block : m_blocks) {
+        for (const auto &inst : block->getInstructions()) {
+            bool is_user = false;
+            for (size_t i = 0; i < inst->getOperands().size(); ++i) {
+                if (inst->getOperand(i) == p_from) {
+                    inst->setOperand(i, p_to);
+                    is_user = true;
+                }
+            }
+            if (is_user) {
+                users.emplace_back(inst.get());
+            }
+        }
+    }
+    return users;
+}
+
+void IrFunction::replaceAllUsesWith(
+    const std::unordered_map<IrValue *, IrValue *> &p_replacements) {
+    if (p_replacements.empty()) {
+        return;
+    }
+    for (const auto &block : m_blocks) {
+        for (const auto &inst : block->getInstructions()) {
+            for (size_t i = 0; i < inst->getOperands().size(); ++i) {
+                IrValue *operand = inst->getOperand(i);
+                for (auto search = p_replacements.find(operand);
+                     search != p_replacements.end();
+                     search = p_replacements.find(operand)) {
+                    operand = search->second;
+                }
+                inst->setOperand(i, operand);
+            }
+        }
+    }
+}
+
+void IrFunction::eraseInstruction(IrInstruction *const p_inst) {
+    m_erased_instructions.emplace_back(p_inst->getParent()->remove(p_inst));
+}
+
+void IrFunction::eraseInstructions(
+    const std::unordered_set<IrInstruction *> &p_insts) {
+    if (p_insts.empty()) {
+        return;
+    }
+    for (const auto &block : m_blocks) {
+        block->remove(p_insts, m_erased_instructions);
+    }
+}
+
+void IrFunction::eraseBasicBlock(IrBasicBlock *const p_block) {
+    auto search = std::find_if(
+        m_blocks.begin(), m_blocks.end(),
+        [p_block](const auto &p_placed) { return p_placed.get() == p_block; });
+    assert(search != m_blocks.end() && "block is not in the layout");
+
+    m_erased_blocks.emplace_back(search->release());
+    m_blocks.erase(search);
+}
+
+void IrFunction::eraseBasicBlocks(
+    const std::unordered_set<IrBasicBlock *> &p_blocks) {
+    auto kept = m_blocks.begin();
+    for (auto &block : m_blocks) {
+        if (p_blocks.count(block.get())) {
+            m_erased_blocks.emplace_back(std::move(block));
+        } else {
+            *kept++ = std::move(block);
+        }
+    }
+    m_blocks.erase(kept, m_blocks.end());
+}
+
+void IrFunction::printCallSignature(OutputBuffer &p_out) const {
+    p_out.append(m_return_type->getName());
+    if (!m_is_var_arg) {
+        return;
+    }
+
+    p_out.append(" (");
+    for (const auto &arg : m_arguments) {
+        p_out.append(arg->getType()->getName()).append(", ");
+    }
+    p_out.append("...)");
+}
+
+// LLVM requires unnamed values to be numbered sequentially: arguments first,
+// then every block label and every instruction that produces a value, in
+// layout order.
+void IrFunction::numberValues() const {
+    int64_t slot = 0;
+    for (const auto &arg : m_arguments) {
+        arg->m_slot = slot++;
+    }
+    for (const auto &block : m_blocks) {
+        block->m_slot = slot++;
+        for (const auto &inst : block->getInstructions()) {
+            if (inst->hasResult()) {
+                inst->m_slot = slot++;
+            }
+        }
+    }
+}
+
+void IrFunction::print(OutputBuffer &p_out) const {
+    p_out.append(isDeclaration() ? "declare " : "\ndefine ")
+        .append(m_return_type->getName())
+        .append(" @")
+        .append(m_name)
+        .append("(");
+    for (size_t i = 0; i < m_arguments.size(); ++i) {
+        if (i) {
+            p_out.append(", ");
+        }
+        p_out.append(m_arguments[i]->getType()->getName());
+        if (!isDeclaration()) {
+            p_out.append(" %").appendUInt(i);
+        }
+    }
+    if (m_is_var_arg) {
+        p_out.append(m_arguments.empty() ? "..." : ", ...");
+    }
+    p_out.append(")");
+
+    if (isDeclaration()) {
+        p_out.append("\n");
+        return;
+    }
+
+    numberValues();
+
+    p_out.append(" {\n");
+    // the label of the entry block is implicit
+    bool is_entry = true;
+    for (const auto &block : m_blocks) {
+        block->print(p_out, !is_entry);
+        is_entry = false;
+    }
+    p_out.append("}\n");
+}
+
+// ===========================================
+// > IrModule
+// ===========================================
+const IrType *IrModule::getType(const IrType::TypeEnum type,
+                                const uint32_t bits,
+                                const IrType *const p_element_type,
+                                const uint64_t num_elements) {
+    auto &slot =
+        m_types[std::make_tuple(type, bits, p_element_type, num_elements)];
+    if (!slot) {
+        slot.reset(new IrType(type, bits, p_element_type, num_elements));
+    }
+    return slot.get();
+}
+
+const IrType *IrModule::getVoidType() {
+    return getType(IrType::TypeEnum::kVoidType, 0, nullptr, 0);
+}
+
+const IrType *IrModule::getLabelType() {
+    return getType(IrType::TypeEnum::kLabelType, 0, nullptr, 0);
+}
+
+const IrType *IrModule::getIntegerType(const uint32_t bits) {
+    return getType(IrType::TypeEnum::kIntegerType, bits, nullptr, 0);
+}
+
+const IrType *IrModule::getPointerType(const IrType *const p_element_type) {
+    return getType(IrType::TypeEnum::kPointerType, 0, p_element_type, 0);
+}
+
+const IrType *IrModule::getArrayType(const IrType *const p_element_type,
+                                     const uint64_t num_elements) {
+    return getType(IrType::TypeEnum::kArrayType, 0, p_element_type,
+                   num_elements);
+}
+
+IrConstantInt *IrModule::getConstantInt(const IrType *const p_type,
+                                        const int64_t value) {
+    auto &slot = m_constants[std::make_pair(p_type, value)];
+    if (!slot) {
+        slot.reset(new IrConstantInt(p_type, value));
+    }
+    return slot.get();
+}
+
+IrConstantExpr *IrModule::createConstantExpr(const IrType *const p_type,
+                                             const std::string &p_text) {
+    m_constant_exprs.emplace_back(new IrConstantExpr(p_type, p_text));
+    return m_constant_exprs.back().get();
+}
+
+IrGlobalVariable *
+IrModule::createGlobalVariable(const IrType *const p_value_type,
+                               const std::string &p_name,
+                               const std::string &p_definition) {
+    m_globals.emplace_back(new IrGlobalVariable(
+        getPointerType(p_value_type), p_value_type, p_name, p_definition));
+    return m_globals.back().get();
+}
+
+IrFunction *
+IrModule::createFunction(const std::string &p_name,
+                         const IrType *const p_return_type,
+                         const std::vector<const IrType *> &p_param_types,
+                         const bool is_var_arg) {
+    m_functions.emplace_back(
+        new IrFunction(*this, p_name, p_return_type, p_param_types, is_var_arg));
+    return m_functions.back().get();
+}
+
+size_t IrModule::getNumInstructions() const {
+    size_t num_instructions = 0;
+    for (const auto &function : m_functions) {
+        for (const auto &block : function->getBasicBlocks()) {
+            num_instructions += block->getInstructions().size();
+        }
+    }
+    return num_instructions;
+}
+
+void IrModule::print(OutputBuffer &p_out) const {
+    p_out.append(m_header);
+
+    p_out.append("\n");
+    for (const auto &function : m_functions) {
+        if (function->isDeclaration()) {
+            function->print(p_out);
+        }
+    }
+
+    p_out.append("\n");
+    for (const auto &global : m_globals) {
+        global->print(p_out);
+    }
+
+    for (const auto &function : m_functions) {
+        if (!function->isDeclaration()) {
+            function->print(p_out);
+        }
+    }
+}
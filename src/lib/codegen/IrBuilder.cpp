@@ -0,0 +1,181 @@
+#include "codegen/IrBuilder.hpp"
+
+#include <cassert>
+
+void IrBuilder::setFunction(IrFunction *const p_function) {
+    m_function = p_function;
+    m_insert_block = nullptr;
+    if (m_function) {
+        setInsertPoint(m_function->createBasicBlock());
+    }
+}
+
+IrBasicBlock *IrBuilder::createBasicBlock(const std::string &p_comment) {
+    assert(m_function && "no function to create the block in");
+    return m_function->createBasicBlock(p_comment);
+}
+
+void IrBuilder::setInsertPoint(IrBasicBlock *const p_block) {
+    m_function->insertBasicBlock(p_block);
+    m_insert_block = p_block;
+}
+
+bool IrBuilder::isTerminated() const {
+    return m_insert_block && m_insert_block->getTerminator();
+}
+
+IrInstruction *IrBuilder::insert(IrInstruction *const p_inst) {
+    assert(m_insert_block && "no insertion point");
+    // code following a terminator (e.g., statements after a return) is
+    // unreachable, but it still needs a block of its own to be valid IR
+    if (isTerminated()) {
+        setInsertPoint(createBasicBlock());
+    }
+    return m_insert_block->append(p_inst);
+}
+
+IrConstantInt *IrBuilder::getInt1(const bool value) {
+    return m_module.getConstantInt(m_module.getIntegerType(1), value);
+}
+
+IrConstantInt *IrBuilder::getInt32(const int64_t value) {
+    return m_module.getConstantInt(m_module.getIntegerType(32), value);
+}
+
+IrConstantInt *IrBuilder::getInt64(const int64_t value) {
+    return m_module.getConstantInt(m_module.getIntegerType(64), value);
+}
+
+IrInstruction *IrBuilder::createAlloca(const IrType *const p_type,
+                                       const std::string &p_comment) {
+    auto *inst =
+        new IrInstruction(IrInstruction::OpcodeEnum::kAlloca,
+                          m_module.getPointerType(p_type), {});
+    inst->setAuxType(p_type);
+    inst->setComment(p_comment);
+    return insert(inst);
+}
+
+IrInstruction *IrBuilder::createEntryAlloca(const IrType *const p_type,
+                                            const std::string &p_comment) {
+    assert(m_function && "no function to allocate in");
+    auto *inst =
+        new IrInstruction(IrInstruction::OpcodeEnum::kAlloca,
+                          m_module.getPointerType(p_type), {});
+    inst->setAuxType(p_type);
+    inst->setComment(p_comment);
+    auto *entry = m_function->getEntryBlock();
+    if (entry->empty()) {
+        return entry->append(inst);
+    }
+    return entry->insertBefore(entry->getInstructions().front().get(), inst);
+}
+
+IrInstruction *IrBuilder::createLoad(IrValue *const p_ptr) {
+    assert(p_ptr->getType()->isPointer() && "load from a non-pointer value");
+    return insert(new IrInstruction(IrInstruction::OpcodeEnum::kLoad,
+                                    p_ptr->getType()->getElementType(),
+                                    {p_ptr}));
+}
+
+IrInstruction *IrBuilder::createStore(IrValue *const p_value,
+                                      IrValue *const p_ptr,
+                                      const std::string &p_comment) {
+    assert(p_ptr->getType() == m_module.getPointerType(p_value->getType()) &&
+           "store to a pointer of mismatched type");
+    auto *inst = new IrInstruction(IrInstruction::OpcodeEnum::kStore,
+                                   m_module.getVoidType(), {p_value, p_ptr});
+    inst->setComment(p_comment);
+    return insert(inst);
+}
+
+IrInstruction *
+IrBuilder::createGetElementPtr(IrValue *const p_ptr,
+                               const std::vector<IrValue *> &p_indices) {
+    assert(p_ptr->getType()->isPointer() && !p_indices.empty() &&
+           "getelementptr needs a pointer and at least one index");
+
+    // the first index steps over the pointer, the rest go into the aggregate
+    const IrType *source_type = p_ptr->getType()->getElementType();
+    const IrType *result_type = source_type;
+    for (size_t i = 1; i < p_indices.size(); ++i) {
+        assert(result_type->isArray() && "index into a non-aggregate type");
+        result_type = result_type->getElementType();
+    }
+
+    std::vector<IrValue *> operands{p_ptr};
+    operands.insert(operands.end(), p_indices.begin(), p_indices.end());
+    auto *inst = new IrInstruction(IrInstruction::OpcodeEnum::kGetElementPtr,
+                                   m_module.getPointerType(result_type),
+                                   std::move(operands));
+    inst->setAuxType(source_type);
+    return insert(inst);
+}
+
+IrInstruction *IrBuilder::createBinary(const IrInstruction::OpcodeEnum opcode,
+                                       IrValue *const p_lhs,
+                                       IrValue *const p_rhs) {
+    assert(p_lhs->getType() == p_rhs->getType() &&
+           "binary operator on mismatched types");
+    return insert(new IrInstruction(opcode, p_lhs->getType(), {p_lhs, p_rhs}));
+}
+
+IrInstruction *
+IrBuilder::createICmp(const IrInstruction::PredicateEnum predicate,
+                      IrValue *const p_lhs, IrValue *const p_rhs) {
+    assert(p_lhs->getType() == p_rhs->getType() &&
+           "comparison on mismatched types");
+    auto *inst = new IrInstruction(IrInstruction::OpcodeEnum::kICmp,
+                                   m_module.getIntegerType(1), {p_lhs, p_rhs});
+    inst->setPredicate(predicate);
+    return insert(inst);
+}
+
+IrInstruction *IrBuilder::createPhi(IrBasicBlock *const p_block,
+                                    const IrType *const p_type) {
+    return p_block->insertPhi(
+        new IrInstruction(IrInstruction::OpcodeEnum::kPhi, p_type, {}));
+}
+
+IrInstruction *IrBuilder::createCall(IrFunction *const p_callee,
+                                     const std::vector<IrValue *> &p_args) {
+    std::vector<IrValue *> operands{p_callee};
+    operands.insert(operands.end(), p_args.begin(), p_args.end());
+    return insert(new IrInstruction(IrInstruction::OpcodeEnum::kCall,
+                                    p_callee->getReturnType(),
+                                    std::move(operands)));
+}
+
+IrInstruction *IrBuilder::createBr(IrBasicBlock *const p_target) {
+    auto *inst = insert(new IrInstruction(IrInstruction::OpcodeEnum::kBr,
+                                          m_module.getVoidType(), {p_target}));
+    p_target->addPredecessor(inst->getParent());
+    return inst;
+}
+
+IrInstruction *IrBuilder::createCondBr(IrValue *const p_condition,
+                                       IrBasicBlock *const p_true_block,
+                                       IrBasicBlock *const p_false_block) {
+    auto *inst = insert(
+        new IrInstruction(IrInstruction::OpcodeEnum::kCondBr,
+                          m_module.getVoidType(),
+                          {p_condition, p_true_block, p_false_block}));
+    p_true_block->addPredecessor(inst->getParent());
+    p_false_block->addPredecessor(inst->getParent());
+    return inst;
+}
+
+IrInstruction *IrBuilder::createRet(IrValue *const p_value) {
+    std::vector<IrValue *> operands;
+    if (p_value) {
+        operands.emplace_back(p_value);
+    }
+    return insert(new IrInstruction(IrInstruction::OpcodeEnum::kRet,
+                                    m_module.getVoidType(),
+                                    std::move(operands)));
+}
+
+IrInstruction *IrBuilder::createUnreachable() {
+    return insert(new IrInstruction(IrInstruction::OpcodeEnum::kUnreachable,
+                                    m_module.getVoidType(), {}));
+}
@@ -0,0 +1,94 @@
+#include "codegen/OutputBuffer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+
+void OutputBuffer::appendSlow(const char *p_data, size_t length) {
+    while (length) {
+        if (m_cursor == m_end) {
+            if (!m_chunks.empty()) {
+                m_chunk_sizes.emplace_back(m_cursor - m_chunks.back().get());
+            }
+            m_chunks.emplace_back(new char[kChunkSize]);
+            m_cursor = m_chunks.back().get();
+            m_end = m_cursor + kChunkSize;
+        }
+
+        const size_t n =
+            std::min(length, static_cast<size_t>(m_end - m_cursor));
+        memcpy(m_cursor, p_data, n);
+        m_cursor += n;
+        p_data += n;
+        length -= n;
+    }
+}
+
+OutputBuffer &OutputBuffer::appendUInt(uint64_t value) {
+    // enough for 2^64 - 1
+    char digits[20];
+    char *begin = digits + sizeof(digits);
+    do {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value);
+    return append(begin, digits + sizeof(digits) - begin);
+}
+
+OutputBuffer &OutputBuffer::appendInt(const int64_t value) {
+    if (value < 0) {
+        append('-');
+        // negate in unsigned arithmetic so that INT64_MIN works as well
+        return appendUInt(0 - static_cast<uint64_t>(value));
+    }
+    return appendUInt(static_cast<uint64_t>(value));
+}
+
+size_t OutputBuffer::size() const {
+    if (m_chunks.empty()) {
+        return 0;
+    }
+
+    size_t total = m_cursor - m_chunks.back().get();
+    for (const auto chunk_size : m_chunk_sizes) {
+        total += chunk_size;
+    }
+    return total;
+}
+
+bool OutputBuffer::writeTo(const int p_fd) const {
+    std::vector<struct iovec> iovs;
+    iovs.reserve(m_chunks.size());
+    for (size_t i = 0; i < m_chunks.size(); ++i) {
+        const size_t chunk_size = (i + 1 == m_chunks.size())
+                                      ? m_cursor - m_chunks[i].get()
+                                      : m_chunk_sizes[i];
+        iovs.push_back({m_chunks[i].get(), chunk_size});
+    }
+
+    auto *iov = iovs.data();
+    auto *const iov_end = iovs.data() + iovs.size();
+    while (iov != iov_end) {
+        const int count = static_cast<int>(
+            std::min<ptrdiff_t>(iov_end - iov, IOV_MAX));
+        ssize_t written = writev(p_fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        // skip what has been written, a partial write may end mid-chunk
+        while (iov != iov_end && static_cast<size_t>(written) >= iov->iov_len) {
+            written -= iov->iov_len;
+            ++iov;
+        }
+        if (written) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+#include "codegen/SsaBuilder.hpp"
+
+#include <cassert>
+
+void SsaBuilder::declareVariable(Variable p_variable,
+                                 const IrType *const p_type) {
+    m_variable_types[p_variable] = p_type;
+}
+
+void SsaBuilder::writeVariable(Variable p_variable, IrBasicBlock *const p_block,
+                               IrValue *const p_value) {
+    assert(isTracked(p_variable) && "variable is not in SSA form");
+    m_current_defs[p_variable][p_block] = p_value;
+}
+
+IrValue *SsaBuilder::readVariable(Variable p_variable,
+                                  IrBasicBlock *const p_block) {
+    assert(isTracked(p_variable) && "variable is not in SSA form");
+    auto &defs = m_current_defs[p_variable];
+    auto search = defs.find(p_block);
+    if (search != defs.end()) {
+        return search->second;
+    }
+    return readVariableRecursive(p_variable, p_block);
+}
+
+IrValue *SsaBuilder::readVariableRecursive(Variable p_variable,
+                                           IrBasicBlock *const p_block) {
+    const IrType *type = m_variable_types[p_variable];
+    const auto &predecessors = p_block->getPredecessors();
+
+    IrValue *value = nullptr;
+    if (m_unsealed_blocks.count(p_block)) {
+        auto *phi = m_builder.createPhi(p_block, type);
+        m_incomplete_phis[p_block].emplace_back(p_variable, phi);
+        value = phi;
+    } else if (predecessors.empty()) {
+        // read before any assignment (or in unreachable code); P leaves
+        // such locals unspecified, use zero instead of undef
+        value = m_builder.getModule().getConstantInt(type, 0);
+    } else if (predecessors.size() == 1) {
+        value = readVariable(p_variable, predecessors.front());
+    } else {
+        // break potential cycles with an operandless phi
+        auto *phi = m_builder.createPhi(p_block, type);
+        writeVariable(p_variable, p_block, phi);
+        value = addPhiOperands(p_variable, phi);
+    }
+    writeVariable(p_variable, p_block, value);
+    return value;
+}
+
+IrValue *SsaBuilder::addPhiOperands(Variable p_variable,
+                                    IrInstruction *const p_phi) {
+    for (auto *predecessor : p_phi->getParent()->getPredecessors()) {
+        p_phi->addIncoming(readVariable(p_variable, predecessor), predecessor);
+    }
+    return tryRemoveTrivialPhi(p_phi);
+}
+
+IrValue *SsaBuilder::tryRemoveTrivialPhi(IrInstruction *const p_phi) {
+    IrValue *same = nullptr;
+    const auto &operands = p_phi->getOperands();
+    for (size_t i = 0; i < operands.size(); i += 2) {
+        if (operands[i] == same || operands[i] == p_phi) {
+            continue;
+        }
+        if (same) {
+            // the phi merges at least two values
+            return p_phi;
+        }
+        same = operands[i];
+    }
+    if (!same) {
+        // the phi is unreachable or in the entry block
+        same = m_builder.getModule().getConstantInt(p_phi->getType(), 0);
+    }
+
+    auto *function = p_phi->getParent()->getParent();
+    auto users = function->replaceAllUsesWith(p_phi, same);
+    for (auto &defs : m_current_defs) {
+        for (auto &def : defs.second) {
+            if (def.second == p_phi) {
+                def.second = same;
+            }
+        }
+    }
+    function->eraseInstruction(p_phi);
+
+    // removing this phi may have made the phis using it trivial as well
+    for (auto *user : users) {
+        if (user != p_phi && user->isPhi() && user->getParent()) {
+            tryRemoveTrivialPhi(user);
+        }
+    }
+    return same;
+}
+
+void SsaBuilder::sealBlock(IrBasicBlock *const p_block) {
+    auto search = m_incomplete_phis.find(p_block);
+    if (search != m_incomplete_phis.end()) {
+        auto incomplete_phis = std::move(search->second);
+        m_incomplete_phis.erase(search);
+        for (auto &variable_phi : incomplete_phis) {
+            addPhiOperands(variable_phi.first, variable_phi.second);
+        }
+    }
+    m_unsealed_blocks.erase(p_block);
+}
+
+void SsaBuilder::clear() {
+    assert(m_incomplete_phis.empty() && "some blocks have not been sealed");
+    m_variable_types.clear();
+    m_current_defs.clear();
+    m_unsealed_blocks.clear();
+}
@@ -0,0 +1,32 @@
+#include "driver/AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+static thread_local uint64_t num_allocations = 0;
+static thread_local uint64_t allocated_bytes = 0;
+
+uint64_t AllocationCounter::getNumAllocations() { return num_allocations; }
+
+uint64_t AllocationCounter::getAllocatedBytes() { return allocated_bytes; }
+
+// The other forms of operator new (array, nothrow) end up here as well, and
+// the default operator delete frees with std::free().
+void *operator new(std::size_t p_size) {
+    ++num_allocations;
+    allocated_bytes += p_size;
+
+    if (p_size == 0) {
+        p_size = 1;
+    }
+    while (true) {
+        if (void *ptr = std::malloc(p_size)) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
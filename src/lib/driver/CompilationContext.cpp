@@ -0,0 +1,14 @@
+#include "driver/CompilationContext.hpp"
+#include "AST/program.hpp"
+
+CompilationContext::~CompilationContext() {
+    if (!m_recycle_memory) {
+        return;
+    }
+
+    // AstNode::operator delete leaves the memory to the arena, this only
+    // runs the destructors. After a syntax error there is no root, the
+    // parser has destroyed what it had built (see %destructor).
+    delete m_root;
+    AstArena::recycle(std::move(m_arena));
+}
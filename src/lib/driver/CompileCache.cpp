@@ -0,0 +1,359 @@
+#include "driver/CompileCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr char kLogMagic[8] = {'P', '2', 'L', 'C', 'L', 'O', 'G', '1'};
+
+// what precedes the printed output in <key>.log
+struct LogHeader {
+    char magic[8];
+    int32_t status;
+    uint32_t has_module;
+    uint64_t out_size;
+    uint64_t err_size;
+};
+
+static bool readFully(const int p_fd, char *p_data, size_t p_size) {
+    while (p_size) {
+        const ssize_t n = read(p_fd, p_data, p_size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p_data += n;
+        p_size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool writeFully(const int p_fd, const char *p_data, size_t p_size) {
+    while (p_size) {
+        const ssize_t n = write(p_fd, p_data, p_size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return false;
+        }
+        p_data += n;
+        p_size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool copyFile(const int p_from_fd, const int p_to_fd) {
+    char buffer[64 * 1024];
+    while (true) {
+        const ssize_t n = read(p_from_fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return n == 0;
+        }
+        if (!writeFully(p_to_fd, buffer, static_cast<size_t>(n))) {
+            return false;
+        }
+    }
+}
+
+// a name next to p_path no other thread or process is using
+static std::string makeTemporaryPath(const std::string &p_path) {
+    static std::atomic<unsigned> counter{0};
+    return p_path + ".tmp." + std::to_string(getpid()) + "." +
+           std::to_string(counter++);
+}
+
+static uint64_t getFileSize(const std::string &p_path) {
+    struct stat status;
+    return stat(p_path.c_str(), &status) == 0 ? status.st_size : 0;
+}
+
+std::string CompileCache::getEntryPath(const Key &p_key,
+                                       const char *p_suffix) const {
+    return m_directory + '/' + Sha256::toString(p_key) + p_suffix;
+}
+
+bool CompileCache::open() const {
+    return mkdir(m_directory.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+CompileCache::Key CompileCache::computeKey(const char *p_source,
+                                           const size_t p_source_size,
+                                           const std::string &p_source_path,
+                                           const std::string &p_options) {
+    // Rebuilding the compiler changes its executable, which stands in for
+    // a version number.
+    static const struct stat compiler = [] {
+        struct stat status{};
+        stat("/proc/self/exe", &status);
+        return status;
+    }();
+
+    Sha256 hash;
+    hash.updateValue(compiler.st_dev)
+        .updateValue(compiler.st_ino)
+        .updateValue(compiler.st_size)
+        .updateValue(compiler.st_mtim.tv_sec)
+        .updateValue(compiler.st_mtim.tv_nsec)
+        .update(p_options)
+        .update(p_source_path)
+        .updateValue(p_source_size)
+        .update(p_source, p_source_size);
+    return hash.finish();
+}
+
+template <typename Update>
+void CompileCache::updateStatistics(Update p_update) const {
+    const std::string path = m_directory + "/stats";
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    flock(fd, LOCK_EX);
+
+    Statistics statistics;
+    if (pread(fd, &statistics, sizeof(statistics), 0) !=
+        sizeof(statistics)) {
+        statistics = Statistics();
+    }
+    p_update(statistics);
+    // the statistics are advisory, a failed write is not worth reporting
+    const ssize_t written = pwrite(fd, &statistics, sizeof(statistics), 0);
+    (void)written;
+
+    // closing releases the lock
+    close(fd);
+}
+
+CompileCache::Statistics CompileCache::getStatistics() const {
+    Statistics statistics;
+    const std::string path = m_directory + "/stats";
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return statistics;
+    }
+    flock(fd, LOCK_SH);
+    if (pread(fd, &statistics, sizeof(statistics), 0) !=
+        sizeof(statistics)) {
+        statistics = Statistics();
+    }
+    close(fd);
+    return statistics;
+}
+
+bool CompileCache::lookup(const Key &p_key, Result &p_result) const {
+    const int fd =
+        ::open(getEntryPath(p_key, ".log").c_str(), O_RDONLY | O_CLOEXEC);
+
+    LogHeader header;
+    bool is_hit =
+        fd >= 0 && readFully(fd, reinterpret_cast<char *>(&header),
+                             sizeof(header)) &&
+        std::memcmp(header.magic, kLogMagic, sizeof(kLogMagic)) == 0;
+    if (is_hit) {
+        p_result.status = header.status;
+        p_result.has_module = header.has_module;
+        p_result.out.resize(header.out_size);
+        p_result.err.resize(header.err_size);
+        is_hit = readFully(fd, &p_result.out[0], header.out_size) &&
+                 readFully(fd, &p_result.err[0], header.err_size);
+    }
+    if (is_hit) {
+        // the modification time of the log is the last use
+        futimens(fd, nullptr);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+
+    updateStatistics([is_hit](Statistics &p_statistics) {
+        ++(is_hit ? p_statistics.hits : p_statistics.misses);
+    });
+    return is_hit;
+}
+
+bool CompileCache::installModule(const Key &p_key,
+                                 const std::string &p_output_path,
+                                 const int p_output_fd) const {
+    const std::string module_path = getEntryPath(p_key, ".ll");
+    if (p_output_fd < 0) {
+        // Both ways go through a new name, so that a file at p_output_path
+        // which may be linked elsewhere is replaced and not overwritten.
+        const std::string temporary_path = makeTemporaryPath(p_output_path);
+        if (link(module_path.c_str(), temporary_path.c_str()) == 0) {
+            if (rename(temporary_path.c_str(), p_output_path.c_str()) == 0) {
+                return true;
+            }
+            unlink(temporary_path.c_str());
+            return false;
+        }
+        if (errno == ENOENT) {
+            // evicted
+            return false;
+        }
+    }
+
+    const int module_fd = ::open(module_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (module_fd < 0) {
+        return false;
+    }
+
+    bool is_installed;
+    if (p_output_fd >= 0) {
+        is_installed = copyFile(module_fd, p_output_fd);
+    } else {
+        // e.g. the store is on another file system
+        const std::string temporary_path = makeTemporaryPath(p_output_path);
+        const int output_fd =
+            ::open(temporary_path.c_str(),
+                   O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        is_installed = output_fd >= 0 && copyFile(module_fd, output_fd);
+        if (output_fd >= 0) {
+            close(output_fd);
+        }
+        is_installed = is_installed && rename(temporary_path.c_str(),
+                                              p_output_path.c_str()) == 0;
+        if (!is_installed) {
+            unlink(temporary_path.c_str());
+        }
+    }
+    close(module_fd);
+    return is_installed;
+}
+
+int CompileCache::createModuleFile(std::string &p_path) const {
+    p_path = makeTemporaryPath(m_directory + "/module");
+    return ::open(p_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                  0644);
+}
+
+void CompileCache::store(const Key &p_key, const Result &p_result,
+                         const std::string &p_module_path) const {
+    const std::string module_path = getEntryPath(p_key, ".ll");
+    const std::string log_path = getEntryPath(p_key, ".log");
+    // Two compilations of the same input may both have missed, the second
+    // one to get here replaces the entry of the first.
+    struct stat log_status;
+    const bool is_replaced = stat(log_path.c_str(), &log_status) == 0;
+    const uint64_t replaced_size =
+        is_replaced ? log_status.st_size + getFileSize(module_path) : 0;
+    if (p_result.has_module) {
+        if (rename(p_module_path.c_str(), module_path.c_str()) != 0) {
+            unlink(p_module_path.c_str());
+            return;
+        }
+    } else {
+        unlink(p_module_path.c_str());
+    }
+
+    // The log goes in last, an entry is complete once it is there.
+    const std::string temporary_path = makeTemporaryPath(log_path);
+    const int fd = ::open(temporary_path.c_str(),
+                          O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    LogHeader header;
+    std::memcpy(header.magic, kLogMagic, sizeof(kLogMagic));
+    header.status = p_result.status;
+    header.has_module = p_result.has_module;
+    header.out_size = p_result.out.size();
+    header.err_size = p_result.err.size();
+    const bool is_written =
+        writeFully(fd, reinterpret_cast<const char *>(&header),
+                   sizeof(header)) &&
+        writeFully(fd, p_result.out.data(), p_result.out.size()) &&
+        writeFully(fd, p_result.err.data(), p_result.err.size());
+    close(fd);
+    if (!is_written || rename(temporary_path.c_str(), log_path.c_str()) != 0) {
+        unlink(temporary_path.c_str());
+        return;
+    }
+
+    const uint64_t entry_size =
+        sizeof(header) + header.out_size + header.err_size +
+        (p_result.has_module ? getFileSize(module_path) : 0);
+    updateStatistics([this, entry_size, is_replaced,
+                      replaced_size](Statistics &p_statistics) {
+        ++p_statistics.stores;
+        if (!is_replaced) {
+            ++p_statistics.num_entries;
+        }
+        p_statistics.size_bytes -=
+            std::min(p_statistics.size_bytes, replaced_size);
+        p_statistics.size_bytes += entry_size;
+        if (p_statistics.size_bytes > m_max_bytes) {
+            evict(p_statistics);
+        }
+    });
+}
+
+void CompileCache::evict(Statistics &p_statistics) const {
+    struct Entry {
+        timespec last_use;
+        std::string key;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total_size = 0;
+
+    DIR *directory = opendir(m_directory.c_str());
+    if (!directory) {
+        return;
+    }
+    static constexpr size_t kKeyLength = 2 * sizeof(Key);
+    while (const dirent *file = readdir(directory)) {
+        const std::string name = file->d_name;
+        if (name.size() != kKeyLength + 4 ||
+            name.compare(kKeyLength, 4, ".log") != 0) {
+            continue;
+        }
+
+        struct stat status;
+        const std::string key = name.substr(0, kKeyLength);
+        if (stat((m_directory + '/' + name).c_str(), &status) != 0) {
+            continue;
+        }
+        const uint64_t size =
+            status.st_size + getFileSize(m_directory + '/' + key + ".ll");
+        entries.push_back(Entry{status.st_mtim, key, size});
+        total_size += size;
+    }
+    closedir(directory);
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &p_lhs, const Entry &p_rhs) {
+                  return p_lhs.last_use.tv_sec != p_rhs.last_use.tv_sec
+                             ? p_lhs.last_use.tv_sec < p_rhs.last_use.tv_sec
+                             : p_lhs.last_use.tv_nsec < p_rhs.last_use.tv_nsec;
+              });
+
+    // evict down to 3/4 of the limit so that the next stores do not all
+    // have to scan the store again
+    const uint64_t target_size = m_max_bytes / 4 * 3;
+    size_t num_evicted = 0;
+    for (; num_evicted < entries.size() && total_size > target_size;
+         ++num_evicted) {
+        const auto &entry = entries[num_evicted];
+        // the log first, so that the entry stops being found
+        unlink((m_directory + '/' + entry.key + ".log").c_str());
+        unlink((m_directory + '/' + entry.key + ".ll").c_str());
+        total_size -= entry.size;
+    }
+
+    p_statistics.evictions += num_evicted;
+    p_statistics.num_entries = entries.size() - num_evicted;
+    p_statistics.size_bytes = total_size;
+}
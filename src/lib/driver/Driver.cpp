@@ -0,0 +1,473 @@
+#include "driver/Driver.hpp"
+#include "AST/AstDumper.hpp"
+#include "AST/Console.hpp"
+#include "AST/program.hpp"
+#include "codegen/CodeGenerator.hpp"
+#include "driver/CompilationContext.hpp"
+#include "driver/ThreadPool.hpp"
+#include "driver/TimeReport.hpp"
+#include "sema/SemanticAnalyzer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool Driver::parseArguments(const std::vector<std::string> &p_arguments,
+                            DriverOptions &p_options,
+                            std::vector<std::string> &p_source_paths) {
+    for (size_t i = 0; i < p_arguments.size(); ++i) {
+        const std::string &argument = p_arguments[i];
+        const bool has_value = i + 1 < p_arguments.size();
+        if (argument == "--dump-ast") {
+            p_options.dump_ast = true;
+        } else if (argument == "--ssa") {
+            p_options.use_ssa = true;
+        } else if (argument == "-O0" || argument == "-O1") {
+            p_options.opt_level = argument[2] - '0';
+        } else if (argument == "--unroll-budget" && has_value) {
+            // in instructions, 0 for no unrolling
+            char *end;
+            const char *value = p_arguments[++i].c_str();
+            p_options.unroll_budget = std::strtoull(value, &end, 10);
+            if (*value == '\0' || *end != '\0') {
+                return false;
+            }
+        } else if (argument == "--no-inline") {
+            p_options.no_inline = true;
+        } else if (argument == "--inline-report") {
+            p_options.inline_report = true;
+        } else if (argument == "--arena-report") {
+            p_options.arena_report = true;
+        } else if (argument == "--lex-only") {
+            p_options.lex_only = true;
+        } else if (argument == "--quiet") {
+            p_options.quiet = true;
+        } else if (argument == "--time-report") {
+            p_options.time_report = true;
+        } else if (argument == "--time-report=json") {
+            p_options.time_report = p_options.time_report_json = true;
+        } else if ((argument == "--save-path" || argument == "--save_path") &&
+                   has_value) {
+            // --save_path as the board Makefile spells it, which worked
+            // before the options were parsed by name
+            p_options.save_path = p_arguments[++i];
+        } else if (argument == "--trace-out" && has_value) {
+            p_options.trace_path = p_arguments[++i];
+        } else if (argument == "-o" && has_value) {
+            p_options.output_path = p_arguments[++i];
+        } else if (argument == "-j" && has_value) {
+            char *end;
+            const char *value = p_arguments[++i].c_str();
+            p_options.num_jobs = std::strtoul(value, &end, 10);
+            if (*value == '\0' || *end != '\0') {
+                return false;
+            }
+            if (p_options.num_jobs == 0) {
+                p_options.num_jobs = ThreadPool::getDefaultSize();
+            }
+        } else if (argument == "--cache-dir" && has_value) {
+            p_options.cache_directory = p_arguments[++i];
+        } else if (argument == "--cache-size" && has_value) {
+            // in MiB
+            char *end;
+            const char *value = p_arguments[++i].c_str();
+            p_options.cache_max_bytes = std::strtoull(value, &end, 10) << 20;
+            if (*value == '\0' || *end != '\0') {
+                return false;
+            }
+        } else if (argument == "--cache-stats") {
+            p_options.cache_stats = true;
+        } else if (argument == "--serve" && has_value) {
+            p_options.serve_socket_path = p_arguments[++i];
+        } else if (!argument.empty() && argument[0] != '-') {
+            p_source_paths.push_back(argument);
+        } else {
+            return false;
+        }
+    }
+
+    if (!p_options.serve_socket_path.empty()) {
+        return p_source_paths.empty();
+    }
+    // --cache-stats alone just prints the statistics
+    return (!p_source_paths.empty() || p_options.cache_stats) &&
+           (p_source_paths.size() <= 1 || p_options.output_path.empty());
+}
+
+Driver::Driver(const DriverOptions &p_options, const bool p_recycle_memory)
+    : m_options(p_options), m_recycle_memory(p_recycle_memory) {
+    if (!m_options.trace_path.empty()) {
+        m_tracer.reset(new Tracer);
+#ifdef NO_TRACE
+        std::fprintf(Console::err(), "--trace-out: built with NO_TRACE, the "
+                                     "trace will have no spans\n");
+#endif
+    }
+
+    if (m_options.cache_directory.empty()) {
+        return;
+    }
+
+    m_cache.reset(new CompileCache(resolvePath(m_options.cache_directory),
+                                   m_options.cache_max_bytes));
+    if (!m_cache->open()) {
+        std::fprintf(Console::err(), "%s: %s, compiling without a cache\n",
+                     m_options.cache_directory.c_str(), std::strerror(errno));
+        m_cache.reset();
+    }
+}
+
+std::string Driver::resolvePath(const std::string &p_path) const {
+    if (m_options.working_directory.empty() || p_path.empty() ||
+        p_path[0] == '/') {
+        return p_path;
+    }
+    return m_options.working_directory + '/' + p_path;
+}
+
+std::string Driver::getOutputPath(const std::string &p_source_path) const {
+    return resolvePath(
+        m_options.output_path.empty()
+            ? CodeGenerator::getOutputFilePath(p_source_path,
+                                               m_options.save_path)
+            : m_options.output_path);
+}
+
+int Driver::compile(const std::string &p_source_path,
+                    const bool p_recycle_memory) const {
+    Tracer::Scope trace_scope(m_tracer.get());
+    TRACE_SPAN("driver", "compile", p_source_path.c_str());
+
+    // The scanner works directly on the mapped source and diagnostics
+    // quote their lines from it.
+    CompilationContext context(p_source_path, p_recycle_memory);
+    if (!context.open(resolvePath(p_source_path))) {
+        std::fprintf(Console::err(), "%s: %s\n", p_source_path.c_str(),
+                     std::strerror(errno));
+        return -1;
+    }
+    SourceBuffer::Scope source_buffer_scope(context.getSource());
+
+    // what these print depends on more than the source
+    if (m_cache && !m_options.lex_only && !m_options.arena_report &&
+        !m_options.time_report && !m_options.inline_report) {
+        return compileCached(context);
+    }
+
+    bool has_module;
+    bool is_module_copied;
+    return runPasses(context, -1, has_module, is_module_copied);
+}
+
+int Driver::compileCached(CompilationContext &p_context) const {
+    // everything else that changes the output
+    std::string options;
+    options += m_options.use_ssa ? " --ssa" : "";
+    options += " -O" + std::to_string(m_options.opt_level);
+    options += " --unroll-budget " + std::to_string(m_options.unroll_budget);
+    options += m_options.no_inline ? " --no-inline" : "";
+    options += m_options.dump_ast ? " --dump-ast" : "";
+    options += m_options.quiet ? " --quiet" : "";
+
+    const auto &source = p_context.getSource();
+    const auto key =
+        CompileCache::computeKey(source.getData(), source.getSize(),
+                                 p_context.getSourcePath(), options);
+    const std::string output_path =
+        m_options.ir_stdout_fd < 0 ? getOutputPath(p_context.getSourcePath())
+                                   : std::string();
+
+    CompileCache::Result result;
+    if (m_cache->lookup(key, result) &&
+        (!result.has_module ||
+         m_cache->installModule(key, output_path, m_options.ir_stdout_fd))) {
+        std::fwrite(result.out.data(), 1, result.out.size(), Console::out());
+        std::fwrite(result.err.data(), 1, result.err.size(), Console::err());
+        return result.status;
+    }
+
+    // On a miss, what the passes print is captured to go into the entry as
+    // well. Unlike in a plain compilation, everything on stdout comes
+    // before everything on stderr.
+    std::string module_path;
+    const int module_fd = m_cache->createModuleFile(module_path);
+    char *out_data = nullptr;
+    char *err_data = nullptr;
+    size_t out_size = 0;
+    size_t err_size = 0;
+    FILE *out = open_memstream(&out_data, &out_size);
+    FILE *err = open_memstream(&err_data, &err_size);
+    assert(out && err && "Failed to capture the output");
+
+    bool is_module_copied;
+    {
+        Console::Scope console_scope(out, err);
+        result.status = runPasses(p_context, module_fd, result.has_module,
+                                  is_module_copied);
+    }
+    std::fclose(out);
+    std::fclose(err);
+    result.out.assign(out_data, out_size);
+    result.err.assign(err_data, err_size);
+    std::free(out_data);
+    std::free(err_data);
+
+    std::fwrite(result.out.data(), 1, result.out.size(), Console::out());
+    std::fwrite(result.err.data(), 1, result.err.size(), Console::err());
+
+    if (module_fd >= 0) {
+        close(module_fd);
+        if (!result.has_module || is_module_copied) {
+            m_cache->store(key, result, module_path);
+        } else {
+            unlink(module_path.c_str());
+        }
+    }
+    return result.status;
+}
+
+int Driver::runPasses(CompilationContext &p_context, const int p_module_copy_fd,
+                      bool &p_has_module, bool &p_is_module_copied) const {
+    if (!m_options.time_report) {
+        return runPasses(p_context, nullptr, p_module_copy_fd, p_has_module,
+                         p_is_module_copied);
+    }
+
+    TimeReport time_report;
+    p_context.getScannerState().time_report = &time_report;
+    const int status = runPasses(p_context, &time_report, p_module_copy_fd,
+                                 p_has_module, p_is_module_copied);
+    p_context.getScannerState().time_report = nullptr;
+
+    auto &counts = time_report.getCounts();
+    counts.source_bytes = p_context.getSource().getSize();
+    counts.num_tokens = p_context.getScannerState().num_tokens;
+    counts.num_ast_nodes = p_context.getArena().getNumAllocations();
+    if (m_options.time_report_json) {
+        time_report.printJson(Console::err(), p_context.getSourcePath());
+    } else {
+        time_report.print(Console::err(), p_context.getSourcePath());
+    }
+    return status;
+}
+
+int Driver::runPasses(CompilationContext &p_context,
+                      TimeReport *p_time_report, const int p_module_copy_fd,
+                      bool &p_has_module, bool &p_is_module_copied) const {
+    using PhaseEnum = TimeReport::PhaseEnum;
+    p_has_module = p_is_module_copied = false;
+
+    if (m_options.quiet) {
+        // the pseudocomments in the source may still turn them on
+        auto &state = p_context.getScannerState();
+        state.opt_src = state.opt_tok = state.opt_dmp = false;
+    }
+
+    if (m_options.lex_only) {
+        // for measuring the scanner alone, see bench/lexer_throughput.py
+        const size_t num_tokens = p_context.countTokens();
+        std::fprintf(Console::err(), "%zu tokens in %zu bytes\n", num_tokens,
+                     p_context.getSource().getSize());
+        return 0;
+    }
+
+    {
+        TimeReport::Scope time_scope(p_time_report, PhaseEnum::kParse);
+        TRACE_SPAN("driver", "parse");
+        if (!p_context.parse()) {
+            return -1;
+        }
+    }
+    ProgramNode *root = p_context.getRoot();
+
+    if (m_options.dump_ast) {
+        TimeReport::Scope time_scope(p_time_report, PhaseEnum::kDumpAst);
+        TRACE_SPAN("driver", "dump-ast");
+        AstDumper ast_dumper;
+        root->accept(ast_dumper);
+    }
+
+    SemanticAnalyzer sema_analyzer(p_context.getScannerState().opt_dmp);
+    {
+        TimeReport::Scope time_scope(p_time_report, PhaseEnum::kSema);
+        TRACE_SPAN("driver", "sema");
+        root->accept(sema_analyzer);
+    }
+    if (p_time_report) {
+        p_time_report->getCounts().num_symbols =
+            sema_analyzer.getSymbolManager()->getNumSymbols();
+    }
+
+    if (!sema_analyzer.hasError()) {
+        // codegen relies on every reference having been resolved by sema
+        int output_fd = m_options.ir_stdout_fd;
+        if (output_fd < 0) {
+            const std::string output_path =
+                getOutputPath(p_context.getSourcePath());
+            // The output may be a hard link into the compile cache, which
+            // must not be written through.
+            struct stat status;
+            if (lstat(output_path.c_str(), &status) == 0 &&
+                S_ISREG(status.st_mode) && status.st_nlink > 1) {
+                unlink(output_path.c_str());
+            }
+            output_fd = open(output_path.c_str(),
+                             O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            assert(output_fd >= 0 && "Failed to open output file");
+        }
+
+        // the loop passes need SSA form, see Optimizer
+        CodeGenerator code_generator(p_context.getSourcePath(), output_fd,
+                                     m_options.use_ssa ||
+                                         m_options.opt_level > 0);
+        code_generator.setModuleCopyFd(p_module_copy_fd);
+        OptimizerOptions optimizer_options;
+        optimizer_options.level = m_options.opt_level;
+        optimizer_options.unroll_budget = m_options.unroll_budget;
+        optimizer_options.inline_functions = !m_options.no_inline;
+        optimizer_options.inline_report = m_options.inline_report;
+        code_generator.setOptimizerOptions(optimizer_options);
+        code_generator.setTimeReport(p_time_report);
+        {
+            TimeReport::Scope time_scope(p_time_report, PhaseEnum::kCodegen);
+            TRACE_SPAN("driver", "codegen");
+            root->accept(code_generator);
+        }
+        if (p_time_report) {
+            p_time_report->getCounts().num_instructions =
+                code_generator.getNumInstructions();
+        }
+        if (output_fd != m_options.ir_stdout_fd) {
+            close(output_fd);
+        }
+        p_has_module = true;
+        p_is_module_copied = code_generator.isModuleCopied();
+
+        std::fprintf(Console::out(),
+                     "\n"
+                     "|---------------------------------------------------|\n"
+                     "|  There is no syntactic error and semantic error!  |\n"
+                     "|---------------------------------------------------|\n");
+    }
+
+    if (m_options.arena_report) {
+        std::fprintf(Console::err(),
+                     "AST arena: %zu bytes allocated, %zu bytes reserved\n",
+                     p_context.getArena().getAllocatedBytes(),
+                     p_context.getArena().getReservedBytes());
+    }
+
+    return 0;
+}
+
+// the captured output of one compilation
+struct CompileResult {
+    char *out_data = nullptr;
+    size_t out_size = 0;
+    char *err_data = nullptr;
+    size_t err_size = 0;
+    int status = 0;
+    bool is_done = false;
+};
+
+int Driver::compileAll(const std::vector<std::string> &p_source_paths) const {
+    const int status = p_source_paths.size() == 1
+                           ? compile(p_source_paths.front())
+                           : compileInParallel(p_source_paths);
+
+    if (m_tracer && !m_tracer->write(resolvePath(m_options.trace_path))) {
+        std::fprintf(Console::err(), "%s: %s\n",
+                     m_options.trace_path.c_str(), std::strerror(errno));
+    }
+    return status;
+}
+
+int Driver::compileInParallel(
+    const std::vector<std::string> &p_source_paths) const {
+
+    std::vector<CompileResult> results(p_source_paths.size());
+    std::mutex results_mutex;
+    std::condition_variable result_done;
+
+    ThreadPool pool(std::min(m_options.num_jobs, p_source_paths.size()));
+    for (size_t i = 0; i < p_source_paths.size(); ++i) {
+        pool.submit([&, i] {
+            auto &result = results[i];
+            FILE *out = open_memstream(&result.out_data, &result.out_size);
+            FILE *err = open_memstream(&result.err_data, &result.err_size);
+            assert(out && err && "Failed to capture the output");
+
+            int status;
+            {
+                Console::Scope console_scope(out, err);
+                status = compile(p_source_paths[i], true);
+            }
+            std::fclose(out);
+            std::fclose(err);
+
+            std::lock_guard<std::mutex> lock(results_mutex);
+            result.status = status;
+            result.is_done = true;
+            result_done.notify_all();
+        });
+    }
+
+    // Write each output out as soon as everything before it is done.
+    int status = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto &result = results[i];
+        {
+            std::unique_lock<std::mutex> lock(results_mutex);
+            result_done.wait(lock, [&result] { return result.is_done; });
+        }
+
+        std::fwrite(result.out_data, 1, result.out_size, Console::out());
+        std::fflush(Console::out());
+        if (result.err_size) {
+            // the diagnostics themselves do not name the source
+            std::fprintf(Console::err(), "In %s:\n",
+                         p_source_paths[i].c_str());
+            std::fwrite(result.err_data, 1, result.err_size, Console::err());
+        }
+        std::free(result.out_data);
+        std::free(result.err_data);
+
+        if (result.status != 0) {
+            status = result.status;
+        }
+    }
+    return status;
+}
+
+void Driver::printCacheStatistics() const {
+    if (!m_cache) {
+        std::fprintf(Console::err(), "compile cache: none, see --cache-dir\n");
+        return;
+    }
+
+    const auto statistics = m_cache->getStatistics();
+    const uint64_t num_lookups = statistics.hits + statistics.misses;
+    std::fprintf(
+        Console::err(),
+        "compile cache %s:\n"
+        "  %llu hits, %llu misses (%.1f%% hits)\n"
+        "  %llu stores, %llu evictions\n"
+        "  %llu entries, %.1f of %.1f MiB\n",
+        m_cache->getDirectory().c_str(),
+        static_cast<unsigned long long>(statistics.hits),
+        static_cast<unsigned long long>(statistics.misses),
+        num_lookups ? 100.0 * statistics.hits / num_lookups : 0.0,
+        static_cast<unsigned long long>(statistics.stores),
+        static_cast<unsigned long long>(statistics.evictions),
+        static_cast<unsigned long long>(statistics.num_entries),
+        statistics.size_bytes / 1048576.0,
+        m_cache->getMaxBytes() / 1048576.0);
+}
@@ -0,0 +1,193 @@
+#include "driver/Server.hpp"
+#include "AST/Console.hpp"
+#include "driver/Driver.hpp"
+#include "driver/ServerProtocol.hpp"
+#include "driver/ThreadPool.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+static bool readFully(const int p_fd, char *p_data, size_t p_size) {
+    while (p_size) {
+        const ssize_t n = read(p_fd, p_data, p_size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p_data += n;
+        p_size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool writeFully(const int p_fd, const char *p_data, size_t p_size) {
+    while (p_size) {
+        const ssize_t n = write(p_fd, p_data, p_size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return false;
+        }
+        p_data += n;
+        p_size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Receives the payload of a request and the stdout and stderr of the
+// client; the file descriptors are only valid if it returns true.
+static bool receiveRequest(const int p_fd, std::vector<char> &p_payload,
+                           int (&p_client_fds)[2]) {
+    uint32_t size;
+    char control[CMSG_SPACE(sizeof(p_client_fds))];
+    iovec iov{&size, sizeof(size)};
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t n;
+    do {
+        n = recvmsg(p_fd, &message, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+
+    const cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET ||
+        cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(sizeof(p_client_fds))) {
+        return false;
+    }
+    std::memcpy(p_client_fds, CMSG_DATA(cmsg), sizeof(p_client_fds));
+
+    // the rest of the request may arrive separately
+    if ((static_cast<size_t>(n) < sizeof(size) &&
+         !readFully(p_fd, reinterpret_cast<char *>(&size) + n,
+                    sizeof(size) - n)) ||
+        size > kMaxRequestSize) {
+        close(p_client_fds[0]);
+        close(p_client_fds[1]);
+        return false;
+    }
+
+    p_payload.resize(size);
+    if (!readFully(p_fd, p_payload.data(), size)) {
+        close(p_client_fds[0]);
+        close(p_client_fds[1]);
+        return false;
+    }
+    return true;
+}
+
+Server::~Server() {
+    if (m_listen_fd >= 0) {
+        close(m_listen_fd);
+        unlink(m_socket_path.c_str());
+    }
+}
+
+bool Server::run() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (m_socket_path.size() >= sizeof(address.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    std::strcpy(address.sun_path, m_socket_path.c_str());
+
+    // a client that goes away must not take the server with it
+    std::signal(SIGPIPE, SIG_IGN);
+
+    m_listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listen_fd < 0) {
+        return false;
+    }
+    // a socket left behind by a server that was killed
+    unlink(m_socket_path.c_str());
+    if (bind(m_listen_fd, reinterpret_cast<const sockaddr *>(&address),
+             sizeof(address)) < 0 ||
+        listen(m_listen_fd, SOMAXCONN) < 0) {
+        return false;
+    }
+
+    ThreadPool pool(m_num_threads);
+    while (true) {
+        const int connection_fd = accept4(m_listen_fd, nullptr, nullptr,
+                                          SOCK_CLOEXEC);
+        if (connection_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return false;
+        }
+        pool.submit([this, connection_fd] { serve(connection_fd); });
+    }
+}
+
+void Server::serve(const int p_connection_fd) const {
+    std::vector<char> payload;
+    int client_fds[2];
+    if (!receiveRequest(p_connection_fd, payload, client_fds)) {
+        close(p_connection_fd);
+        return;
+    }
+
+    std::vector<std::string> strings;
+    for (size_t begin = 0, end; begin < payload.size(); begin = end + 1) {
+        end = begin;
+        while (end < payload.size() && payload[end] != '\0') {
+            ++end;
+        }
+        strings.emplace_back(&payload[begin], end - begin);
+    }
+
+    FILE *out = fdopen(client_fds[0], "w");
+    FILE *err = fdopen(client_fds[1], "w");
+
+    int32_t status = -1;
+    DriverOptions options;
+    std::vector<std::string> source_paths;
+    if (strings.empty() || payload.back() != '\0' ||
+        !Driver::parseArguments(
+            std::vector<std::string>(strings.begin() + 1, strings.end()),
+            options, source_paths) ||
+        !options.serve_socket_path.empty()) {
+        std::fprintf(err, "compiler: invalid arguments, run ./compiler "
+                          "without any to see the usage\n");
+    } else {
+        options.working_directory = strings.front();
+
+        // "-o -" as in main(): the module goes to the stdout of the client
+        // and everything else to its stderr
+        FILE *listing = out;
+        if (options.output_path == "-") {
+            std::fflush(out);
+            options.ir_stdout_fd = dup(client_fds[0]);
+            listing = err;
+        }
+
+        Console::Scope console_scope(listing, err);
+        status = Driver(options, true).compileAll(source_paths);
+        if (options.ir_stdout_fd >= 0) {
+            close(options.ir_stdout_fd);
+        }
+    }
+
+    std::fclose(out);
+    std::fclose(err);
+    writeFully(p_connection_fd, reinterpret_cast<const char *>(&status),
+               sizeof(status));
+    close(p_connection_fd);
+}
@@ -0,0 +1,134 @@
+#include "driver/Sha256.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static const uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static inline uint32_t rotateRight(const uint32_t value, const int count) {
+    return (value >> count) | (value << (32 - count));
+}
+
+Sha256::Sha256()
+    : m_state{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+              0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19} {}
+
+void Sha256::processBlock(const uint8_t *p_block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = static_cast<uint32_t>(p_block[4 * i]) << 24 |
+               static_cast<uint32_t>(p_block[4 * i + 1]) << 16 |
+               static_cast<uint32_t>(p_block[4 * i + 2]) << 8 |
+               static_cast<uint32_t>(p_block[4 * i + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+        const uint32_t s0 = rotateRight(w[i - 15], 7) ^
+                            rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = rotateRight(w[i - 2], 17) ^
+                            rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    uint32_t e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+    for (int i = 0; i < 64; ++i) {
+        const uint32_t s1 =
+            rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+        const uint32_t choice = (e & f) ^ (~e & g);
+        const uint32_t t1 = h + s1 + choice + kRoundConstants[i] + w[i];
+        const uint32_t s0 =
+            rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+        const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        const uint32_t t2 = s0 + majority;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+    m_state[4] += e;
+    m_state[5] += f;
+    m_state[6] += g;
+    m_state[7] += h;
+}
+
+Sha256 &Sha256::update(const void *p_data, size_t p_size) {
+    const auto *data = static_cast<const uint8_t *>(p_data);
+    m_total_size += p_size;
+
+    if (m_block_size) {
+        const size_t length = std::min(p_size, sizeof(m_block) - m_block_size);
+        std::memcpy(m_block + m_block_size, data, length);
+        m_block_size += length;
+        data += length;
+        p_size -= length;
+        if (m_block_size < sizeof(m_block)) {
+            return *this;
+        }
+        processBlock(m_block);
+        m_block_size = 0;
+    }
+
+    for (; p_size >= sizeof(m_block); p_size -= sizeof(m_block)) {
+        processBlock(data);
+        data += sizeof(m_block);
+    }
+    std::memcpy(m_block, data, p_size);
+    m_block_size = p_size;
+    return *this;
+}
+
+Sha256::Digest Sha256::finish() {
+    const uint64_t total_bits = m_total_size * 8;
+
+    // a single 1 bit, zeros up to 56 bytes into a block, the length in bits
+    static const uint8_t kPadding[64] = {0x80};
+    const size_t padding_size = (m_block_size < 56 ? 56 : 120) - m_block_size;
+    update(kPadding, padding_size);
+    uint8_t length[8];
+    for (int i = 0; i < 8; ++i) {
+        length[i] = static_cast<uint8_t>(total_bits >> (56 - 8 * i));
+    }
+    update(length, sizeof(length));
+
+    Digest digest;
+    for (int i = 0; i < 8; ++i) {
+        digest[4 * i] = static_cast<uint8_t>(m_state[i] >> 24);
+        digest[4 * i + 1] = static_cast<uint8_t>(m_state[i] >> 16);
+        digest[4 * i + 2] = static_cast<uint8_t>(m_state[i] >> 8);
+        digest[4 * i + 3] = static_cast<uint8_t>(m_state[i]);
+    }
+    return digest;
+}
+
+std::string Sha256::toString(const Digest &p_digest) {
+    static const char kHexDigits[] = "0123456789abcdef";
+
+    std::string str;
+    str.reserve(2 * p_digest.size());
+    for (const uint8_t byte : p_digest) {
+        str += kHexDigits[byte >> 4];
+        str += kHexDigits[byte & 0xf];
+    }
+    return str;
+}
@@ -0,0 +1,106 @@
+#include "driver/ThreadPool.hpp"
+
+#include <cassert>
+
+ThreadPool::ThreadPool(const size_t p_num_threads) {
+    assert(p_num_threads > 0 && "A thread pool needs at least one thread");
+
+    for (size_t i = 0; i < p_num_threads; ++i) {
+        m_workers.emplace_back(new Worker);
+    }
+    for (size_t i = 0; i < p_num_threads; ++i) {
+        m_threads.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_stopping = true;
+    }
+    m_wake_up.notify_all();
+
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::getDefaultSize() {
+    const size_t size = std::thread::hardware_concurrency();
+    return size ? size : 1;
+}
+
+void ThreadPool::submit(Task p_task) {
+    {
+        // The task is queued under m_mutex, so that a worker cannot check
+        // m_num_queued between the two and go to sleep on it.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto &worker = *m_workers[m_next_worker];
+        m_next_worker = (m_next_worker + 1) % m_workers.size();
+
+        std::lock_guard<std::mutex> worker_lock(worker.mutex);
+        worker.tasks.push_back(std::move(p_task));
+        ++m_num_queued;
+        ++m_num_unfinished;
+    }
+    m_wake_up.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_all_done.wait(lock, [this] { return m_num_unfinished == 0; });
+}
+
+bool ThreadPool::takeTask(const size_t p_worker_index, Task &p_task) {
+    // the oldest task first: the results are printed in the order of the
+    // inputs, so a late first input holds all of them back
+    {
+        auto &own = *m_workers[p_worker_index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            p_task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < m_workers.size(); ++i) {
+        auto &victim = *m_workers[(p_worker_index + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            p_task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(const size_t p_worker_index) {
+    Task task;
+    while (true) {
+        if (takeTask(p_worker_index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_num_queued;
+            }
+            task();
+            task = nullptr;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_num_unfinished == 0) {
+                m_all_done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake_up.wait(lock, [this] {
+            return m_num_queued > 0 || m_is_stopping;
+        });
+        if (m_num_queued == 0) {
+            // stopping and nothing left to do
+            return;
+        }
+    }
+}
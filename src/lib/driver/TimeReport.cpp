@@ -0,0 +1,201 @@
+#include "driver/TimeReport.hpp"
+#include "driver/AllocationCounter.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <sys/resource.h>
+#include <time.h>
+
+static uint64_t getMonotonicTime() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+// The high-water mark of the address space, which starts over at exec()
+// unlike ru_maxrss, that would report the RSS of whatever ran the compiler.
+static long getPeakRss() {
+    FILE *status = std::fopen("/proc/self/status", "r");
+    if (status) {
+        char line[128];
+        long peak_rss = 0;
+        while (std::fgets(line, sizeof(line), status)) {
+            if (std::sscanf(line, "VmHWM: %ld", &peak_rss) == 1) {
+                break;
+            }
+        }
+        std::fclose(status);
+        if (peak_rss) {
+            return peak_rss;
+        }
+    }
+
+    rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+}
+
+TimeReport::Scope::Scope(TimeReport *p_report, const PhaseEnum p_phase,
+                         const bool p_samples_rss)
+    : m_report(p_report), m_phase(p_phase), m_samples_rss(p_samples_rss),
+      m_parent(nullptr) {
+    if (!m_report) {
+        return;
+    }
+    m_parent = m_report->m_current_scope;
+    m_report->m_current_scope = this;
+    m_start_allocations = AllocationCounter::getNumAllocations();
+    m_start_bytes = AllocationCounter::getAllocatedBytes();
+    // last, so that the above is not timed
+    m_start_ns = getMonotonicTime();
+}
+
+TimeReport::Scope::~Scope() {
+    if (!m_report) {
+        return;
+    }
+    const uint64_t time_ns = getMonotonicTime() - m_start_ns;
+    const uint64_t num_allocations =
+        AllocationCounter::getNumAllocations() - m_start_allocations;
+    const uint64_t allocated_bytes =
+        AllocationCounter::getAllocatedBytes() - m_start_bytes;
+    assert(m_report->m_current_scope == this &&
+           "Scopes of a TimeReport should nest");
+    m_report->m_current_scope = m_parent;
+
+    auto &phase = m_report->m_phases[static_cast<size_t>(m_phase)];
+    phase.is_run = true;
+    phase.time_ns += time_ns;
+    phase.num_allocations += num_allocations;
+    phase.allocated_bytes += allocated_bytes;
+    if (m_samples_rss) {
+        phase.peak_rss = getPeakRss();
+    }
+
+    // The enclosing phase adds all of its time when it ends, this part
+    // included. The counters wrap around in between, but end up right.
+    if (m_parent) {
+        auto &parent =
+            m_report->m_phases[static_cast<size_t>(m_parent->m_phase)];
+        parent.time_ns -= time_ns;
+        parent.num_allocations -= num_allocations;
+        parent.allocated_bytes -= allocated_bytes;
+    }
+}
+
+const char *TimeReport::getPhaseName(const PhaseEnum p_phase) {
+    switch (p_phase) {
+    case PhaseEnum::kLex:
+        return "lex";
+    case PhaseEnum::kParse:
+        return "parse";
+    case PhaseEnum::kDumpAst:
+        return "dump-ast";
+    case PhaseEnum::kSema:
+        return "sema";
+    case PhaseEnum::kCodegen:
+        return "codegen";
+    case PhaseEnum::kOptimize:
+        return "optimize";
+    default:
+        assert(false && "Invalid phase");
+        return "";
+    }
+}
+
+static void printRow(FILE *p_out, const char *p_name,
+                     const TimeReport::Phase &p_phase,
+                     const uint64_t p_total_ns) {
+    std::fprintf(p_out, "  %-9s %10.3f %6.1f %12llu %12llu ", p_name,
+                 p_phase.time_ns / 1e6,
+                 p_total_ns ? 100.0 * p_phase.time_ns / p_total_ns : 0.0,
+                 static_cast<unsigned long long>(p_phase.num_allocations),
+                 static_cast<unsigned long long>(p_phase.allocated_bytes));
+    if (p_phase.peak_rss) {
+        std::fprintf(p_out, "%6ld KiB\n", p_phase.peak_rss);
+    } else {
+        std::fprintf(p_out, "%10s\n", "-");
+    }
+}
+
+void TimeReport::print(FILE *p_out, const std::string &p_source_path) const {
+    std::fprintf(p_out,
+                 "time report for %s:\n"
+                 "  %-9s %10s %6s %12s %12s %10s\n",
+                 p_source_path.c_str(), "phase", "time (ms)", "%", "allocations",
+                 "bytes", "peak RSS");
+
+    uint64_t total_ns = 0;
+    for (const auto &phase : m_phases) {
+        total_ns += phase.time_ns;
+    }
+    Phase total;
+    for (size_t i = 0; i < static_cast<size_t>(PhaseEnum::kNumPhases); ++i) {
+        const auto &phase = m_phases[i];
+        if (!phase.is_run) {
+            continue;
+        }
+        printRow(p_out, getPhaseName(static_cast<PhaseEnum>(i)), phase,
+                 total_ns);
+        total.time_ns += phase.time_ns;
+        total.num_allocations += phase.num_allocations;
+        total.allocated_bytes += phase.allocated_bytes;
+        total.peak_rss = std::max(total.peak_rss, phase.peak_rss);
+    }
+    printRow(p_out, "total", total, total_ns);
+
+    const double total_s = total_ns / 1e9;
+    std::fprintf(p_out,
+                 "  %zu bytes of source, %zu tokens (%.0f/s), %zu AST nodes, "
+                 "%zu symbols, %zu instructions\n",
+                 m_counts.source_bytes, m_counts.num_tokens,
+                 total_s > 0 ? m_counts.num_tokens / total_s : 0.0,
+                 m_counts.num_ast_nodes, m_counts.num_symbols,
+                 m_counts.num_instructions);
+}
+
+// enough for paths, which have no control characters in practice
+static void printJsonString(FILE *p_out, const std::string &p_string) {
+    std::fputc('"', p_out);
+    for (const char c : p_string) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', p_out);
+        }
+        std::fputc(c, p_out);
+    }
+    std::fputc('"', p_out);
+}
+
+void TimeReport::printJson(FILE *p_out,
+                           const std::string &p_source_path) const {
+    std::fprintf(p_out, "{\"source\": ");
+    printJsonString(p_out, p_source_path);
+    std::fprintf(p_out, ", \"phases\": [");
+
+    const char *separator = "";
+    for (size_t i = 0; i < static_cast<size_t>(PhaseEnum::kNumPhases); ++i) {
+        const auto &phase = m_phases[i];
+        if (!phase.is_run) {
+            continue;
+        }
+        std::fprintf(p_out,
+                     "%s{\"name\": \"%s\", \"time_ns\": %llu, "
+                     "\"allocations\": %llu, \"allocated_bytes\": %llu",
+                     separator, getPhaseName(static_cast<PhaseEnum>(i)),
+                     static_cast<unsigned long long>(phase.time_ns),
+                     static_cast<unsigned long long>(phase.num_allocations),
+                     static_cast<unsigned long long>(phase.allocated_bytes));
+        if (phase.peak_rss) {
+            std::fprintf(p_out, ", \"peak_rss_kib\": %ld", phase.peak_rss);
+        }
+        std::fprintf(p_out, "}");
+        separator = ", ";
+    }
+
+    std::fprintf(p_out,
+                 "], \"counts\": {\"source_bytes\": %zu, \"tokens\": %zu, "
+                 "\"ast_nodes\": %zu, \"symbols\": %zu, "
+                 "\"instructions\": %zu}}\n",
+                 m_counts.source_bytes, m_counts.num_tokens,
+                 m_counts.num_ast_nodes, m_counts.num_symbols,
+                 m_counts.num_instructions);
+}
@@ -0,0 +1,337 @@
+#include "opt/ConstantPropagation.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using Opcode = IrInstruction::OpcodeEnum;
+using Predicate = IrInstruction::PredicateEnum;
+
+static const IrConstantInt *asConstant(const IrValue *p_value) {
+    if (p_value->getKind() != IrValue::KindEnum::kConstantInt) {
+        return nullptr;
+    }
+    return static_cast<const IrConstantInt *>(p_value);
+}
+
+// i1 true is -1 when compared as a signed integer
+static int64_t getSignedValue(const IrConstantInt &p_constant) {
+    if (p_constant.getType()->getBits() == 1) {
+        return -p_constant.getValue();
+    }
+    return p_constant.getValue();
+}
+
+static bool isConstant(const IrValue *p_value, const int64_t value) {
+    const auto *constant = asConstant(p_value);
+    return constant && constant->getValue() == value;
+}
+
+bool ConstantPropagation::run(IrFunction &p_function) {
+    std::unordered_map<IrValue *, IrValue *> replacements;
+    auto resolve = [&](IrValue *p_value) {
+        for (auto search = replacements.find(p_value);
+             search != replacements.end();
+             search = replacements.find(p_value)) {
+            p_value = search->second;
+        }
+        return p_value;
+    };
+
+    bool is_changed = false;
+    for (const auto &block : p_function.getBasicBlocks()) {
+        for (const auto &inst : block->getInstructions()) {
+            for (size_t i = 0; i < inst->getOperands().size(); ++i) {
+                inst->setOperand(i, resolve(inst->getOperand(i)));
+            }
+            is_changed |= reassociate(*inst);
+            if (auto *value = fold(*inst)) {
+                replacements[inst.get()] = value;
+            }
+        }
+    }
+    // values used before their definition in the layout, by phis
+    p_function.replaceAllUsesWith(replacements);
+
+    is_changed |= !replacements.empty();
+    std::vector<IrInstruction *> branches;
+    for (const auto &block : p_function.getBasicBlocks()) {
+        auto *terminator = block->getTerminator();
+        if (terminator && terminator->getOpcode() == Opcode::kCondBr) {
+            branches.emplace_back(terminator);
+        }
+    }
+    for (auto *branch : branches) {
+        is_changed |= foldBranch(p_function, branch);
+    }
+    return is_changed;
+}
+
+IrValue *ConstantPropagation::fold(const IrInstruction &p_inst) {
+    switch (p_inst.getOpcode()) {
+    case Opcode::kAdd:
+    case Opcode::kSub:
+    case Opcode::kMul:
+    case Opcode::kSDiv:
+    case Opcode::kSRem:
+    case Opcode::kAnd:
+    case Opcode::kOr:
+    case Opcode::kXor:
+        return foldBinary(p_inst);
+    case Opcode::kICmp:
+        return foldICmp(p_inst);
+    case Opcode::kPhi:
+        return foldPhi(p_inst);
+    case Opcode::kGetElementPtr:
+        // p + 0, e.g. the initial address of a[i] for i from 0
+        if (p_inst.getOperands().size() == 2 &&
+            isConstant(p_inst.getOperand(1), 0)) {
+            return p_inst.getOperand(0);
+        }
+        return nullptr;
+    default:
+        return nullptr;
+    }
+}
+
+IrValue *ConstantPropagation::foldBinary(const IrInstruction &p_inst) {
+    const auto *type = p_inst.getType();
+    IrValue *lhs = p_inst.getOperand(0);
+    IrValue *rhs = p_inst.getOperand(1);
+    const auto *lhs_constant = asConstant(lhs);
+    const auto *rhs_constant = asConstant(rhs);
+
+    if (lhs_constant && rhs_constant) {
+        const int64_t x = lhs_constant->getValue();
+        const int64_t y = rhs_constant->getValue();
+        int64_t result = 0;
+        switch (p_inst.getOpcode()) {
+        case Opcode::kAdd:
+            result = x + y;
+            break;
+        case Opcode::kSub:
+            result = x - y;
+            break;
+        case Opcode::kMul:
+            result = x * y;
+            break;
+        case Opcode::kSDiv:
+        case Opcode::kSRem:
+            // not defined, leave it to run time like the code generator
+            if (y == 0 || (x == INT32_MIN && y == -1)) {
+                return nullptr;
+            }
+            result = p_inst.getOpcode() == Opcode::kSDiv ? x / y : x % y;
+            break;
+        case Opcode::kAnd:
+            result = x & y;
+            break;
+        case Opcode::kOr:
+            result = x | y;
+            break;
+        case Opcode::kXor:
+            result = x ^ y;
+            break;
+        default:
+            return nullptr;
+        }
+        // wrap around to the width of the type
+        if (type->getBits() == 1) {
+            result &= 1;
+        } else {
+            result = static_cast<int32_t>(static_cast<uint32_t>(result));
+        }
+        return m_module.getConstantInt(type, result);
+    }
+
+    const bool is_bool = type->getBits() == 1;
+    switch (p_inst.getOpcode()) {
+    case Opcode::kAdd:
+        if (isConstant(rhs, 0)) {
+            return lhs;
+        }
+        if (isConstant(lhs, 0)) {
+            return rhs;
+        }
+        break;
+    case Opcode::kSub:
+        if (isConstant(rhs, 0)) {
+            return lhs;
+        }
+        if (lhs == rhs) {
+            return m_module.getConstantInt(type, 0);
+        }
+        break;
+    case Opcode::kMul:
+        if (isConstant(rhs, 1)) {
+            return lhs;
+        }
+        if (isConstant(lhs, 1)) {
+            return rhs;
+        }
+        if (isConstant(lhs, 0) || isConstant(rhs, 0)) {
+            return m_module.getConstantInt(type, 0);
+        }
+        break;
+    case Opcode::kSDiv:
+        if (isConstant(rhs, 1)) {
+            return lhs;
+        }
+        break;
+    case Opcode::kSRem:
+        if (isConstant(rhs, 1)) {
+            return m_module.getConstantInt(type, 0);
+        }
+        break;
+    case Opcode::kAnd:
+    case Opcode::kOr:
+        if (lhs == rhs) {
+            return lhs;
+        }
+        if (is_bool) {
+            // x and true, x or false
+            const bool is_and = p_inst.getOpcode() == Opcode::kAnd;
+            if (isConstant(rhs, is_and)) {
+                return lhs;
+            }
+            if (isConstant(lhs, is_and)) {
+                return rhs;
+            }
+            // x and false, x or true
+            if (isConstant(rhs, !is_and)) {
+                return rhs;
+            }
+            if (isConstant(lhs, !is_and)) {
+                return lhs;
+            }
+        }
+        break;
+    case Opcode::kXor:
+        if (isConstant(rhs, 0)) {
+            return lhs;
+        }
+        if (isConstant(lhs, 0)) {
+            return rhs;
+        }
+        if (lhs == rhs) {
+            return m_module.getConstantInt(type, 0);
+        }
+        break;
+    default:
+        break;
+    }
+    return nullptr;
+}
+
+IrValue *ConstantPropagation::foldICmp(const IrInstruction &p_inst) {
+    const auto *lhs_constant = asConstant(p_inst.getOperand(0));
+    const auto *rhs_constant = asConstant(p_inst.getOperand(1));
+    const auto predicate = p_inst.getPredicate();
+
+    bool result = false;
+    if (lhs_constant && rhs_constant) {
+        const int64_t x = getSignedValue(*lhs_constant);
+        const int64_t y = getSignedValue(*rhs_constant);
+        switch (predicate) {
+        case Predicate::kEq:
+            result = x == y;
+            break;
+        case Predicate::kNe:
+            result = x != y;
+            break;
+        case Predicate::kSlt:
+            result = x < y;
+            break;
+        case Predicate::kSle:
+            result = x <= y;
+            break;
+        case Predicate::kSgt:
+            result = x > y;
+            break;
+        case Predicate::kSge:
+            result = x >= y;
+            break;
+        }
+    } else if (p_inst.getOperand(0) == p_inst.getOperand(1)) {
+        result = predicate == Predicate::kEq || predicate == Predicate::kSle ||
+                 predicate == Predicate::kSge;
+    } else {
+        return nullptr;
+    }
+    return m_module.getConstantInt(p_inst.getType(), result);
+}
+
+IrValue *ConstantPropagation::foldPhi(const IrInstruction &p_inst) {
+    IrValue *same = nullptr;
+    for (size_t i = 0; i < p_inst.getOperands().size(); i += 2) {
+        IrValue *value = p_inst.getOperand(i);
+        if (value == same || value == &p_inst) {
+            continue;
+        }
+        if (same) {
+            return nullptr;
+        }
+        same = value;
+    }
+    return same;
+}
+
+bool ConstantPropagation::foldBranch(IrFunction &p_function,
+                                     IrInstruction *const p_branch) {
+    auto *block = p_branch->getParent();
+    auto *true_block = static_cast<IrBasicBlock *>(p_branch->getOperand(1));
+    auto *false_block = static_cast<IrBasicBlock *>(p_branch->getOperand(2));
+
+    IrBasicBlock *target = nullptr;
+    IrBasicBlock *dropped = nullptr;
+    if (true_block == false_block) {
+        target = dropped = true_block;
+    } else if (const auto *condition = asConstant(p_branch->getOperand(0))) {
+        target = condition->getValue() ? true_block : false_block;
+        dropped = condition->getValue() ? false_block : true_block;
+    } else {
+        return false;
+    }
+
+    dropped->removePredecessor(block);
+    p_function.eraseInstruction(p_branch);
+    block->append(new IrInstruction(Opcode::kBr, p_branch->getType(),
+                                    {target}));
+    return true;
+}
+
+bool ConstantPropagation::reassociate(IrInstruction &p_inst) {
+    if (p_inst.getOpcode() != Opcode::kAdd) {
+        return false;
+    }
+    for (size_t i = 0; i < 2; ++i) {
+        const auto *outer = asConstant(p_inst.getOperand(1 - i));
+        auto *operand = p_inst.getOperand(i);
+        if (!outer || operand->getKind() != IrValue::KindEnum::kInstruction) {
+            continue;
+        }
+        const auto *add = static_cast<const IrInstruction *>(operand);
+        if (add->getOpcode() != Opcode::kAdd) {
+            continue;
+        }
+        for (size_t j = 0; j < 2; ++j) {
+            const auto *inner = asConstant(add->getOperand(1 - j));
+            if (!inner) {
+                continue;
+            }
+            // with both of the same sign, x + (c1 + c2) overflows only if
+            // (x + c1) + c2 does, so nsw still holds
+            const int64_t x = inner->getValue();
+            const int64_t y = outer->getValue();
+            const int64_t sum = x + y;
+            if ((x < 0) != (y < 0) || sum < INT32_MIN || sum > INT32_MAX) {
+                return false;
+            }
+            p_inst.setOperand(0, add->getOperand(j));
+            p_inst.setOperand(1,
+                              m_module.getConstantInt(p_inst.getType(), sum));
+            return true;
+        }
+    }
+    return false;
+}
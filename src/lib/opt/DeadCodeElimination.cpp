@@ -0,0 +1,142 @@
+#include "opt/DeadCodeElimination.hpp"
+#include "opt/MemoryAnalysis.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using Opcode = IrInstruction::OpcodeEnum;
+
+bool DeadCodeElimination::run(IrFunction &p_function) {
+    bool is_changed = removeUnreachableBlocks(p_function);
+    is_changed |= mergeBlocks(p_function);
+    is_changed |= removeDeadInstructions(p_function);
+    return is_changed;
+}
+
+bool DeadCodeElimination::removeUnreachableBlocks(IrFunction &p_function) {
+    std::unordered_set<IrBasicBlock *> reachable{p_function.getEntryBlock()};
+    std::vector<IrBasicBlock *> worklist{p_function.getEntryBlock()};
+    while (!worklist.empty()) {
+        auto *block = worklist.back();
+        worklist.pop_back();
+        for (auto *successor : block->getSuccessors()) {
+            if (reachable.insert(successor).second) {
+                worklist.emplace_back(successor);
+            }
+        }
+    }
+    if (reachable.size() == p_function.getBasicBlocks().size()) {
+        return false;
+    }
+
+    std::unordered_set<IrBasicBlock *> unreachable;
+    for (const auto &block : p_function.getBasicBlocks()) {
+        if (reachable.count(block.get())) {
+            continue;
+        }
+        for (auto *successor : block->getSuccessors()) {
+            if (reachable.count(successor)) {
+                successor->removePredecessor(block.get());
+            }
+        }
+        unreachable.insert(block.get());
+    }
+    p_function.eraseBasicBlocks(unreachable);
+    return true;
+}
+
+bool DeadCodeElimination::mergeBlocks(IrFunction &p_function) {
+    std::unordered_map<IrValue *, IrValue *> replacements;
+    std::unordered_set<IrBasicBlock *> merged;
+
+    std::vector<IrBasicBlock *> blocks;
+    for (const auto &block : p_function.getBasicBlocks()) {
+        blocks.emplace_back(block.get());
+    }
+    for (auto *block : blocks) {
+        if (merged.count(block)) {
+            continue;
+        }
+        for (auto *branch = block->getTerminator();
+             branch && branch->getOpcode() == Opcode::kBr;
+             branch = block->getTerminator()) {
+            auto *next = static_cast<IrBasicBlock *>(branch->getOperand(0));
+            if (next == block || next == p_function.getEntryBlock() ||
+                next->getPredecessors().size() != 1) {
+                break;
+            }
+
+            // with a single predecessor, the phis have a single value
+            while (!next->empty() &&
+                   next->getInstructions().front()->isPhi()) {
+                auto *phi = next->getInstructions().front().get();
+                replacements[phi] = phi->getOperand(0);
+                p_function.eraseInstruction(phi);
+            }
+            p_function.eraseInstruction(branch);
+            block->splice(next);
+            for (auto *successor : block->getSuccessors()) {
+                successor->replacePredecessor(next, block);
+            }
+            merged.insert(next);
+        }
+    }
+
+    p_function.eraseBasicBlocks(merged);
+    p_function.replaceAllUsesWith(replacements);
+    return !merged.empty();
+}
+
+bool DeadCodeElimination::removeDeadInstructions(IrFunction &p_function) {
+    const MemoryAnalysis memory(p_function);
+
+    std::unordered_set<IrInstruction *> live;
+    std::vector<IrInstruction *> worklist;
+    auto mark = [&](IrValue *p_value) {
+        if (p_value->getKind() != IrValue::KindEnum::kInstruction) {
+            return;
+        }
+        auto *inst = static_cast<IrInstruction *>(p_value);
+        if (live.insert(inst).second) {
+            worklist.emplace_back(inst);
+        }
+    };
+
+    size_t num_instructions = 0;
+    for (const auto &block : p_function.getBasicBlocks()) {
+        num_instructions += block->getInstructions().size();
+        for (const auto &inst : block->getInstructions()) {
+            if (!inst->hasSideEffects()) {
+                continue;
+            }
+            // nothing reads what is stored there
+            if (inst->getOpcode() == Opcode::kStore &&
+                !memory.isLoaded(MemoryAnalysis::getBase(inst->getOperand(1)))) {
+                continue;
+            }
+            mark(inst.get());
+        }
+    }
+    while (!worklist.empty()) {
+        auto *inst = worklist.back();
+        worklist.pop_back();
+        for (auto *operand : inst->getOperands()) {
+            mark(operand);
+        }
+    }
+    if (live.size() == num_instructions) {
+        return false;
+    }
+
+    std::unordered_set<IrInstruction *> dead;
+    for (const auto &block : p_function.getBasicBlocks()) {
+        for (const auto &inst : block->getInstructions()) {
+            if (!live.count(inst.get())) {
+                dead.insert(inst.get());
+            }
+        }
+    }
+    p_function.eraseInstructions(dead);
+    return true;
+}
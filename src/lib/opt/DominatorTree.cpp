@@ -0,0 +1,82 @@
+#include "opt/DominatorTree.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <unordered_set>
+#include <utility>
+
+DominatorTree::DominatorTree(const IrFunction &p_function) {
+    // post order without recursion, the depth of a CFG is not bounded
+    std::vector<IrBasicBlock *> post_order;
+    std::unordered_set<IrBasicBlock *> visited{p_function.getEntryBlock()};
+    std::vector<std::pair<IrBasicBlock *, std::vector<IrBasicBlock *>>> stack;
+    stack.emplace_back(p_function.getEntryBlock(),
+                       p_function.getEntryBlock()->getSuccessors());
+    while (!stack.empty()) {
+        auto &successors = stack.back().second;
+        if (successors.empty()) {
+            post_order.emplace_back(stack.back().first);
+            stack.pop_back();
+            continue;
+        }
+        auto *successor = successors.back();
+        successors.pop_back();
+        if (visited.insert(successor).second) {
+            stack.emplace_back(successor, successor->getSuccessors());
+        }
+    }
+    m_reverse_post_order.assign(post_order.rbegin(), post_order.rend());
+    for (size_t i = 0; i < m_reverse_post_order.size(); ++i) {
+        m_order[m_reverse_post_order[i]] = i;
+    }
+
+    // blocks are numbered in reverse post order, so a dominator has a
+    // smaller number than the blocks it dominates
+    constexpr size_t kUndefined = SIZE_MAX;
+    m_idoms.assign(m_reverse_post_order.size(), kUndefined);
+    m_idoms[0] = 0;
+    auto intersect = [this](size_t p_lhs, size_t p_rhs) {
+        while (p_lhs != p_rhs) {
+            while (p_lhs > p_rhs) {
+                p_lhs = m_idoms[p_lhs];
+            }
+            while (p_rhs > p_lhs) {
+                p_rhs = m_idoms[p_rhs];
+            }
+        }
+        return p_lhs;
+    };
+    for (bool is_changed = true; is_changed;) {
+        is_changed = false;
+        for (size_t i = 1; i < m_reverse_post_order.size(); ++i) {
+            size_t idom = kUndefined;
+            for (auto *predecessor :
+                 m_reverse_post_order[i]->getPredecessors()) {
+                auto search = m_order.find(predecessor);
+                if (search == m_order.end() ||
+                    m_idoms[search->second] == kUndefined) {
+                    continue;
+                }
+                idom = idom == kUndefined ? search->second
+                                          : intersect(idom, search->second);
+            }
+            if (m_idoms[i] != idom) {
+                m_idoms[i] = idom;
+                is_changed = true;
+            }
+        }
+    }
+}
+
+bool DominatorTree::dominates(const IrBasicBlock *p_dominator,
+                              const IrBasicBlock *p_block) const {
+    auto dominator = m_order.find(p_dominator);
+    auto block = m_order.find(p_block);
+    assert(dominator != m_order.end() && block != m_order.end() &&
+           "dominance of an unreachable block");
+    size_t order = block->second;
+    while (order > dominator->second) {
+        order = m_idoms[order];
+    }
+    return order == dominator->second;
+}
@@ -0,0 +1,186 @@
+#include "opt/Inliner.hpp"
+#include "AST/Console.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+using Opcode = IrInstruction::OpcodeEnum;
+
+// a few times what a call costs: the arguments, the call and the return
+static constexpr int64_t kThreshold = 40;
+static constexpr int64_t kConstantArgumentBonus = 5;
+
+static IrValue *lookup(const std::unordered_map<IrValue *, IrValue *> &p_map,
+                       IrValue *const p_value) {
+    auto search = p_map.find(p_value);
+    return search == p_map.end() ? p_value : search->second;
+}
+
+bool Inliner::run(IrFunction &p_function) {
+    // the calls made before any inlining
+    std::vector<IrInstruction *> calls;
+    for (const auto &block : p_function.getBasicBlocks()) {
+        for (const auto &inst : block->getInstructions()) {
+            if (inst->getOpcode() == Opcode::kCall &&
+                !static_cast<IrFunction *>(inst->getOperand(0))
+                     ->isDeclaration()) {
+                calls.emplace_back(inst.get());
+            }
+        }
+    }
+
+    std::unordered_map<IrValue *, IrValue *> replacements;
+    for (auto *call : calls) {
+        const auto &callee = *static_cast<IrFunction *>(call->getOperand(0));
+        if (!decide(p_function, *call, callee)) {
+            continue;
+        }
+        // the arguments may be the results of calls inlined before
+        for (size_t i = 1; i < call->getOperands().size(); ++i) {
+            call->setOperand(i, lookup(replacements, call->getOperand(i)));
+        }
+        replacements[call] = inlineCall(p_function, call, callee);
+    }
+
+    p_function.replaceAllUsesWith(replacements);
+    return !replacements.empty();
+}
+
+bool Inliner::decide(const IrFunction &p_caller, const IrInstruction &p_call,
+                     const IrFunction &p_callee) const {
+    const char *reason = nullptr;
+    int64_t cost = 0;
+    bool has_return = false;
+    for (const auto &block : p_callee.getBasicBlocks()) {
+        for (const auto &inst : block->getInstructions()) {
+            ++cost;
+            if (inst->getOpcode() == Opcode::kCall &&
+                inst->getOperand(0) == &p_callee) {
+                reason = "recursive";
+            }
+            has_return |= inst->getOpcode() == Opcode::kRet;
+        }
+    }
+    for (size_t i = 1; i < p_call.getOperands().size(); ++i) {
+        if (p_call.getOperand(i)->getKind() ==
+            IrValue::KindEnum::kConstantInt) {
+            cost -= kConstantArgumentBonus;
+        }
+    }
+    if (&p_caller == &p_callee) {
+        reason = "recursive";
+    } else if (!has_return) {
+        reason = "never returns";
+    } else if (!reason && cost > kThreshold) {
+        reason = "too large";
+    }
+
+    if (m_report) {
+        if (reason) {
+            std::fprintf(Console::err(),
+                         "inline: %s into %s: no, %s (cost %lld, "
+                         "threshold %lld)\n",
+                         p_callee.getName().c_str(), p_caller.getName().c_str(),
+                         reason, static_cast<long long>(cost),
+                         static_cast<long long>(kThreshold));
+        } else {
+            std::fprintf(Console::err(),
+                         "inline: %s into %s: yes (cost %lld, threshold "
+                         "%lld)\n",
+                         p_callee.getName().c_str(), p_caller.getName().c_str(),
+                         static_cast<long long>(cost),
+                         static_cast<long long>(kThreshold));
+        }
+    }
+    return !reason;
+}
+
+IrValue *Inliner::inlineCall(IrFunction &p_caller, IrInstruction *const p_call,
+                             const IrFunction &p_callee) {
+    // what follows the call goes on in a block of its own
+    auto *block = p_call->getParent();
+    auto *after = p_caller.createBasicBlock();
+    block->splitAfter(p_call, after);
+    for (auto *successor : after->getSuccessors()) {
+        successor->replacePredecessor(block, after);
+    }
+
+    std::unordered_map<IrValue *, IrValue *> values;
+    for (size_t i = 0; i < p_callee.getArguments().size(); ++i) {
+        values[p_callee.getArgument(i)] = p_call->getOperand(i + 1);
+    }
+    std::vector<IrBasicBlock *> copies;
+    for (const auto &callee_block : p_callee.getBasicBlocks()) {
+        auto *copy = p_caller.createBasicBlock();
+        values[callee_block.get()] = copy;
+        copies.emplace_back(copy);
+    }
+    // the allocas are allocated once per call of the caller, in the order
+    // they are declared
+    auto *entry = p_caller.getEntryBlock();
+    auto *first = entry->getInstructions().front().get();
+    std::vector<IrInstruction *> clones;
+    for (size_t i = 0; i < copies.size(); ++i) {
+        for (const auto &inst : p_callee.getBasicBlocks()[i]->getInstructions()) {
+            auto *clone = inst->clone();
+            // the frame of the caller is no longer the one it could reuse
+            clone->setTailCall(IrInstruction::TailCallEnum::kNone);
+            if (clone->getOpcode() == Opcode::kAlloca) {
+                entry->insertBefore(first, clone);
+            } else {
+                copies[i]->append(clone);
+            }
+            values[inst.get()] = clone;
+            clones.emplace_back(clone);
+        }
+    }
+    // operands defined later in the layout, by phis, are there by now
+    for (auto *clone : clones) {
+        for (size_t i = 0; i < clone->getOperands().size(); ++i) {
+            clone->setOperand(i, lookup(values, clone->getOperand(i)));
+        }
+    }
+
+    // every return goes on after the call
+    std::vector<std::pair<IrValue *, IrBasicBlock *>> results;
+    for (auto *copy : copies) {
+        auto *terminator = copy->getTerminator();
+        if (terminator->getOpcode() == Opcode::kRet) {
+            results.emplace_back(terminator->getOperand(0), copy);
+            p_caller.eraseInstruction(terminator);
+            copy->append(
+                new IrInstruction(Opcode::kBr, terminator->getType(), {after}));
+        }
+        for (auto *successor : copy->getSuccessors()) {
+            successor->addPredecessor(copy);
+        }
+    }
+    auto *type = p_call->getType();
+    p_caller.eraseInstruction(p_call);
+    block->append(new IrInstruction(
+        Opcode::kBr, copies.front()->getTerminator()->getType(),
+        {copies.front()}));
+    copies.front()->addPredecessor(block);
+
+    // the copy goes right after the block of the call
+    const auto &blocks = p_caller.getBasicBlocks();
+    auto next = std::find_if(blocks.begin(), blocks.end(),
+                             [block](const auto &p_block) {
+                                 return p_block.get() == block;
+                             }) +
+                1;
+    copies.emplace_back(after);
+    p_caller.insertBasicBlocks(copies,
+                               next == blocks.end() ? nullptr : next->get());
+
+    if (results.size() == 1) {
+        return results.front().first;
+    }
+    auto *phi = after->insertPhi(new IrInstruction(Opcode::kPhi, type, {}));
+    for (const auto &result : results) {
+        phi->addIncoming(result.first, result.second);
+    }
+    return phi;
+}
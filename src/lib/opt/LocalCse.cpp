@@ -0,0 +1,157 @@
+#include "opt/LocalCse.hpp"
+#include "opt/MemoryAnalysis.hpp"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using Opcode = IrInstruction::OpcodeEnum;
+
+// what makes two pure instructions compute the same value
+using Expression = std::tuple<Opcode, IrInstruction::PredicateEnum,
+                              const IrType *, std::vector<IrValue *>>;
+
+// the value last loaded from or stored to each address of the block,
+// grouped by base object so that a store only looks at what it may alias
+class LocalCse::KnownValues {
+  private:
+    const MemoryAnalysis &m_memory;
+    // local allocas and the rest, which a call or a store through an
+    // unknown pointer clobbers as a whole
+    std::unordered_map<IrValue *, std::map<IrValue *, IrValue *>> m_local;
+    std::unordered_map<IrValue *, std::map<IrValue *, IrValue *>> m_shared;
+
+  public:
+    KnownValues(const MemoryAnalysis &p_memory) : m_memory(p_memory) {}
+
+    IrValue *find(IrValue *const p_ptr) const {
+        IrValue *base = MemoryAnalysis::getBase(p_ptr);
+        const auto &buckets = m_memory.isLocal(base) ? m_local : m_shared;
+        auto bucket = buckets.find(base);
+        if (bucket == buckets.end()) {
+            return nullptr;
+        }
+        auto search = bucket->second.find(p_ptr);
+        return search == bucket->second.end() ? nullptr : search->second;
+    }
+
+    void set(IrValue *const p_ptr, IrValue *const p_value) {
+        IrValue *base = MemoryAnalysis::getBase(p_ptr);
+        auto &buckets = m_memory.isLocal(base) ? m_local : m_shared;
+        buckets[base][p_ptr] = p_value;
+    }
+
+    // forget what a store to p_ptr may overwrite
+    void clobber(IrValue *const p_ptr) {
+        IrValue *base = MemoryAnalysis::getBase(p_ptr);
+        if (m_memory.isLocal(base)) {
+            clobber(m_local[base], p_ptr);
+            return;
+        }
+        if (!base) {
+            m_shared.clear();
+            return;
+        }
+        clobber(m_shared[base], p_ptr);
+        m_shared.erase(nullptr);
+    }
+
+    void clobberShared() { m_shared.clear(); }
+
+    void clear() {
+        m_local.clear();
+        m_shared.clear();
+    }
+
+  private:
+    void clobber(std::map<IrValue *, IrValue *> &p_bucket,
+                 IrValue *const p_ptr) {
+        for (auto iter = p_bucket.begin(); iter != p_bucket.end();) {
+            if (m_memory.mayAlias(iter->first, p_ptr)) {
+                iter = p_bucket.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+};
+
+static bool isPure(const IrInstruction &p_inst) {
+    switch (p_inst.getOpcode()) {
+    case Opcode::kGetElementPtr:
+    case Opcode::kAdd:
+    case Opcode::kSub:
+    case Opcode::kMul:
+    case Opcode::kSDiv:
+    case Opcode::kSRem:
+    case Opcode::kAnd:
+    case Opcode::kOr:
+    case Opcode::kXor:
+    case Opcode::kICmp:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool LocalCse::run(IrFunction &p_function) {
+    const MemoryAnalysis memory(p_function);
+    std::unordered_map<IrValue *, IrValue *> replacements;
+    auto resolve = [&](IrValue *p_value) {
+        auto search = replacements.find(p_value);
+        return search == replacements.end() ? p_value : search->second;
+    };
+
+    std::map<Expression, IrInstruction *> expressions;
+    KnownValues known_values(memory);
+    for (const auto &block : p_function.getBasicBlocks()) {
+        expressions.clear();
+        known_values.clear();
+        for (const auto &inst : block->getInstructions()) {
+            // earlier instructions of the block may have been replaced
+            for (size_t i = 0; i < inst->getOperands().size(); ++i) {
+                inst->setOperand(i, resolve(inst->getOperand(i)));
+            }
+
+            if (isPure(*inst)) {
+                auto operands = inst->getOperands();
+                if (inst->isCommutative()) {
+                    std::sort(operands.begin(), operands.end());
+                }
+                auto inserted = expressions.emplace(
+                    Expression(inst->getOpcode(), inst->getPredicate(),
+                               inst->getAuxType(), std::move(operands)),
+                    inst.get());
+                if (!inserted.second) {
+                    replacements[inst.get()] = inserted.first->second;
+                }
+                continue;
+            }
+
+            switch (inst->getOpcode()) {
+            case Opcode::kLoad:
+                if (auto *value = known_values.find(inst->getOperand(0))) {
+                    replacements[inst.get()] = value;
+                } else {
+                    known_values.set(inst->getOperand(0), inst.get());
+                }
+                break;
+            case Opcode::kStore:
+                known_values.clobber(inst->getOperand(1));
+                known_values.set(inst->getOperand(1), inst->getOperand(0));
+                break;
+            case Opcode::kCall:
+                known_values.clobberShared();
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // uses in the other blocks, phis in particular
+    p_function.replaceAllUsesWith(replacements);
+    return !replacements.empty();
+}
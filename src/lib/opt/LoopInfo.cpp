@@ -0,0 +1,151 @@
+#include "opt/LoopInfo.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+bool Loop::isDefinedOutside(const IrValue *p_value) const {
+    if (p_value->getKind() != IrValue::KindEnum::kInstruction) {
+        return true;
+    }
+    return !contains(static_cast<const IrInstruction *>(p_value)->getParent());
+}
+
+IrBasicBlock *Loop::getPreheader() const {
+    IrBasicBlock *preheader = nullptr;
+    for (auto *predecessor : m_header->getPredecessors()) {
+        if (contains(predecessor)) {
+            continue;
+        }
+        if (preheader) {
+            return nullptr;
+        }
+        preheader = predecessor;
+    }
+    if (!preheader || preheader->getSuccessors().size() != 1) {
+        return nullptr;
+    }
+    return preheader;
+}
+
+LoopInfo::LoopInfo(const DominatorTree &p_dominator_tree) {
+    const auto &blocks = p_dominator_tree.getReversePostOrder();
+    std::unordered_map<const IrBasicBlock *, size_t> order;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        order[blocks[i]] = i;
+    }
+
+    for (auto *header : blocks) {
+        std::unique_ptr<Loop> loop;
+        std::vector<IrBasicBlock *> worklist;
+        for (auto *predecessor : header->getPredecessors()) {
+            if (!p_dominator_tree.isReachable(predecessor) ||
+                !p_dominator_tree.dominates(header, predecessor)) {
+                continue;
+            }
+            if (!loop) {
+                loop.reset(new Loop(header));
+                loop->m_block_set.insert(header);
+                loop->m_blocks.emplace_back(header);
+            }
+            if (std::find(loop->m_latches.begin(), loop->m_latches.end(),
+                          predecessor) == loop->m_latches.end()) {
+                loop->m_latches.emplace_back(predecessor);
+            }
+            if (loop->m_block_set.insert(predecessor).second) {
+                loop->m_blocks.emplace_back(predecessor);
+                worklist.emplace_back(predecessor);
+            }
+        }
+        if (!loop) {
+            continue;
+        }
+        while (!worklist.empty()) {
+            auto *block = worklist.back();
+            worklist.pop_back();
+            for (auto *predecessor : block->getPredecessors()) {
+                if (p_dominator_tree.isReachable(predecessor) &&
+                    loop->m_block_set.insert(predecessor).second) {
+                    loop->m_blocks.emplace_back(predecessor);
+                    worklist.emplace_back(predecessor);
+                }
+            }
+        }
+        std::sort(loop->m_blocks.begin(), loop->m_blocks.end(),
+                  [&order](const IrBasicBlock *p_lhs,
+                           const IrBasicBlock *p_rhs) {
+                      return order[p_lhs] < order[p_rhs];
+                  });
+        m_loops.emplace_back(std::move(loop));
+    }
+
+    // The loop around another is the smallest one containing its header.
+    // Going from the outermost loops in, the innermost loop seen so far
+    // around a header is that one.
+    std::vector<Loop *> loops = getLoops();
+    std::unordered_map<const IrBasicBlock *, Loop *> innermost;
+    for (auto iter = loops.rbegin(); iter != loops.rend(); ++iter) {
+        Loop *loop = *iter;
+        auto search = innermost.find(loop->m_header);
+        if (search != innermost.end()) {
+            loop->m_parent = search->second;
+        }
+        for (auto *block : loop->m_blocks) {
+            innermost[block] = loop;
+        }
+    }
+}
+
+std::vector<Loop *> LoopInfo::getLoops() const {
+    std::vector<Loop *> loops;
+    for (const auto &loop : m_loops) {
+        loops.emplace_back(loop.get());
+    }
+    // a loop has more blocks than any loop inside it
+    std::stable_sort(loops.begin(), loops.end(),
+                     [](const Loop *p_lhs, const Loop *p_rhs) {
+                         return p_lhs->getBlocks().size() <
+                                p_rhs->getBlocks().size();
+                     });
+    return loops;
+}
+
+bool LoopInfo::insertPreheaders(IrFunction &p_function) {
+    const DominatorTree dominator_tree(p_function);
+    const LoopInfo loop_info(dominator_tree);
+
+    bool is_changed = false;
+    for (auto *loop : loop_info.getLoops()) {
+        auto *header = loop->getHeader();
+        if (loop->getPreheader()) {
+            continue;
+        }
+        IrBasicBlock *entering = nullptr;
+        size_t num_entering_edges = 0;
+        for (auto *predecessor : header->getPredecessors()) {
+            if (!loop->contains(predecessor)) {
+                entering = predecessor;
+                ++num_entering_edges;
+            }
+        }
+        // a loop head is only branched to from a single place before it
+        if (num_entering_edges != 1) {
+            continue;
+        }
+
+        auto *preheader = p_function.createBasicBlock("preheader");
+        p_function.insertBasicBlock(preheader, header);
+        auto *terminator = entering->getTerminator();
+        for (size_t i = 0; i < terminator->getOperands().size(); ++i) {
+            if (terminator->getOperand(i) == header) {
+                terminator->setOperand(i, preheader);
+            }
+        }
+        preheader->addPredecessor(entering);
+        header->replacePredecessor(entering, preheader);
+        auto *branch = new IrInstruction(IrInstruction::OpcodeEnum::kBr,
+                                         terminator->getType(), {header});
+        preheader->append(branch);
+        is_changed = true;
+    }
+    return is_changed;
+}
@@ -0,0 +1,168 @@
+#include "opt/LoopInvariantCodeMotion.hpp"
+#include "opt/DominatorTree.hpp"
+#include "opt/LoopInfo.hpp"
+#include "opt/MemoryAnalysis.hpp"
+
+#include <unordered_set>
+#include <vector>
+
+using Opcode = IrInstruction::OpcodeEnum;
+
+bool LoopInvariantCodeMotion::run(IrFunction &p_function) {
+    bool is_changed = hoistAllocas(p_function);
+    is_changed |= LoopInfo::insertPreheaders(p_function);
+
+    const DominatorTree dominator_tree(p_function);
+    const LoopInfo loop_info(dominator_tree);
+    const MemoryAnalysis memory(p_function);
+    for (auto *loop : loop_info.getLoops()) {
+        is_changed |= hoist(*loop, memory);
+    }
+    return is_changed;
+}
+
+bool LoopInvariantCodeMotion::hoistAllocas(IrFunction &p_function) {
+    auto *entry = p_function.getEntryBlock();
+    std::vector<IrInstruction *> allocas;
+    for (const auto &block : p_function.getBasicBlocks()) {
+        if (block.get() == entry) {
+            continue;
+        }
+        for (const auto &inst : block->getInstructions()) {
+            if (inst->getOpcode() == Opcode::kAlloca) {
+                allocas.emplace_back(inst.get());
+            }
+        }
+    }
+    // in front of everything else, in the order they were declared
+    auto *position = entry->getInstructions().front().get();
+    for (auto *alloca : allocas) {
+        entry->insertBefore(position,
+                            alloca->getParent()->remove(alloca).release());
+    }
+    return !allocas.empty();
+}
+
+// whether loading from p_ptr is fine wherever it happens, i.e., p_ptr is a
+// variable or an element of one at constant indices in bounds
+static bool isDereferenceable(IrValue *p_ptr) {
+    while (p_ptr->getKind() == IrValue::KindEnum::kInstruction) {
+        auto *inst = static_cast<IrInstruction *>(p_ptr);
+        if (inst->getOpcode() == Opcode::kAlloca) {
+            return true;
+        }
+        if (inst->getOpcode() != Opcode::kGetElementPtr) {
+            return false;
+        }
+        // the first index steps over whole objects, the rest into arrays
+        const IrType *type = nullptr;
+        for (size_t i = 1; i < inst->getOperands().size(); ++i) {
+            const auto *index = inst->getOperand(i);
+            if (index->getKind() != IrValue::KindEnum::kConstantInt) {
+                return false;
+            }
+            const int64_t value =
+                static_cast<const IrConstantInt *>(index)->getValue();
+            const bool is_in_bounds =
+                i == 1 ? value == 0
+                       : value >= 0 &&
+                             static_cast<uint64_t>(value) <
+                                 type->getNumElements();
+            if (!is_in_bounds) {
+                return false;
+            }
+            type = i == 1 ? inst->getAuxType() : type->getElementType();
+        }
+        p_ptr = inst->getOperand(0);
+    }
+    return p_ptr->getKind() == IrValue::KindEnum::kGlobalVariable;
+}
+
+static bool isSpeculatable(const IrInstruction &p_inst) {
+    switch (p_inst.getOpcode()) {
+    case Opcode::kGetElementPtr:
+    case Opcode::kAdd:
+    case Opcode::kSub:
+    case Opcode::kMul:
+    case Opcode::kAnd:
+    case Opcode::kOr:
+    case Opcode::kXor:
+    case Opcode::kICmp:
+        return true;
+    case Opcode::kSDiv:
+    case Opcode::kSRem: {
+        const auto *divisor = p_inst.getOperand(1);
+        if (divisor->getKind() != IrValue::KindEnum::kConstantInt) {
+            return false;
+        }
+        const int64_t value =
+            static_cast<const IrConstantInt *>(divisor)->getValue();
+        return value != 0 && value != -1;
+    }
+    case Opcode::kLoad:
+        return isDereferenceable(p_inst.getOperand(0));
+    default:
+        return false;
+    }
+}
+
+bool LoopInvariantCodeMotion::hoist(const Loop &p_loop,
+                                    const MemoryAnalysis &p_memory) {
+    auto *preheader = p_loop.getPreheader();
+    if (!preheader) {
+        return false;
+    }
+
+    std::vector<IrValue *> stored_ptrs;
+    bool has_call = false;
+    for (auto *block : p_loop.getBlocks()) {
+        for (const auto &inst : block->getInstructions()) {
+            if (inst->getOpcode() == Opcode::kStore) {
+                stored_ptrs.emplace_back(inst->getOperand(1));
+            } else if (inst->getOpcode() == Opcode::kCall) {
+                has_call = true;
+            }
+        }
+    }
+    auto is_clobbered = [&](IrValue *p_ptr) {
+        if (has_call && !p_memory.isLocal(MemoryAnalysis::getBase(p_ptr))) {
+            return true;
+        }
+        for (auto *stored_ptr : stored_ptrs) {
+            if (p_memory.mayAlias(stored_ptr, p_ptr)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // a block comes after its dominators, so the operands of an instruction
+    // have been seen before it
+    std::vector<IrInstruction *> hoisted;
+    std::unordered_set<const IrValue *> hoisted_set;
+    for (auto *block : p_loop.getBlocks()) {
+        for (const auto &inst : block->getInstructions()) {
+            if (!isSpeculatable(*inst)) {
+                continue;
+            }
+            bool is_invariant = true;
+            for (const auto *operand : inst->getOperands()) {
+                is_invariant &= p_loop.isDefinedOutside(operand) ||
+                                hoisted_set.count(operand);
+            }
+            if (!is_invariant || (inst->getOpcode() == Opcode::kLoad &&
+                                  is_clobbered(inst->getOperand(0)))) {
+                continue;
+            }
+            hoisted.emplace_back(inst.get());
+            hoisted_set.insert(inst.get());
+        }
+    }
+
+    auto *position = preheader->getTerminator();
+    for (auto *inst : hoisted) {
+        preheader->insertBefore(position,
+                                inst->getParent()->remove(inst).release());
+    }
+    return !hoisted.empty();
+}
@@ -0,0 +1,158 @@
+#include "opt/LoopStrengthReduction.hpp"
+#include "opt/DominatorTree.hpp"
+#include "opt/LoopInfo.hpp"
+
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using Opcode = IrInstruction::OpcodeEnum;
+
+bool LoopStrengthReduction::run(IrFunction &p_function) {
+    bool is_changed = LoopInfo::insertPreheaders(p_function);
+
+    const DominatorTree dominator_tree(p_function);
+    const LoopInfo loop_info(dominator_tree);
+    for (auto *loop : loop_info.getLoops()) {
+        is_changed |= reduce(p_function, *loop);
+    }
+    return is_changed;
+}
+
+bool LoopStrengthReduction::reduce(IrFunction &p_function,
+                                   const Loop &p_loop) {
+    auto *preheader = p_loop.getPreheader();
+    auto *latch = p_loop.getLatch();
+    if (!preheader || !latch) {
+        return false;
+    }
+
+    // the induction variables and their initial values and steps
+    std::unordered_map<const IrValue *, std::pair<IrValue *, int64_t>>
+        variables;
+    for (const auto &inst : p_loop.getHeader()->getInstructions()) {
+        if (!inst->isPhi()) {
+            break;
+        }
+        if (inst->getOperands().size() != 4) {
+            continue;
+        }
+        auto *initial = inst->getIncomingValue(preheader);
+        auto *next = inst->getIncomingValue(latch);
+        if (!initial || !next ||
+            next->getKind() != IrValue::KindEnum::kInstruction) {
+            continue;
+        }
+        const auto *add = static_cast<const IrInstruction *>(next);
+        if (add->getOpcode() != Opcode::kAdd) {
+            continue;
+        }
+        for (size_t i = 0; i < 2; ++i) {
+            const auto *step = add->getOperand(1 - i);
+            if (add->getOperand(i) == inst.get() &&
+                step->getKind() == IrValue::KindEnum::kConstantInt) {
+                variables[inst.get()] = std::make_pair(
+                    initial, static_cast<const IrConstantInt *>(step)->getValue());
+                break;
+            }
+        }
+    }
+    if (variables.empty()) {
+        return false;
+    }
+
+    // the addresses to reduce, collected first since the pointers go into
+    // the blocks being looked at
+    std::vector<IrInstruction *> addresses;
+    for (auto *block : p_loop.getBlocks()) {
+        for (const auto &inst : block->getInstructions()) {
+            if (inst->getOpcode() == Opcode::kGetElementPtr) {
+                addresses.emplace_back(inst.get());
+            }
+        }
+    }
+
+    // one pointer per distinct address
+    std::map<std::pair<const IrType *, std::vector<IrValue *>>,
+             IrInstruction *>
+        pointers;
+    std::unordered_map<IrValue *, IrValue *> replacements;
+    for (auto *inst : addresses) {
+        auto operands = inst->getOperands();
+        // a[i + k], as in a loop unrolled by LoopUnroll, is k elements on
+        // from a[i], and a[i - k] k elements back
+        int64_t offset = 0;
+        const auto *index = operands.back();
+        const auto *arithmetic = static_cast<const IrInstruction *>(index);
+        if (index->getKind() == IrValue::KindEnum::kInstruction &&
+            arithmetic->getOpcode() == Opcode::kAdd) {
+            for (size_t i = 0; i < 2; ++i) {
+                const auto *constant = arithmetic->getOperand(1 - i);
+                if (variables.count(arithmetic->getOperand(i)) &&
+                    constant->getKind() == IrValue::KindEnum::kConstantInt) {
+                    operands.back() = arithmetic->getOperand(i);
+                    offset = static_cast<const IrConstantInt *>(constant)
+                                 ->getValue();
+                    break;
+                }
+            }
+        } else if (index->getKind() == IrValue::KindEnum::kInstruction &&
+                   arithmetic->getOpcode() == Opcode::kSub &&
+                   variables.count(arithmetic->getOperand(0)) &&
+                   arithmetic->getOperand(1)->getKind() ==
+                       IrValue::KindEnum::kConstantInt) {
+            operands.back() = arithmetic->getOperand(0);
+            offset = -static_cast<const IrConstantInt *>(
+                          arithmetic->getOperand(1))
+                          ->getValue();
+        }
+        auto variable = variables.find(operands.back());
+        if (variable == variables.end()) {
+            continue;
+        }
+        bool is_invariant = true;
+        for (size_t i = 0; i + 1 < operands.size(); ++i) {
+            is_invariant &= p_loop.isDefinedOutside(operands[i]);
+        }
+        if (!is_invariant) {
+            continue;
+        }
+
+        // advanced by a number of elements, in units of what it points to
+        auto advance = [&](IrValue *p_pointer, const int64_t elements) {
+            auto *address = new IrInstruction(
+                Opcode::kGetElementPtr, inst->getType(),
+                {p_pointer, m_module.getConstantInt(
+                                m_module.getIntegerType(64), elements)});
+            address->setAuxType(inst->getType()->getElementType());
+            return address;
+        };
+        auto &pointer = pointers[std::make_pair(inst->getAuxType(), operands)];
+        if (!pointer) {
+            auto initial_operands = operands;
+            initial_operands.back() = variable->second.first;
+            auto *initial = new IrInstruction(
+                Opcode::kGetElementPtr, inst->getType(), initial_operands);
+            initial->setAuxType(inst->getAuxType());
+            preheader->insertBefore(preheader->getTerminator(), initial);
+
+            pointer = p_loop.getHeader()->insertPhi(
+                new IrInstruction(Opcode::kPhi, inst->getType(), {}));
+            auto *next = advance(pointer, variable->second.second);
+            latch->insertBefore(latch->getTerminator(), next);
+
+            pointer->addIncoming(initial, preheader);
+            pointer->addIncoming(next, latch);
+        }
+        if (offset == 0) {
+            replacements[inst] = pointer;
+        } else {
+            replacements[inst] =
+                inst->getParent()->insertBefore(inst, advance(pointer, offset));
+        }
+    }
+
+    p_function.replaceAllUsesWith(replacements);
+    return !replacements.empty();
+}
@@ -0,0 +1,332 @@
+#include "opt/LoopUnroll.hpp"
+#include "opt/DominatorTree.hpp"
+#include "opt/LoopInfo.hpp"
+
+#include <vector>
+
+using Opcode = IrInstruction::OpcodeEnum;
+using Predicate = IrInstruction::PredicateEnum;
+
+// past that, the branches saved hardly matter next to the body
+static constexpr int64_t kMaxFactor = 8;
+
+bool LoopUnroll::run(IrFunction &p_function) {
+    if (m_budget == 0) {
+        return false;
+    }
+    bool is_changed = LoopInfo::insertPreheaders(p_function);
+
+    // Unrolling a loop changes the blocks of the loops around it and inside
+    // it, so those wait until the analyses have been redone.
+    for (bool is_unrolled = true; is_unrolled;) {
+        is_unrolled = false;
+        const DominatorTree dominator_tree(p_function);
+        const LoopInfo loop_info(dominator_tree);
+        const auto loops = loop_info.getLoops();
+        std::unordered_set<const Loop *> parents;
+        for (auto *loop : loops) {
+            parents.insert(loop->getParent());
+        }
+        std::unordered_set<const Loop *> stale;
+        for (auto *loop : loops) {
+            if (stale.count(loop) ||
+                !unroll(p_function, *loop, !parents.count(loop))) {
+                continue;
+            }
+            is_unrolled = is_changed = true;
+            for (const auto *outer = loop; outer; outer = outer->getParent()) {
+                stale.insert(outer);
+            }
+        }
+    }
+    return is_changed;
+}
+
+static IrValue *lookup(const std::unordered_map<IrValue *, IrValue *> &p_map,
+                       IrValue *const p_value) {
+    auto search = p_map.find(p_value);
+    return search == p_map.end() ? p_value : search->second;
+}
+
+// p_block branches to p_to where it went to p_from
+static void retarget(IrBasicBlock *const p_block, IrBasicBlock *const p_from,
+                     IrBasicBlock *const p_to) {
+    auto *terminator = p_block->getTerminator();
+    for (size_t i = 0; i < terminator->getOperands().size(); ++i) {
+        if (terminator->getOperand(i) == p_from) {
+            terminator->setOperand(i, p_to);
+        }
+    }
+}
+
+bool LoopUnroll::unroll(IrFunction &p_function, const Loop &p_loop,
+                        const bool is_innermost) {
+    auto *header = p_loop.getHeader();
+    auto *preheader = p_loop.getPreheader();
+    auto *latch = p_loop.getLatch();
+    if (!preheader || !latch || latch == header ||
+        latch->getTerminator()->getOpcode() != Opcode::kBr ||
+        m_unrolled.count(header)) {
+        return false;
+    }
+    // the copies have nowhere to leave the loop but from the header
+    uint64_t size = 0;
+    for (auto *block : p_loop.getBlocks()) {
+        size += block->getInstructions().size();
+        if (block == header) {
+            continue;
+        }
+        for (auto *successor : block->getSuccessors()) {
+            if (!p_loop.contains(successor)) {
+                return false;
+            }
+        }
+    }
+    for (const auto &inst : header->getInstructions()) {
+        if (inst->isPhi() && inst->getOperands().size() != 4) {
+            return false;
+        }
+    }
+    const int64_t trip_count = getTripCount(p_loop);
+    if (trip_count < 0) {
+        return false;
+    }
+
+    if (static_cast<uint64_t>(trip_count) * size <= m_budget) {
+        peel(p_function, p_loop, trip_count);
+        // The header stays as the last check, which fails, so what is used
+        // after the loop is still defined there. The rest is unreachable.
+        auto *branch = header->getTerminator();
+        auto *body = static_cast<IrBasicBlock *>(branch->getOperand(1));
+        auto *exit = branch->getOperand(2);
+        p_function.eraseInstruction(branch);
+        header->append(
+            new IrInstruction(Opcode::kBr, branch->getType(), {exit}));
+        body->removePredecessor(header);
+        return true;
+    }
+
+    if (!is_innermost) {
+        return false;
+    }
+    int64_t factor = kMaxFactor;
+    while (factor > 1 &&
+           (trip_count < factor ||
+            static_cast<uint64_t>(factor + trip_count % factor) * size >
+                m_budget)) {
+        factor /= 2;
+    }
+    if (factor <= 1) {
+        return false;
+    }
+    peel(p_function, p_loop, trip_count % factor);
+
+    // the copies go after the loop, in front of where it leaves to
+    auto *exit = static_cast<IrBasicBlock *>(
+        header->getTerminator()->getOperand(2));
+    ValueMap values;
+    for (const auto &inst : header->getInstructions()) {
+        if (!inst->isPhi()) {
+            break;
+        }
+        values[inst.get()] = inst->getIncomingValue(latch);
+    }
+    std::vector<Iteration> iterations;
+    std::vector<IrBasicBlock *> blocks;
+    for (int64_t i = 1; i < factor; ++i) {
+        ValueMap iteration = values;
+        iterations.emplace_back(
+            cloneIteration(p_function, p_loop, iteration, blocks));
+        for (auto &value : values) {
+            value.second = lookup(
+                iteration,
+                static_cast<IrInstruction *>(value.first)->getIncomingValue(
+                    latch));
+        }
+    }
+    p_function.insertBasicBlocks(blocks, exit);
+
+    // chained from the latch, and back to the header at the end
+    auto *from = latch;
+    auto *target = header;
+    for (const auto &iteration : iterations) {
+        retarget(from, target, iteration.header);
+        iteration.header->addPredecessor(from);
+        from = iteration.latch;
+        target = iteration.header;
+    }
+    retarget(from, target, header);
+    header->replacePredecessor(latch, from);
+    for (const auto &value : values) {
+        static_cast<IrInstruction *>(value.first)
+            ->setIncomingValue(from, value.second);
+    }
+    m_unrolled.insert(header);
+    return true;
+}
+
+static const IrConstantInt *asConstant(const IrValue *p_value) {
+    if (!p_value || p_value->getKind() != IrValue::KindEnum::kConstantInt) {
+        return nullptr;
+    }
+    return static_cast<const IrConstantInt *>(p_value);
+}
+
+int64_t LoopUnroll::getTripCount(const Loop &p_loop) const {
+    auto *header = p_loop.getHeader();
+    const auto *branch = header->getTerminator();
+    if (branch->getOpcode() != Opcode::kCondBr ||
+        !p_loop.contains(
+            static_cast<const IrBasicBlock *>(branch->getOperand(1))) ||
+        p_loop.contains(
+            static_cast<const IrBasicBlock *>(branch->getOperand(2))) ||
+        branch->getOperand(0)->getKind() != IrValue::KindEnum::kInstruction) {
+        return -1;
+    }
+
+    // i < bound or i <= bound, for i from a constant up by a constant
+    const auto *condition =
+        static_cast<const IrInstruction *>(branch->getOperand(0));
+    if (condition->getOpcode() != Opcode::kICmp ||
+        (condition->getPredicate() != Predicate::kSlt &&
+         condition->getPredicate() != Predicate::kSle) ||
+        condition->getOperand(0)->getKind() !=
+            IrValue::KindEnum::kInstruction) {
+        return -1;
+    }
+    const auto *variable =
+        static_cast<const IrInstruction *>(condition->getOperand(0));
+    const auto *bound = asConstant(condition->getOperand(1));
+    if (!bound || !variable->isPhi() || variable->getParent() != header) {
+        return -1;
+    }
+    const auto *initial =
+        asConstant(variable->getIncomingValue(p_loop.getPreheader()));
+    const auto *next = variable->getIncomingValue(p_loop.getLatch());
+    if (!initial || !next ||
+        next->getKind() != IrValue::KindEnum::kInstruction) {
+        return -1;
+    }
+    const auto *add = static_cast<const IrInstruction *>(next);
+    if (add->getOpcode() != Opcode::kAdd) {
+        return -1;
+    }
+    const IrConstantInt *step = nullptr;
+    for (size_t i = 0; i < 2; ++i) {
+        if (add->getOperand(i) == variable) {
+            step = asConstant(add->getOperand(1 - i));
+        }
+    }
+    if (!step || step->getValue() <= 0) {
+        return -1;
+    }
+
+    const int64_t first = initial->getValue();
+    const int64_t last = condition->getPredicate() == Predicate::kSlt
+                             ? bound->getValue() - 1
+                             : bound->getValue();
+    if (last < first) {
+        return 0;
+    }
+    const int64_t trip_count = (last - first) / step->getValue() + 1;
+    // the variable may not wrap around on the way
+    if (first + trip_count * step->getValue() > INT32_MAX) {
+        return -1;
+    }
+    return trip_count;
+}
+
+LoopUnroll::Iteration
+LoopUnroll::cloneIteration(IrFunction &p_function, const Loop &p_loop,
+                           ValueMap &p_values,
+                           std::vector<IrBasicBlock *> &p_blocks) {
+    auto *header = p_loop.getHeader();
+    const auto &blocks = p_loop.getBlocks();
+    std::vector<IrBasicBlock *> copies;
+    for (auto *block : blocks) {
+        auto *copy = p_function.createBasicBlock();
+        p_values[block] = copy;
+        copies.emplace_back(copy);
+        p_blocks.emplace_back(copy);
+        if (m_unrolled.count(block)) {
+            m_unrolled.insert(copy);
+        }
+    }
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        for (const auto &inst : blocks[i]->getInstructions()) {
+            if (blocks[i] == header && inst->isPhi()) {
+                continue;
+            }
+            p_values[inst.get()] = copies[i]->append(inst->clone());
+        }
+    }
+    // operands defined later in the layout, by phis, are there by now
+    for (auto *copy : copies) {
+        for (const auto &inst : copy->getInstructions()) {
+            for (size_t i = 0; i < inst->getOperands().size(); ++i) {
+                inst->setOperand(i, lookup(p_values, inst->getOperand(i)));
+            }
+        }
+    }
+
+    // the condition holds on every iteration but the last
+    const Iteration iteration{
+        copies.front(),
+        static_cast<IrBasicBlock *>(p_values[p_loop.getLatch()])};
+    auto *branch = iteration.header->getTerminator();
+    auto *body = branch->getOperand(1);
+    p_function.eraseInstruction(branch);
+    iteration.header->append(
+        new IrInstruction(Opcode::kBr, branch->getType(), {body}));
+
+    for (auto *copy : copies) {
+        for (auto *successor : copy->getSuccessors()) {
+            if (copy != iteration.latch || successor != iteration.header) {
+                successor->addPredecessor(copy);
+            }
+        }
+    }
+    return iteration;
+}
+
+void LoopUnroll::peel(IrFunction &p_function, const Loop &p_loop,
+                      const int64_t p_count) {
+    auto *header = p_loop.getHeader();
+    auto *preheader = p_loop.getPreheader();
+    auto *latch = p_loop.getLatch();
+    ValueMap values;
+    for (const auto &inst : header->getInstructions()) {
+        if (!inst->isPhi()) {
+            break;
+        }
+        values[inst.get()] = inst->getIncomingValue(preheader);
+    }
+
+    IrBasicBlock *from = preheader;
+    IrBasicBlock *target = header;
+    std::vector<IrBasicBlock *> blocks;
+    for (int64_t i = 0; i < p_count; ++i) {
+        ValueMap iteration = values;
+        const auto copy = cloneIteration(p_function, p_loop, iteration, blocks);
+        retarget(from, target, copy.header);
+        copy.header->addPredecessor(from);
+        for (auto &value : values) {
+            value.second = lookup(
+                iteration,
+                static_cast<IrInstruction *>(value.first)->getIncomingValue(
+                    latch));
+        }
+        from = copy.latch;
+        target = copy.header;
+    }
+    if (p_count == 0) {
+        return;
+    }
+    p_function.insertBasicBlocks(blocks, header);
+    retarget(from, target, header);
+    header->replacePredecessor(preheader, from);
+    for (const auto &value : values) {
+        static_cast<IrInstruction *>(value.first)
+            ->setIncomingValue(from, value.second);
+    }
+}
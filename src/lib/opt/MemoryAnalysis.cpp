@@ -0,0 +1,122 @@
+#include "opt/MemoryAnalysis.hpp"
+
+using Opcode = IrInstruction::OpcodeEnum;
+
+static bool isInstruction(const IrValue *p_value, const Opcode p_opcode) {
+    return p_value->getKind() == IrValue::KindEnum::kInstruction &&
+           static_cast<const IrInstruction *>(p_value)->getOpcode() ==
+               p_opcode;
+}
+
+MemoryAnalysis::MemoryAnalysis(const IrFunction &p_function) {
+    for (const auto &block : p_function.getBasicBlocks()) {
+        for (const auto &inst : block->getInstructions()) {
+            if (inst->getOpcode() == Opcode::kAlloca) {
+                m_allocas[inst.get()];
+            }
+        }
+    }
+
+    // getelementptr results are instructions too, so looking at each
+    // operand sees every use of the addresses derived from an alloca
+    for (const auto &block : p_function.getBasicBlocks()) {
+        for (const auto &inst : block->getInstructions()) {
+            const auto &operands = inst->getOperands();
+            for (size_t i = 0; i < operands.size(); ++i) {
+                if (!operands[i]->getType()->isPointer()) {
+                    continue;
+                }
+                auto search = m_allocas.find(getBase(operands[i]));
+                if (search == m_allocas.end()) {
+                    continue;
+                }
+                switch (inst->getOpcode()) {
+                case Opcode::kLoad:
+                    search->second.is_loaded = true;
+                    break;
+                case Opcode::kStore:
+                    // storing the address itself somewhere
+                    if (i == 0) {
+                        search->second.is_escaped = true;
+                    }
+                    break;
+                case Opcode::kGetElementPtr:
+                    break;
+                default:
+                    search->second.is_escaped = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+IrValue *MemoryAnalysis::getBase(IrValue *p_ptr) {
+    while (isInstruction(p_ptr, Opcode::kGetElementPtr)) {
+        p_ptr = static_cast<IrInstruction *>(p_ptr)->getOperand(0);
+    }
+    if (isInstruction(p_ptr, Opcode::kAlloca) ||
+        p_ptr->getKind() == IrValue::KindEnum::kGlobalVariable) {
+        return p_ptr;
+    }
+    return nullptr;
+}
+
+bool MemoryAnalysis::isLocal(const IrValue *p_base) const {
+    auto search = m_allocas.find(p_base);
+    return search != m_allocas.end() && !search->second.is_escaped;
+}
+
+bool MemoryAnalysis::isLoaded(const IrValue *p_base) const {
+    auto search = m_allocas.find(p_base);
+    return search == m_allocas.end() || search->second.is_escaped ||
+           search->second.is_loaded;
+}
+
+void MemoryAnalysis::getIndices(IrValue *p_ptr,
+                                std::vector<IrValue *> &p_indices) {
+    if (!isInstruction(p_ptr, Opcode::kGetElementPtr)) {
+        return;
+    }
+    const auto &operands = static_cast<IrInstruction *>(p_ptr)->getOperands();
+    getIndices(operands[0], p_indices);
+    p_indices.insert(p_indices.end(), operands.begin() + 1, operands.end());
+}
+
+bool MemoryAnalysis::mayAlias(IrValue *p_lhs, IrValue *p_rhs) const {
+    if (p_lhs == p_rhs) {
+        return true;
+    }
+
+    const IrValue *lhs_base = getBase(p_lhs);
+    const IrValue *rhs_base = getBase(p_rhs);
+    if (lhs_base != rhs_base) {
+        if (lhs_base && rhs_base) {
+            return false;
+        }
+        // nothing unknown points into a local alloca
+        return !isLocal(lhs_base) && !isLocal(rhs_base);
+    }
+    if (!lhs_base) {
+        return true;
+    }
+
+    std::vector<IrValue *> lhs_indices;
+    std::vector<IrValue *> rhs_indices;
+    getIndices(p_lhs, lhs_indices);
+    getIndices(p_rhs, rhs_indices);
+    if (lhs_indices.size() != rhs_indices.size()) {
+        return true;
+    }
+    for (size_t i = 0; i < lhs_indices.size(); ++i) {
+        const auto *lhs = lhs_indices[i];
+        const auto *rhs = rhs_indices[i];
+        if (lhs->getKind() == IrValue::KindEnum::kConstantInt &&
+            rhs->getKind() == IrValue::KindEnum::kConstantInt &&
+            static_cast<const IrConstantInt *>(lhs)->getValue() !=
+                static_cast<const IrConstantInt *>(rhs)->getValue()) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#include "opt/Optimizer.hpp"
+#include "AST/Tracer.hpp"
+#include "opt/ConstantPropagation.hpp"
+#include "opt/DeadCodeElimination.hpp"
+#include "opt/Inliner.hpp"
+#include "opt/LocalCse.hpp"
+#include "opt/LoopInvariantCodeMotion.hpp"
+#include "opt/LoopUnroll.hpp"
+#include "opt/LoopStrengthReduction.hpp"
+#include "opt/TailCallElimination.hpp"
+
+// the passes usually settle within two or three rounds
+static constexpr int kMaxRounds = 8;
+
+void Optimizer::run(IrModule &p_module) {
+    if (m_options.level <= 0) {
+        return;
+    }
+    for (const auto &function : p_module.getFunctions()) {
+        if (function->isDeclaration()) {
+            continue;
+        }
+        TRACE_SPAN("optimize", "function", function->getName().c_str());
+        if (m_options.inline_functions) {
+            Inliner(m_options.inline_report).run(*function);
+        }
+        runScalarPasses(p_module, *function);
+        // the loops it makes out of recursion are for the loop passes
+        if (TailCallElimination().run(*function)) {
+            runScalarPasses(p_module, *function);
+        }
+        // what strength reduction adds to a preheader may be invariant in
+        // the loop around it; the unroller remembers what it has done
+        // across the rounds
+        LoopUnroll unroll(m_options.unroll_budget);
+        for (int round = 0;
+             round < kMaxRounds && runLoopPasses(p_module, *function, unroll);
+             ++round) {
+            runScalarPasses(p_module, *function);
+        }
+    }
+}
+
+void Optimizer::runScalarPasses(IrModule &p_module, IrFunction &p_function) {
+    LocalCse cse;
+    ConstantPropagation constant_propagation(p_module);
+    DeadCodeElimination dce;
+    for (int round = 0; round < kMaxRounds; ++round) {
+        bool is_changed = cse.run(p_function);
+        is_changed |= constant_propagation.run(p_function);
+        is_changed |= dce.run(p_function);
+        if (!is_changed) {
+            break;
+        }
+    }
+}
+
+bool Optimizer::runLoopPasses(IrModule &p_module, IrFunction &p_function,
+                              LoopUnroll &p_unroll) {
+    bool is_changed = LoopInvariantCodeMotion().run(p_function);
+    is_changed |= p_unroll.run(p_function);
+    is_changed |= LoopStrengthReduction(p_module).run(p_function);
+    return is_changed;
+}
@@ -0,0 +1,124 @@
+#include "opt/TailCallElimination.hpp"
+#include "opt/MemoryAnalysis.hpp"
+
+#include <unordered_map>
+
+using Opcode = IrInstruction::OpcodeEnum;
+using TailCall = IrInstruction::TailCallEnum;
+
+// a0-a7 on riscv32, the board; every type of P takes a single register
+static constexpr size_t kMaxRegisterArguments = 8;
+
+// Whether a call of p_callee may take the place of a return from p_caller
+// on every target: llc aborts on a musttail call that has arguments on the
+// stack, which riscv32 does not support.
+static bool isMustTail(const IrFunction &p_caller,
+                       const IrFunction &p_callee) {
+    if (p_callee.isVarArg() ||
+        p_callee.getArguments().size() > kMaxRegisterArguments ||
+        p_callee.getReturnType() != p_caller.getReturnType() ||
+        p_callee.getArguments().size() != p_caller.getArguments().size()) {
+        return false;
+    }
+    for (size_t i = 0; i < p_caller.getArguments().size(); ++i) {
+        if (p_callee.getArgument(i)->getType() !=
+            p_caller.getArgument(i)->getType()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TailCallElimination::run(IrFunction &p_function) {
+    const MemoryAnalysis memory(p_function);
+    std::vector<IrInstruction *> tail_calls;
+    for (const auto &block : p_function.getBasicBlocks()) {
+        const auto &insts = block->getInstructions();
+        for (const auto &inst : insts) {
+            if (inst->getOpcode() == Opcode::kAlloca &&
+                !memory.isLocal(inst.get())) {
+                return false;
+            }
+        }
+        // a call, then a return of its result
+        if (insts.size() < 2) {
+            continue;
+        }
+        auto *ret = insts.back().get();
+        auto *call = insts[insts.size() - 2].get();
+        if (ret->getOpcode() == Opcode::kRet &&
+            call->getOpcode() == Opcode::kCall &&
+            (ret->getOperands().empty() ? !call->hasResult()
+                                        : ret->getOperand(0) == call)) {
+            tail_calls.emplace_back(call);
+        }
+    }
+
+    bool is_changed = false;
+    std::vector<IrInstruction *> self_calls;
+    for (auto *call : tail_calls) {
+        const auto &callee = *static_cast<IrFunction *>(call->getOperand(0));
+        if (&callee == &p_function) {
+            self_calls.emplace_back(call);
+            continue;
+        }
+        const auto tail_call = isMustTail(p_function, callee)
+                                   ? TailCall::kMustTail
+                                   : TailCall::kTail;
+        if (call->getTailCall() != tail_call) {
+            call->setTailCall(tail_call);
+            is_changed = true;
+        }
+    }
+    if (!self_calls.empty()) {
+        eliminate(p_function, self_calls);
+        is_changed = true;
+    }
+    return is_changed;
+}
+
+void TailCallElimination::eliminate(
+    IrFunction &p_function, const std::vector<IrInstruction *> &p_calls) {
+    auto *header = p_function.getEntryBlock();
+    auto *entry = p_function.createBasicBlock();
+    std::vector<IrInstruction *> allocas;
+    for (const auto &inst : header->getInstructions()) {
+        if (inst->getOpcode() == Opcode::kAlloca) {
+            allocas.emplace_back(inst.get());
+        }
+    }
+    for (auto *alloca : allocas) {
+        entry->append(header->remove(alloca).release());
+    }
+    // void, as for every terminator
+    auto *void_type = p_calls.front()->getParent()->getTerminator()->getType();
+    entry->append(new IrInstruction(Opcode::kBr, void_type, {header}));
+    p_function.insertBasicBlock(entry, header);
+
+    // the parameters are the phis from here on, the arguments come in
+    // from the new entry block
+    std::vector<IrInstruction *> phis;
+    std::unordered_map<IrValue *, IrValue *> replacements;
+    for (const auto &argument : p_function.getArguments()) {
+        auto *phi = header->insertPhi(
+            new IrInstruction(Opcode::kPhi, argument->getType(), {}));
+        replacements[argument.get()] = phi;
+        phis.emplace_back(phi);
+    }
+    p_function.replaceAllUsesWith(replacements);
+    for (size_t i = 0; i < phis.size(); ++i) {
+        phis[i]->addIncoming(p_function.getArgument(i), entry);
+    }
+    header->addPredecessor(entry);
+
+    for (auto *call : p_calls) {
+        auto *block = call->getParent();
+        for (size_t i = 0; i < phis.size(); ++i) {
+            phis[i]->addIncoming(call->getOperand(i + 1), block);
+        }
+        p_function.eraseInstruction(block->getTerminator());
+        p_function.eraseInstruction(call);
+        block->append(new IrInstruction(Opcode::kBr, void_type, {header}));
+        header->addPredecessor(block);
+    }
+}
@@ -1,4 +1,5 @@
 #include "sema/SemanticAnalyzer.hpp"
+#include "AST/Tracer.hpp"
 #include "sema/error.hpp"
 #include "visitor/AstNodeInclude.hpp"
 
@@ -14,7 +15,7 @@ void SemanticAnalyzer::visit(ProgramNode &p_program) {
     m_returned_type_stack.push(p_program.getTypePtr());
 
     auto success = m_symbol_manager.addSymbol(
-        p_program.getName(), SymbolEntry::KindEnum::kProgramKind,
+        p_program.getIdentifier(), SymbolEntry::KindEnum::kProgramKind,
         p_program.getTypePtr(), static_cast<Constant *>(nullptr));
     if (!success) {
         logSemanticError(p_program.getLocation(), kRedeclaredSymbolErrorMessage,
@@ -53,7 +54,7 @@ SemanticAnalyzer::determineVarKind(const VariableNode &p_variable) {
 SymbolEntry *SemanticAnalyzer::addSymbol(const VariableNode &p_variable) {
     auto kind = determineVarKind(p_variable);
 
-    auto *entry = m_symbol_manager.addSymbol(p_variable.getName(), kind,
+    auto *entry = m_symbol_manager.addSymbol(p_variable.getIdentifier(), kind,
                                              p_variable.getTypePtr(),
                                              p_variable.getConstantPtr());
     if (!entry) {
@@ -88,6 +89,7 @@ static bool validateDimensions(const VariableNode &p_variable) {
 
 void SemanticAnalyzer::visit(VariableNode &p_variable) {
     auto *entry = addSymbol(p_variable);
+    p_variable.setSymbolEntry(entry);
 
     p_variable.visitChildNodes(*this);
 
@@ -98,13 +100,13 @@ void SemanticAnalyzer::visit(VariableNode &p_variable) {
 }
 
 void SemanticAnalyzer::visit(ConstantValueNode &p_constant_value) {
-    p_constant_value.setInferredType(
-        p_constant_value.getTypePtr()->getStructElementType(0));
+    p_constant_value.setInferredType(p_constant_value.getTypePtr());
 }
 
 void SemanticAnalyzer::visit(FunctionNode &p_function) {
+    TRACE_SPAN("sema", "function", p_function.getNameCString());
     auto success = m_symbol_manager.addSymbol(
-        p_function.getName(), SymbolEntry::KindEnum::kFunctionKind,
+        p_function.getIdentifier(), SymbolEntry::KindEnum::kFunctionKind,
         p_function.getTypePtr(), &p_function.getParameters());
     if (!success) {
         logSemanticError(p_function.getLocation(),
@@ -112,6 +114,7 @@ void SemanticAnalyzer::visit(FunctionNode &p_function) {
                          p_function.getNameCString());
         m_has_error = true;
     }
+    p_function.setSymbolEntry(success);
 
     m_symbol_manager.pushScope();
     m_context_stack.push(SemanticContext::kFunction);
@@ -225,6 +228,9 @@ static bool validateBinaryOperands(BinaryOperatorNode &p_bin_op) {
         break;
     case Operator::kAndOp:
     case Operator::kOrOp:
+        // Both operands have to be boolean: and/or short-circuit, so the
+        // right operand (and any call in it) only runs when the left one
+        // does not decide the result.
         if (validateOperandsInBooleanOp(left_type_ptr, right_type_ptr)) {
             return true;
         }
@@ -258,24 +264,24 @@ static void setBinaryOpInferredType(BinaryOperatorNode &p_bin_op) {
     case Operator::kDivideOp:
         if (p_bin_op.getLeftOperand().getInferredType()->isString()) {
             p_bin_op.setInferredType(
-                new PType(PType::PrimitiveTypeEnum::kStringType));
+                PType::get(PType::PrimitiveTypeEnum::kStringType));
             return;
         }
 
         if (p_bin_op.getLeftOperand().getInferredType()->isReal() ||
             p_bin_op.getRightOperand().getInferredType()->isReal()) {
             p_bin_op.setInferredType(
-                new PType(PType::PrimitiveTypeEnum::kRealType));
+                PType::get(PType::PrimitiveTypeEnum::kRealType));
             return;
         }
     case Operator::kModOp:
         p_bin_op.setInferredType(
-            new PType(PType::PrimitiveTypeEnum::kIntegerType));
+            PType::get(PType::PrimitiveTypeEnum::kIntegerType));
         return;
     case Operator::kAndOp:
     case Operator::kOrOp:
         p_bin_op.setInferredType(
-            new PType(PType::PrimitiveTypeEnum::kBoolType));
+            PType::get(PType::PrimitiveTypeEnum::kBoolType));
         return;
     case Operator::kLessOp:
     case Operator::kLessOrEqualOp:
@@ -284,7 +290,7 @@ static void setBinaryOpInferredType(BinaryOperatorNode &p_bin_op) {
     case Operator::kGreaterOrEqualOp:
     case Operator::kNotEqualOp:
         p_bin_op.setInferredType(
-            new PType(PType::PrimitiveTypeEnum::kBoolType));
+            PType::get(PType::PrimitiveTypeEnum::kBoolType));
         return;
     default:
         assert(false && "unknown binary op or unary op");
@@ -332,11 +338,11 @@ static bool validateUnaryOperand(const UnaryOperatorNode &p_un_op) {
 static void setUnaryOpInferredType(UnaryOperatorNode &p_un_op) {
     switch (p_un_op.getOp()) {
     case Operator::kNegOp:
-        p_un_op.setInferredType(new PType(
+        p_un_op.setInferredType(PType::get(
             p_un_op.getOperand().getInferredType()->getPrimitiveType()));
         return;
     case Operator::kNotOp:
-        p_un_op.setInferredType(new PType(PType::PrimitiveTypeEnum::kBoolType));
+        p_un_op.setInferredType(PType::get(PType::PrimitiveTypeEnum::kBoolType));
         return;
     default:
         assert(false && "unknown binary op or unary op");
@@ -356,7 +362,7 @@ void SemanticAnalyzer::visit(UnaryOperatorNode &p_un_op) {
 
 static const SymbolEntry *
 checkSymbolExistence(const SymbolManager &p_symbol_manager,
-                     const std::string &p_name, const Location &p_location) {
+                     const Identifier p_name, const Location &p_location) {
     const auto *entry = p_symbol_manager.lookup(p_name);
 
     if (entry == nullptr) {
@@ -422,7 +428,7 @@ static void
 setFuncInvocationInferredType(FunctionInvocationNode &p_func_invocation,
                               const SymbolEntry *p_entry) {
     p_func_invocation.setInferredType(
-        new PType(p_entry->getTypePtr()->getPrimitiveType()));
+        PType::get(p_entry->getTypePtr()->getPrimitiveType()));
 }
 
 void SemanticAnalyzer::visit(FunctionInvocationNode &p_func_invocation) {
@@ -430,11 +436,12 @@ void SemanticAnalyzer::visit(FunctionInvocationNode &p_func_invocation) {
 
     const SymbolEntry *entry = nullptr;
     if ((entry = checkSymbolExistence(
-             m_symbol_manager, p_func_invocation.getName(),
+             m_symbol_manager, p_func_invocation.getIdentifier(),
              p_func_invocation.getLocation())) == nullptr) {
         m_has_error = true;
         return;
     }
+    p_func_invocation.setSymbolEntry(entry);
 
     if (!validateFunctionInvocationKind(entry->getKind(), p_func_invocation)) {
         m_has_error = true;
@@ -498,10 +505,11 @@ void SemanticAnalyzer::visit(VariableReferenceNode &p_variable_ref) {
 
     const SymbolEntry *entry = nullptr;
     if ((entry =
-             checkSymbolExistence(m_symbol_manager, p_variable_ref.getName(),
+             checkSymbolExistence(m_symbol_manager, p_variable_ref.getIdentifier(),
                                   p_variable_ref.getLocation())) == nullptr) {
         return;
     }
+    p_variable_ref.setSymbolEntry(entry);
 
     if (!validateVariableKind(entry->getKind(), p_variable_ref)) {
         return;
@@ -540,7 +548,7 @@ static bool validateAssignmentLvalue(const AssignmentNode &p_assignment,
         return false;
     }
 
-    const auto *const entry = p_symbol_manager.lookup(lvalue.getName());
+    const auto *const entry = p_symbol_manager.lookup(lvalue.getIdentifier());
     if (entry->getKind() == SymbolEntry::KindEnum::kConstantKind) {
         logSemanticError(lvalue.getLocation(),
                          "cannot assign to variable '%s' which is a constant",
@@ -614,7 +622,7 @@ static bool validateReadTarget(const ReadNode &p_read,
     }
 
     const auto *const entry =
-        p_symbol_manager.lookup(p_read.getTarget().getName());
+        p_symbol_manager.lookup(p_read.getTarget().getIdentifier());
     assert(entry && "Shouldn't reach here. This should be catched during the"
                     "visits of child nodes");
 
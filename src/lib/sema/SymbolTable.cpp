@@ -1,4 +1,6 @@
 #include "sema/SymbolTable.hpp"
+#include "AST/Console.hpp"
+#include "AST/Tracer.hpp"
 
 #include <algorithm>
 #include <cassert>
@@ -28,7 +30,7 @@ const FunctionNode::DeclNodes *Attribute::parameters() const {
 // ===========================================
 // > SymbolTable
 // ===========================================
-SymbolEntry *SymbolTable::addSymbol(const std::string &p_name,
+SymbolEntry *SymbolTable::addSymbol(const Identifier p_name,
                                     const SymbolEntry::KindEnum kind,
                                     const size_t level,
                                     const PType *const p_type,
@@ -39,7 +41,7 @@ SymbolEntry *SymbolTable::addSymbol(const std::string &p_name,
 }
 
 SymbolEntry *
-SymbolTable::addSymbol(const std::string &p_name,
+SymbolTable::addSymbol(const Identifier p_name,
                        const SymbolEntry::KindEnum kind, const size_t level,
                        const PType *const p_type,
                        const FunctionNode::DeclNodes *const p_parameters) {
@@ -48,6 +50,86 @@ SymbolTable::addSymbol(const std::string &p_name,
     return m_entries.back().get();
 }
 
+// ===========================================
+// > SymbolHashTable
+// ===========================================
+SymbolHashTable::SymbolHashTable() : m_slots(64, Slot{Identifier(), nullptr}) {}
+
+size_t SymbolHashTable::getHomeSlot(const Identifier p_name) const {
+    // interned names are pointers; scramble them (Fibonacci hashing) so that
+    // neighbouring allocations do not pile up in neighbouring slots
+    const uint64_t hash = Identifier::Hash()(p_name) * 0x9E3779B97F4A7C15ull;
+    return (hash >> 32) & (m_slots.size() - 1);
+}
+
+// the slot holding p_name, or the free slot where it would go
+size_t SymbolHashTable::findSlot(const Identifier p_name) const {
+    const size_t mask = m_slots.size() - 1;
+    size_t index = getHomeSlot(p_name);
+    while (m_slots[index].entry && m_slots[index].name != p_name) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+SymbolEntry *SymbolHashTable::find(const Identifier p_name) const {
+    return m_slots[findSlot(p_name)].entry;
+}
+
+void SymbolHashTable::assign(const Identifier p_name,
+                             SymbolEntry *const p_entry) {
+    assert(p_entry && "use erase() to remove a name");
+
+    auto &slot = m_slots[findSlot(p_name)];
+    if (slot.entry) {
+        slot.entry = p_entry;
+        return;
+    }
+
+    slot.name = p_name;
+    slot.entry = p_entry;
+    // keep the load factor under 1/2
+    if (++m_size * 2 > m_slots.size()) {
+        grow();
+    }
+}
+
+void SymbolHashTable::erase(const Identifier p_name) {
+    const size_t mask = m_slots.size() - 1;
+    size_t hole = findSlot(p_name);
+    if (!m_slots[hole].entry) {
+        return;
+    }
+    m_slots[hole].entry = nullptr;
+    --m_size;
+
+    // Backward shift deletion: move later members of the probe sequence into
+    // the hole so that no tombstones are needed.
+    for (size_t index = (hole + 1) & mask; m_slots[index].entry;
+         index = (index + 1) & mask) {
+        const size_t home = getHomeSlot(m_slots[index].name);
+        // the entry can move iff its home is not cyclically in (hole, index]
+        const bool home_in_between = (hole <= index)
+                                         ? (hole < home && home <= index)
+                                         : (hole < home || home <= index);
+        if (!home_in_between) {
+            m_slots[hole] = m_slots[index];
+            m_slots[index].entry = nullptr;
+            hole = index;
+        }
+    }
+}
+
+void SymbolHashTable::grow() {
+    std::vector<Slot> old_slots(m_slots.size() * 2, Slot{Identifier(), nullptr});
+    old_slots.swap(m_slots);
+    for (const auto &slot : old_slots) {
+        if (slot.entry) {
+            m_slots[findSlot(slot.name)] = slot;
+        }
+    }
+}
+
 // ===========================================
 // > SymbolManager
 // ===========================================
@@ -58,6 +140,7 @@ void SymbolManager::pushGlobalScope() {
 }
 
 void SymbolManager::pushScope() {
+    TRACE_SPAN("sema", "push scope");
     SymbolTable *new_table = new SymbolTable();
 
     assert(new_table != nullptr && "Fail to allocate memory for SymbolTable");
@@ -76,12 +159,14 @@ static void dumpSymbolTable(const SymbolTable *const table) {
     static const char *kKindStrings[] = {"program",  "function", "parameter",
                                          "variable", "loop_var", "constant"};
 
-    std::printf("=========================================================="
-                "====================================================\n");
-    std::printf("%-33s%-11s%-11s%-17s%-11s\n", "Name", "Kind", "Level", "Type",
-                "Attribute");
-    std::printf("----------------------------------------------------------"
-                "----------------------------------------------------\n");
+    std::fprintf(Console::out(),
+                 "=========================================================="
+                 "====================================================\n");
+    std::fprintf(Console::out(), "%-33s%-11s%-11s%-17s%-11s\n", "Name", "Kind",
+                 "Level", "Type", "Attribute");
+    std::fprintf(Console::out(),
+                 "----------------------------------------------------------"
+                 "----------------------------------------------------\n");
 
     std::string type_string;
     auto construct_attr_string = [&type_string](const auto &p_entry_ptr) {
@@ -103,20 +188,23 @@ static void dumpSymbolTable(const SymbolTable *const table) {
     };
 
     auto dump_entry = [&](const auto &p_entry_ptr) {
-        std::printf("%-33s", p_entry_ptr->getNameCString());
-        std::printf("%-11s",
-                    kKindStrings[static_cast<size_t>(p_entry_ptr->getKind())]);
-        std::printf("%lu%-10s", p_entry_ptr->getLevel(),
-                    (p_entry_ptr->getLevel() != 0) ? "(local)" : "(global)");
-        std::printf("%-17s", p_entry_ptr->getTypePtr()->getPTypeCString());
-        std::printf("%-11s\n", construct_attr_string(p_entry_ptr));
+        std::fprintf(Console::out(), "%-33s", p_entry_ptr->getNameCString());
+        std::fprintf(Console::out(), "%-11s",
+                     kKindStrings[static_cast<size_t>(p_entry_ptr->getKind())]);
+        std::fprintf(Console::out(), "%lu%-10s", p_entry_ptr->getLevel(),
+                     (p_entry_ptr->getLevel() != 0) ? "(local)" : "(global)");
+        std::fprintf(Console::out(), "%-17s",
+                     p_entry_ptr->getTypePtr()->getPTypeCString());
+        std::fprintf(Console::out(), "%-11s\n",
+                     construct_attr_string(p_entry_ptr));
     };
 
     for_each(table->getEntries().begin(), table->getEntries().end(),
              dump_entry);
 
-    std::printf("----------------------------------------------------------"
-                "----------------------------------------------------\n");
+    std::fprintf(Console::out(),
+                 "----------------------------------------------------------"
+                 "----------------------------------------------------\n");
 }
 
 void SymbolManager::reconstructHashTableFromSymbolTable(
@@ -126,23 +214,12 @@ void SymbolManager::reconstructHashTableFromSymbolTable(
     }
 
     auto construct_entry_on_hash_map = [&](const auto &p_entry_ptr) {
-        auto existence_pair =
-            checkExistence(p_entry_ptr->getName(), p_entry_ptr->getLevel());
-
-        // No need to care existence_pair.first since it's for semantic check.
-        // In the reconstruction, the whole symbol tables have been constructed
+        // No need to check the existence since it's for semantic check. In
+        // the reconstruction, the whole symbol tables have been constructed
         // before.
-
-        if (existence_pair.second) {
-            m_hidden_entries[p_entry_ptr->getName()].push(
-                existence_pair.second);
-            m_hash_entries[p_entry_ptr->getName()] = p_entry_ptr.get();
-        } else {
-            m_hash_entries.emplace(
-                std::piecewise_construct,
-                std::forward_as_tuple(p_entry_ptr->getName()),
-                std::forward_as_tuple(p_entry_ptr.get()));
-        }
+        p_entry_ptr->setHiddenEntry(
+            m_hash_entries.find(p_entry_ptr->getIdentifier()));
+        m_hash_entries.assign(p_entry_ptr->getIdentifier(), p_entry_ptr.get());
     };
 
     for_each(p_table->getEntries().begin(), p_table->getEntries().end(),
@@ -156,21 +233,16 @@ void SymbolManager::removeSymbolsFromHashTable(
     }
 
     auto remove_entry_from_hash_map = [&](const auto &p_entry_ptr) {
-        auto hash_search_result = m_hash_entries.find(p_entry_ptr->getName());
-        assert(hash_search_result != m_hash_entries.end() &&
+        assert(m_hash_entries.find(p_entry_ptr->getIdentifier()) ==
+                   p_entry_ptr.get() &&
                "CANNOT remove the symbol that doesn't exist");
 
-        auto stack_search_result =
-            m_hidden_entries.find(p_entry_ptr->getName());
-        if (stack_search_result != m_hidden_entries.end()) {
-            auto &prev_entry_stack = stack_search_result->second;
-            m_hash_entries[p_entry_ptr->getName()] = prev_entry_stack.top();
-            prev_entry_stack.pop();
-            if (prev_entry_stack.empty()) {
-                m_hidden_entries.erase(stack_search_result);
-            }
+        auto *hidden_entry = p_entry_ptr->getHiddenEntry();
+        if (hidden_entry) {
+            m_hash_entries.assign(p_entry_ptr->getIdentifier(), hidden_entry);
+            p_entry_ptr->setHiddenEntry(nullptr);
         } else {
-            m_hash_entries.erase(hash_search_result);
+            m_hash_entries.erase(p_entry_ptr->getIdentifier());
         }
     };
 
@@ -194,6 +266,7 @@ void SymbolManager::prevScope() {
 }
 
 void SymbolManager::popScope() {
+    TRACE_SPAN("sema", "pop scope");
     if (!m_current_table) {
         assert(false && "Shouldn't popScope() without pushing any scope");
         return;
@@ -205,13 +278,11 @@ void SymbolManager::popScope() {
 }
 
 std::pair<bool, SymbolEntry *>
-SymbolManager::checkExistence(const std::string &p_name,
+SymbolManager::checkExistence(const Identifier p_name,
                               const size_t current_level) const {
-    auto search_result = m_hash_entries.find(p_name);
-
-    if (search_result != m_hash_entries.end()) {
-        SymbolEntry *old_entry = search_result->second;
+    SymbolEntry *old_entry = m_hash_entries.find(p_name);
 
+    if (old_entry) {
         if (old_entry->getLevel() == current_level ||
             old_entry->getKind() == SymbolEntry::KindEnum::kLoopVarKind) {
             return std::make_pair(true, old_entry);
@@ -225,7 +296,7 @@ SymbolManager::checkExistence(const std::string &p_name,
 
 template <typename AttributeType>
 SymbolEntry *
-genericAddSymbol(SymbolManager &p_manager, const std::string &p_name,
+genericAddSymbol(SymbolManager &p_manager, const Identifier p_name,
                  const SymbolEntry::KindEnum kind, const PType *const p_type,
                  const AttributeType *const p_attribute) {
     auto existence_pair =
@@ -238,22 +309,15 @@ genericAddSymbol(SymbolManager &p_manager, const std::string &p_name,
     auto *new_entry = p_manager.m_current_table->addSymbol(
         p_name, kind, p_manager.m_current_level, p_type, p_attribute);
 
-    if (existence_pair.second) {
-        // store the old entry
-        p_manager.m_hidden_entries[p_name].push(existence_pair.second);
-
-        // replace symbol in outer scope
-        p_manager.m_hash_entries[p_name] = new_entry;
-    } else {
-        p_manager.m_hash_entries.emplace(std::piecewise_construct,
-                                         std::forward_as_tuple(p_name),
-                                         std::forward_as_tuple(new_entry));
-    }
+    // hide (and remember) the symbol of an outer scope, if any
+    new_entry->setHiddenEntry(existence_pair.second);
+    p_manager.m_hash_entries.assign(p_name, new_entry);
+    ++p_manager.m_num_symbols;
 
     return new_entry;
 }
 
-SymbolEntry *SymbolManager::addSymbol(const std::string &p_name,
+SymbolEntry *SymbolManager::addSymbol(const Identifier p_name,
                                       const SymbolEntry::KindEnum kind,
                                       const PType *const p_type,
                                       const Constant *const p_constant) {
@@ -261,7 +325,7 @@ SymbolEntry *SymbolManager::addSymbol(const std::string &p_name,
 }
 
 SymbolEntry *
-SymbolManager::addSymbol(const std::string &p_name,
+SymbolManager::addSymbol(const Identifier p_name,
                          const SymbolEntry::KindEnum kind,
                          const PType *const p_type,
                          const FunctionNode::DeclNodes *const p_parameters) {
@@ -269,11 +333,6 @@ SymbolManager::addSymbol(const std::string &p_name,
                                                      p_type, p_parameters);
 }
 
-const SymbolEntry *SymbolManager::lookup(const std::string &p_name) const {
-    auto search_result = m_hash_entries.find(p_name);
-
-    if (search_result != m_hash_entries.end()) {
-        return search_result->second;
-    }
-    return nullptr;
+const SymbolEntry *SymbolManager::lookup(const Identifier p_name) const {
+    return m_hash_entries.find(p_name);
 }
@@ -1,28 +1,31 @@
+#include "AST/Console.hpp"
+#include "AST/SourceBuffer.hpp"
 #include "AST/ast.hpp"
 
 #include <cstdarg>
 #include <cstdio>
 
-extern FILE *yyin;
-extern long line_positions[];
-
 void logSemanticError(const Location &p_location, const char *format, ...) {
-    std::fprintf(stderr, "<Error> Found in line %u, column %u: ",
+    std::fprintf(Console::err(), "<Error> Found in line %u, column %u: ",
                  p_location.line, p_location.col);
 
     va_list args;
     va_start(args, format);
-    std::vfprintf(stderr, format, args);
+    std::vfprintf(Console::err(), format, args);
     va_end(args);
 
     // print notation
     constexpr uint32_t kIndentionWidth = 4;
-    if (std::fseek(yyin, line_positions[p_location.line], SEEK_SET) == 0) {
-        char buffer[512];
-        std::fgets(buffer, sizeof(buffer), yyin);
-        std::fprintf(stderr, "\n%*s%s", kIndentionWidth, "", buffer);
-        std::fprintf(stderr, "%*s\n", kIndentionWidth + p_location.col, "^");
+    const auto *source = SourceBuffer::getCurrent();
+    const char *line_begin;
+    size_t line_length;
+    if (source && source->getLine(p_location.line, line_begin, line_length)) {
+        std::fprintf(Console::err(), "\n%*s%.*s\n", kIndentionWidth, "",
+                     static_cast<int>(line_length), line_begin);
+        std::fprintf(Console::err(), "%*s\n", kIndentionWidth + p_location.col,
+                     "^");
     } else {
-        std::fprintf(stderr, "Fail to reposition the yyin file stream.\n");
+        std::fprintf(Console::err(), "Fail to locate line %u in the source.\n",
+                     p_location.line);
     }
 }
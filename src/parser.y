@@ -19,13 +19,15 @@
 #include "AST/for.hpp"
 #include "AST/return.hpp"
 
-#include "sema/SemanticAnalyzer.hpp"
-#include "codegen/CodeGenerator.hpp"
-
 #include "AST/constant.hpp"
 #include "AST/operator.hpp"
 
-#include "AST/AstDumper.hpp"
+#include "AST/AstArena.hpp"
+#include "AST/Console.hpp"
+
+#include "driver/Driver.hpp"
+#include "driver/Server.hpp"
+#include "driver/ServerProtocol.hpp"
 
 #include <cassert>
 #include <errno.h>
@@ -33,36 +35,39 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
 
-#define YYLTYPE yyltype
-
-typedef struct YYLTYPE {
-    uint32_t first_line;
-    uint32_t first_column;
-    uint32_t last_line;
-    uint32_t last_column;
-} yyltype;
-
-extern int32_t line_num;  /* declared in scanner.l */
-extern char buffer[];     /* declared in scanner.l */
-extern uint32_t opt_dmp;  /* declared in scanner.l */
-extern FILE *yyin;        /* declared by lex */
-extern char *yytext;      /* declared by lex */
-
-static AstNode *root;
-
-extern "C" int yylex(void);
-static void yyerror(const char *msg);
-extern int yylex_destroy(void);
 %}
 
 %code requires {
+    #include "AST/Identifier.hpp"
     #include "AST/utils.hpp"
     #include "AST/PType.hpp"
 
+    #include <cstdint>
     #include <vector>
     #include <memory>
 
+    #define YYLTYPE yyltype
+
+    typedef struct YYLTYPE {
+        uint32_t first_line;
+        uint32_t first_column;
+        uint32_t last_line;
+        uint32_t last_column;
+    } yyltype;
+    // Lets bison grow its stacks by copying; otherwise it cannot in C++
+    // and gives up on anything nested more than about 30 deep.
+    #define YYLTYPE_IS_TRIVIAL 1
+
+    #ifndef YY_TYPEDEF_YY_SCANNER_T
+    #define YY_TYPEDEF_YY_SCANNER_T
+    typedef void *yyscan_t;
+    #endif
+
+    class CompilationContext;
     class AstNode;
     class DeclNode;
     class ConstantValueNode;
@@ -71,10 +76,29 @@ extern int yylex_destroy(void);
     class ExpressionNode;
 }
 
+    /* Reentrant: the scanner and the compilation are passed around
+       instead of living in globals. */
+%define api.pure full
+%locations
+%lex-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {CompilationContext &context}
+
+%code {
+    #include "driver/CompilationContext.hpp"
+
+    int yylex(YYSTYPE *yylval, YYLTYPE *yylloc, yyscan_t scanner);
+    static void yyerror(YYLTYPE *p_location, yyscan_t scanner,
+                        CompilationContext &context, const char *msg);
+
+    // defined in scanner.l
+    bool createScanner(CompilationContext &p_context, yyscan_t &p_scanner);
+    int yylex_destroy(yyscan_t scanner);
+}
+
     /* For yylval */
 %union {
     /* basic semantic value */
-    char *identifier;
+    Identifier identifier;
     uint32_t integer;
     double real;
     char *string;
@@ -83,7 +107,7 @@ extern int yylex_destroy(void);
     int32_t sign;
 
     AstNode *node;
-    PType *type_ptr;
+    const PType *type_ptr;
     DeclNode *decl_ptr;
     CompoundStatementNode *compound_stmt_ptr;
     ConstantValueNode *constant_value_node_ptr;
@@ -120,6 +144,15 @@ extern int yylex_destroy(void);
 %type <nodes_ptr> StatementList Statements
 %type <exprs_ptr> ExpressionList Expressions ArrRefList ArrRefs
 
+    /* What is left on the stack when a syntax error abandons the parse.
+       The nodes go back to the arena with it, but their destructors still
+       have to run for what they and the lists keep on the heap. */
+%destructor { delete $$; } <node> <decl_ptr> <compound_stmt_ptr>
+%destructor { delete $$; } <constant_value_node_ptr> <func_ptr> <expr_ptr>
+%destructor { delete $$; } <decls_ptr> <ids_ptr> <dimensions_ptr>
+%destructor { delete $$; } <funcs_ptr> <nodes_ptr> <exprs_ptr>
+%destructor { free($$); } <string>
+
     /* Follow the order in scanner.l */
 
     /* Delimiter */
@@ -153,6 +186,9 @@ extern int yylex_destroy(void);
 %token REAL_LITERAL
 %token STRING_LITERAL
 
+    /* Returned by the scanner for a bad character, never accepted */
+%token BAD_CHARACTER
+
 %%
 
 Program:
@@ -161,11 +197,11 @@ Program:
     DeclarationList FunctionList CompoundStatement
     /* End of ProgramBody */
     END {
-        root = new ProgramNode(@1.first_line, @1.first_column,
-                               $1, new PType(PType::PrimitiveTypeEnum::kVoidType),
-                               *$3, *$4, $5);
-
-        free($1);
+        context.setRoot(new ProgramNode(
+            @1.first_line, @1.first_column, $1,
+            PType::get(PType::PrimitiveTypeEnum::kVoidType), *$3, *$4, $5));
+        delete $3;
+        delete $4;
     }
 ;
 
@@ -222,7 +258,6 @@ Function:
 FunctionDeclaration:
     FunctionName L_PARENTHESIS FormalArgList R_PARENTHESIS ReturnType SEMICOLON {
         $$ = new FunctionNode(@1.first_line, @1.first_column, $1, *$3, $5, nullptr);
-        free($1);
         delete $3;
     }
 ;
@@ -232,7 +267,6 @@ FunctionDefinition:
     CompoundStatement
     END {
         $$ = new FunctionNode(@1.first_line, @1.first_column, $1, *$3, $5, $6);
-        free($1);
         delete $3;
     }
 ;
@@ -272,12 +306,10 @@ IdList:
     ID {
         $$ = new std::vector<IdInfo>();
         $$->emplace_back(@1.first_line, @1.first_column, $1);
-        free($1);
     }
     |
     IdList COMMA ID {
         $1->emplace_back(@3.first_line, @3.first_column, $3);
-        free($3);
         $$ = $1;
     }
 ;
@@ -288,7 +320,7 @@ ReturnType:
     }
     |
     Epsilon {
-        $$ = new PType(PType::PrimitiveTypeEnum::kVoidType);
+        $$ = PType::get(PType::PrimitiveTypeEnum::kVoidType);
     }
 ;
 
@@ -314,22 +346,21 @@ Type:
     ArrType
 ;
 
-    /* no need to release PType object since it'll be assigned to the shared_ptr */
+    /* types are interned, nothing to release */
 ScalarType:
-    INTEGER { $$ = new PType(PType::PrimitiveTypeEnum::kIntegerType); }
+    INTEGER { $$ = PType::get(PType::PrimitiveTypeEnum::kIntegerType); }
     |
-    REAL { $$ = new PType(PType::PrimitiveTypeEnum::kRealType); }
+    REAL { $$ = PType::get(PType::PrimitiveTypeEnum::kRealType); }
     |
-    STRING { $$ = new PType(PType::PrimitiveTypeEnum::kStringType); }
+    STRING { $$ = PType::get(PType::PrimitiveTypeEnum::kStringType); }
     |
-    BOOLEAN { $$ = new PType(PType::PrimitiveTypeEnum::kBoolType); }
+    BOOLEAN { $$ = PType::get(PType::PrimitiveTypeEnum::kBoolType); }
 ;
 
 ArrType:
     ArrDecl ScalarType {
-        $2->setDimensions(*$1);
+        $$ = PType::get($2->getPrimitiveType(), *$1);
         delete $1;
-        $$ = $2;
     }
 ;
 
@@ -349,8 +380,7 @@ LiteralConstant:
         Constant::ConstantValue value;
         value.integer = static_cast<int64_t>($1) * static_cast<int64_t>($2);
         auto * const constant = new Constant(
-            std::make_shared<PType>(
-				PType::PrimitiveTypeEnum::kIntegerType),
+            PType::get(PType::PrimitiveTypeEnum::kIntegerType),
             value);
         auto * const pos = ($1 == 1) ? &@2 : &@1;
         // no need to release constant object since it'll be assigned to the unique_ptr
@@ -361,8 +391,7 @@ LiteralConstant:
         Constant::ConstantValue value;
         value.real = static_cast<double>($1) * static_cast<double>($2);
         auto * const constant = new Constant(
-            std::make_shared<PType>(
-                PType::PrimitiveTypeEnum::kRealType),
+            PType::get(PType::PrimitiveTypeEnum::kRealType),
             value);
         auto * const pos = ($1 == 1) ? &@2 : &@1;
         // no need to release constant object since it'll be assigned to the unique_ptr
@@ -387,8 +416,7 @@ StringAndBoolean:
         Constant::ConstantValue value;
         value.string = $1;
         auto * const constant = new Constant(
-            std::make_shared<PType>(
-                PType::PrimitiveTypeEnum::kStringType),
+            PType::get(PType::PrimitiveTypeEnum::kStringType),
             value);
         $$ = new ConstantValueNode(@1.first_line, @1.first_column, constant);
     }
@@ -397,8 +425,7 @@ StringAndBoolean:
         Constant::ConstantValue value;
         value.boolean = $1;
         auto * const constant = new Constant(
-            std::make_shared<PType>(
-                PType::PrimitiveTypeEnum::kBoolType),
+            PType::get(PType::PrimitiveTypeEnum::kBoolType),
             value);
         $$ = new ConstantValueNode(@1.first_line, @1.first_column, constant);
     }
@@ -407,8 +434,7 @@ StringAndBoolean:
         Constant::ConstantValue value;
         value.boolean = $1;
         auto * const constant = new Constant(
-            std::make_shared<PType>(
-                PType::PrimitiveTypeEnum::kBoolType),
+            PType::get(PType::PrimitiveTypeEnum::kBoolType),
             value);
         $$ = new ConstantValueNode(@1.first_line, @1.first_column, constant);
     }
@@ -419,8 +445,7 @@ IntegerAndReal:
         Constant::ConstantValue value;
         value.integer = static_cast<int64_t>($1);
         auto * const constant = new Constant(
-            std::make_shared<PType>(
-				PType::PrimitiveTypeEnum::kIntegerType),
+            PType::get(PType::PrimitiveTypeEnum::kIntegerType),
             value);
         // no need to release constant object since it'll be assigned to the unique_ptr
         $$ = new ConstantValueNode(@1.first_line, @1.first_column, constant);
@@ -430,8 +455,7 @@ IntegerAndReal:
         Constant::ConstantValue value;
         value.real = static_cast<double>($1);
         auto * const constant = new Constant(
-            std::make_shared<PType>(
-                PType::PrimitiveTypeEnum::kRealType),
+            PType::get(PType::PrimitiveTypeEnum::kRealType),
             value);
         // no need to release constant object since it'll be assigned to the unique_ptr
         $$ = new ConstantValueNode(@1.first_line, @1.first_column, constant);
@@ -489,7 +513,6 @@ Simple:
 VariableReference:
     ID ArrRefList {
         $$ = new VariableReferenceNode(@1.first_line, @1.first_column, $1, *$2);
-        free($1);
         delete $2;
     }
 ;
@@ -553,14 +576,14 @@ For:
         // DeclNode
         auto *ids = new std::vector<IdInfo>{IdInfo(@2.first_line, @2.first_column,
                                                    $2)};
-        auto *type = new PType(PType::PrimitiveTypeEnum::kIntegerType);
+        auto *type = PType::get(PType::PrimitiveTypeEnum::kIntegerType);
         auto *var_decl = new DeclNode(@2.first_line, @2.first_column, ids, type);
 
         // AssignmentNode
         auto *var_ref = new VariableReferenceNode(@2.first_line, @2.first_column, $2);
         value.integer = static_cast<int64_t>($4);
         constant = new Constant(
-            std::make_shared<PType>(PType::PrimitiveTypeEnum::kIntegerType),
+            PType::get(PType::PrimitiveTypeEnum::kIntegerType),
             value);
         constant_value_node = new ConstantValueNode(@4.first_line, @4.first_column,
                                                     constant);
@@ -570,7 +593,7 @@ For:
         // ExpressionNode
         value.integer = static_cast<int64_t>($6);
         constant = new Constant(
-            std::make_shared<PType>(PType::PrimitiveTypeEnum::kIntegerType),
+            PType::get(PType::PrimitiveTypeEnum::kIntegerType),
             value);
         constant_value_node = new ConstantValueNode(@6.first_line, @6.first_column,
                                                     constant);
@@ -578,7 +601,6 @@ For:
         $$ = new ForNode(@1.first_line, @1.first_column,
                          var_decl, assignment, constant_value_node,
                          $8);
-        free($2);
         delete ids;
     }
 ;
@@ -596,7 +618,6 @@ FunctionCall:
 FunctionInvocation:
     ID L_PARENTHESIS ExpressionList R_PARENTHESIS {
         $$ = new FunctionInvocationNode(@1.first_line, @1.first_column, $1, *$3);
-        free($1);
         delete $3;
     }
 ;
@@ -738,54 +759,113 @@ Epsilon:
 
 %%
 
-void yyerror(const char *msg) {
-    fprintf(stderr,
+void yyerror(YYLTYPE *p_location, yyscan_t scanner,
+             CompilationContext &context, const char *msg) {
+    const auto &state = context.getScannerState();
+    if (state.has_lexical_error) {
+        // the scanner has reported the bad character already
+        return;
+    }
+
+    // The current line is printed up to and including the unmatched token.
+    // The location is stale at the end of input, after the last newline.
+    int line_length = 0;
+    int token_length = 0;
+    if (p_location->first_line == state.line_num) {
+        line_length = p_location->last_column - 1;
+        token_length = p_location->last_column - p_location->first_column;
+    }
+    fprintf(Console::err(),
             "\n"
             "|-----------------------------------------------------------------"
             "---------\n"
-            "| Error found in Line #%d: %s\n"
+            "| Error found in Line #%d: %.*s\n"
             "|\n"
-            "| Unmatched token: %s\n"
+            "| Unmatched token: %.*s\n"
             "|-----------------------------------------------------------------"
             "---------\n",
-            line_num, buffer, yytext);
-    exit(-1);
+            state.line_num, line_length, state.line_start, token_length,
+            state.line_start + line_length - token_length);
 }
 
-int main(int argc, const char *argv[]) {
-    if (argc < 2) {
-        fprintf(stderr, "Usage: ./compiler <filename> --save-path [save path]\n");
-        exit(-1);
-    }
+bool CompilationContext::parse() {
+    // every AST node comes from here, see AstNode::operator new
+    AstArena::Scope arena_scope(*m_arena);
 
-    yyin = fopen(argv[1], "r");
-    if (yyin == NULL) {
-        perror("fopen() failed:");
+    yyscan_t scanner;
+    if (!createScanner(*this, scanner)) {
+        return false;
     }
+    const int result = yyparse(scanner, *this);
+    yylex_destroy(scanner);
+    return result == 0 && m_root;
+}
 
-    yyparse();
+size_t CompilationContext::countTokens() {
+    yyscan_t scanner;
+    if (!createScanner(*this, scanner)) {
+        return 0;
+    }
 
-    if (argc >= 3 && strcmp(argv[2], "--dump-ast") == 0) {
-        AstDumper ast_dumper;
-        root->accept(ast_dumper);
+    YYSTYPE value;
+    YYLTYPE location;
+    size_t num_tokens = 0;
+    while (yylex(&value, &location, scanner)) {
+        ++num_tokens;
     }
+    yylex_destroy(scanner);
+    return num_tokens;
+}
 
-    SemanticAnalyzer sema_analyzer(opt_dmp);
-    root->accept(sema_analyzer);
+static void usage() {
+    fprintf(stderr, "Usage: ./compiler [-j <jobs>] <filename>... [--dump-ast] "
+                    "[--ssa] [-O0|-O1] [--unroll-budget <n>] [--no-inline] "
+                    "[--inline-report] [--arena-report] [--lex-only] [--quiet] "
+                    "[--time-report[=json]] [--trace-out <file>] "
+                    "[-o <output file>|-] "
+                    "--save-path [save path]\n"
+                    "                  [--cache-dir <dir>] [--cache-size <MiB>] "
+                    "[--cache-stats]\n"
+                    "       ./compiler --serve <socket> [-j <jobs>]\n"
+                    "       -j 0 uses one job per hardware thread, the cache "
+                    "directory defaults to $P2LLVM_CACHE_DIR\n");
+    exit(-1);
+}
 
-    CodeGenerator code_generator(argv[1], (argc == 4) ? argv[3] : "",
-                                 sema_analyzer.getSymbolManager());
-    root->accept(code_generator);
+int main(int argc, const char *argv[]) {
+    DriverOptions options;
+    if (const char *cache_directory = getenv(kCacheDirectoryVariable)) {
+        options.cache_directory = cache_directory;
+    }
+    std::vector<std::string> source_paths;
+    if (!Driver::parseArguments(std::vector<std::string>(argv + 1, argv + argc),
+                                options, source_paths)) {
+        usage();
+    }
+
+    if (!options.serve_socket_path.empty()) {
+        // see compiler-client for the other end
+        Server server(options.serve_socket_path, options.num_jobs);
+        if (!server.run()) {
+            perror("Server::run() failed");
+        }
+        exit(-1);
+    }
 
-    if (!sema_analyzer.hasError()) {
-        printf("\n"
-               "|---------------------------------------------------|\n"
-               "|  There is no syntactic error and semantic error!  |\n"
-               "|---------------------------------------------------|\n");
+    // With "-o -" the module goes to the original stdout, so that it can be
+    // piped into llc; everything the compiler prints (source listing,
+    // tokens, symbol tables, ...) is moved to stderr instead.
+    if (options.output_path == "-") {
+        fflush(stdout);
+        options.ir_stdout_fd = dup(STDOUT_FILENO);
+        dup2(STDERR_FILENO, STDOUT_FILENO);
     }
 
-    delete root;
-    fclose(yyin);
-    yylex_destroy();
-    return 0;
+    Driver driver(options);
+    const int status =
+        source_paths.empty() ? 0 : driver.compileAll(source_paths);
+    if (options.cache_stats) {
+        driver.printCacheStatistics();
+    }
+    return status;
 }
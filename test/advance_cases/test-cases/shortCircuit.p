@@ -0,0 +1,66 @@
+//&S-
+//&T-
+//&D-
+
+shortCircuit;
+
+var calls : integer;
+
+check( x : integer ): boolean
+begin
+    calls := calls + 1;
+    print x;
+    return x > 0;
+end
+end
+
+begin
+
+var i : integer;
+var ok : boolean;
+calls := 0;
+
+// the right operand is skipped once the left one decides the result
+if ( 1 > 2 ) and check( 1 ) then
+begin
+    print 100;
+end
+else
+begin
+    print 200;
+end
+end if
+
+i := 0;
+if i = 0 or check( 2 ) then
+begin
+    print 300;
+end
+end if
+
+ok := i > 0 and check( 3 );
+if not ok then
+begin
+    print 400;
+end
+end if
+
+ok := i < 0 or check( 4 );
+if ok then
+begin
+    print 500;
+end
+end if
+
+// the guard stops calling check() as soon as i reaches 3
+while i < 3 and check( i + 1 ) do
+begin
+    i := i + 1;
+end
+end do
+
+print i;
+print calls;
+
+end
+end
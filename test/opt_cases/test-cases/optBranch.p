@@ -0,0 +1,101 @@
+//&S-
+//&T-
+//&D-
+
+optBranch;
+
+var c: 3;
+var g: integer;
+
+pick(x: integer): integer
+begin
+    if c > 2 then
+    begin
+        return x + c;
+    end
+    else
+    begin
+        return x - c;
+    end
+    end if
+end
+end
+
+// the and/or after the return is never reached
+first(a, b: boolean): boolean
+begin
+    return a;
+    return a and b;
+end
+end
+
+begin
+
+var x: integer;
+var t: boolean;
+
+x := 1;
+if x = 1 then
+begin
+    print 10;
+end
+else
+begin
+    print 20;
+end
+end if
+
+while x < 0 do
+begin
+    print 0;
+    x := x + 1;
+end
+end do
+
+if c * 2 = 6 and x > 0 then
+begin
+    print 30;
+end
+end if
+
+print pick(5);
+
+t := first(true, false);
+if t then
+begin
+    print 1;
+end
+else
+begin
+    print 0;
+end
+end if
+
+if false or c = 3 then
+begin
+    print 40;
+end
+end if
+
+g := 0;
+while g < 3 do
+begin
+    g := g + 1;
+end
+end do
+print g;
+
+// only known at run time
+read x;
+if x = 123 then
+begin
+    print 50;
+end
+else
+begin
+    print 60;
+end
+end if
+
+end
+end
@@ -0,0 +1,42 @@
+//&S-
+//&T-
+//&D-
+
+optCse;
+
+var g: integer;
+
+bump(x: integer): integer
+begin
+    g := g + x;
+    return g;
+end
+end
+
+begin
+
+var a, b, c, d: integer;
+
+// the same expression twice
+read a;
+b := a * 7 + 3;
+c := a * 7 + 3;
+print b + c;
+
+// not once one of its operands has changed
+a := a + 1;
+d := a * 7 + 3;
+print d;
+
+// nor once a call has changed a global it reads
+g := 5;
+c := g * g + g;
+d := bump(2);
+print g * g + g + c;
+print d;
+
+print (a - 4) * (a - 4) - (a - 4);
+print a mod 10 + a mod 10 + a / 4 + a / 4;
+
+end
+end
@@ -0,0 +1,64 @@
+//&S-
+//&T-
+//&D-
+
+optForward;
+
+var g: integer;
+var h: integer;
+
+setg(x: integer): integer
+begin
+    g := x;
+    return 0;
+end
+end
+
+first(a: array 4 of integer): integer
+begin
+    a[0] := a[0] + 1;
+    return a[0];
+end
+end
+
+begin
+
+var x, y: integer;
+var v: array 4 of integer;
+
+// a store forwarded to the load after it
+g := 10;
+h := g + 1;
+print h;
+
+// but not across a call that stores to it
+x := setg(20);
+print g;
+
+v[0] := 1;
+v[1] := 2;
+v[0] := v[0] + v[1];
+print v[0];
+
+// nor across a call that gets the array
+y := first(v);
+print v[0];
+print y;
+
+// nor across a read into it
+read v[2];
+print v[2] + v[1];
+
+// the index is only known once x has been forwarded
+x := 7;
+v[x - 7] := 9;
+print v[0];
+
+// the later store does not change what was loaded before it
+v[3] := 5;
+x := v[3];
+v[3] := 6;
+print x + v[3];
+
+end
+end
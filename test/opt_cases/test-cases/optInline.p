@@ -0,0 +1,88 @@
+//&S-
+//&T-
+//&D-
+
+optInline;
+
+var g: integer;
+
+// two returns, merged by a phi after the call once inlined
+clamp(x, hi: integer): integer
+begin
+    if x > hi then
+    begin
+        return hi;
+    end
+    else
+    begin
+        g := g + 1;
+    end
+    end if
+    return x;
+end
+end
+
+// the array goes to the entry block of the caller, and is zero for
+// nothing: each call stores it before it loads it; b[x mod 2] keeps it an
+// array
+spread(x: integer): integer
+begin
+    var b: array 3 of integer;
+    b[0] := x;
+    b[1] := x * 2;
+    b[2] := b[0] + b[1];
+    return b[2] - b[x mod 2];
+end
+end
+
+// too large to inline, with g unknown to it
+busy(x: integer): integer
+begin
+    var y: integer;
+    y := x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    y := y * g mod 97 + x;
+    return y mod 1000;
+end
+end
+
+begin
+
+var s, t: integer;
+
+s := 0;
+for i := 0 to 10 do
+begin
+    s := s + clamp(i * 3, 12);
+end
+end do
+print s;
+print g;
+
+t := 0;
+for i := 1 to 6 do
+begin
+    t := t + spread(i) * spread(i + 1);
+end
+end do
+print t;
+print clamp(spread(5), 9);
+
+print busy(2);
+
+end
+end
@@ -0,0 +1,127 @@
+//&S-
+//&T-
+//&D-
+
+optLoopNest;
+
+var g: integer;
+
+square(x: integer): integer
+begin
+    g := g + 1;
+    return x * x;
+end
+end
+
+begin
+
+var s, t: integer;
+var a: array 4 of array 5 of integer;
+var b: array 4 of integer;
+var c: array 12 of array 40 of integer;
+
+// a[i][j] walks a row with a pointer once the loop passes are done with it
+for i := 0 to 4 do
+begin
+    for j := 0 to 5 do
+    begin
+        a[i][j] := i * 10 + j;
+    end
+    end do
+end
+end do
+print a[0][0];
+print a[1][2];
+print a[3][4];
+
+// a call and a store in the body
+s := 0;
+for i := 0 to 4 do
+begin
+    for j := 0 to 5 do
+    begin
+        a[i][j] := square(a[i][j]) - i;
+        s := s + a[i][j];
+    end
+    end do
+end
+end do
+print a[2][3];
+print a[3][4];
+print s;
+print g;
+
+// a[2][3] is stored to nowhere in the loop, so it is loaded once before it
+s := 0;
+for j := 0 to 5 do
+begin
+    s := s + a[2][3] * j;
+end
+end do
+print s;
+
+// the load of a[0][0] is invariant but for the store of the first turn
+s := 0;
+for j := 0 to 5 do
+begin
+    a[0][j] := j + 7;
+    s := s + a[0][0];
+end
+end do
+print s;
+
+// the row read is the row written a turn before
+for i := 1 to 4 do
+begin
+    for j := 0 to 5 do
+    begin
+        a[i][j] := a[i - 1][j] + 1;
+    end
+    end do
+end
+end do
+print a[3][0];
+print a[3][4];
+
+// too large to unroll, so the rows stay loops
+for i := 0 to 12 do
+begin
+    for j := 0 to 40 do
+    begin
+        c[i][j] := i * 100 + j;
+    end
+    end do
+end
+end do
+s := 0;
+for i := 0 to 12 do
+begin
+    for j := 1 to 40 do
+    begin
+        c[i][j] := c[i][j - 1] + square(j) mod 7;
+        s := s + c[i][j];
+    end
+    end do
+end
+end do
+print c[0][39];
+print c[5][17];
+print c[11][39];
+print s;
+print g;
+
+// b[0] is stored through in the same loop that loads it
+b[0] := 1;
+t := 0;
+for i := 1 to 4 do
+begin
+    t := t + b[0];
+    b[0] := b[0] * 2;
+    b[i] := t;
+end
+end do
+print t;
+print b[3];
+
+end
+end
@@ -0,0 +1,95 @@
+//&S-
+//&T-
+//&D-
+
+optTailCall;
+
+// the call of itself that is returned right away becomes a branch back
+gcd(a, b: integer): integer
+begin
+    if b = 0 then
+    begin
+        return a;
+    end
+    else
+    begin
+        return gcd(b, a mod b);
+    end
+    end if
+end
+end
+
+// with the sum so far carried in a parameter
+sum(n, acc: integer): integer
+begin
+    if n = 0 then
+    begin
+        return acc;
+    end
+    end if
+    return sum(n - 1, acc + n mod 7);
+end
+end
+
+// not a tail call: the result is added to after the call
+depth(n: integer): integer
+begin
+    if n = 0 then
+    begin
+        return 0;
+    end
+    end if
+    return depth(n - 1) + 1;
+end
+end
+
+// too large to inline, so the calls of it below stay calls
+mix(a, b: integer): integer
+begin
+    var y: integer;
+    y := a mod 97;
+    y := y * 31 mod 97 + b mod 13;
+    y := y * 37 mod 97 + a mod 11;
+    y := y * 41 mod 97 + b mod 7;
+    y := y * 43 mod 97 + a mod 5;
+    y := y * 47 mod 97 + b mod 3;
+    y := y * 53 mod 97 + a mod 17;
+    y := y * 59 mod 97 + b mod 19;
+    y := y * 61 mod 97 + a mod 23;
+    y := y * 67 mod 97 + b mod 29;
+    y := y * 71 mod 97 + a mod 31;
+    y := y * 73 mod 97 + b mod 37;
+    return y;
+end
+end
+
+// same signature as mix: its frame can be reused
+swap(a, b: integer): integer
+begin
+    return mix(b, a);
+end
+end
+
+// a different signature: only a hint
+one(a: integer): integer
+begin
+    return mix(a, a);
+end
+end
+
+begin
+
+var x: integer;
+
+print gcd(1071, 462);
+print gcd(17, 5);
+print gcd(0, 9);
+x := 123;
+print gcd(x * 4, 36);
+print sum(1000, 0);
+print depth(1000);
+print swap(5, 1234);
+print one(77);
+
+end
+end
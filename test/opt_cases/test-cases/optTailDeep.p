@@ -0,0 +1,42 @@
+//&S-
+//&T-
+//&D-
+
+optTailDeep;
+
+// Too deep for the stack as a recursion, so only run at -O1, where it is a
+// loop.
+
+gcd(a, b: integer): integer
+begin
+    if b = 0 then
+    begin
+        return a;
+    end
+    else
+    begin
+        return gcd(b, a mod b);
+    end
+    end if
+end
+end
+
+sum(n, acc: integer): integer
+begin
+    if n = 0 then
+    begin
+        return acc;
+    end
+    end if
+    return sum(n - 1, acc + n mod 7);
+end
+end
+
+begin
+
+// consecutive Fibonacci numbers take the most steps
+print gcd(832040, 514229);
+print sum(1000000, 3);
+
+end
+end
@@ -0,0 +1,106 @@
+//&S-
+//&T-
+//&D-
+
+optUnroll;
+
+begin
+
+var s, k: integer;
+var a: array 101 of integer;
+
+// unrolled fully: one copy of the body per iteration
+s := 0;
+for i := 0 to 7 do
+begin
+    s := s + i * 3;
+end
+end do
+print s;
+
+s := 0;
+for i := 4 to 5 do
+begin
+    s := s + i * 3;
+end
+end do
+print s;
+
+// the body takes 8 of the 256 the budget allows, so 32 iterations are
+// unrolled fully and 33 are not
+s := 0;
+for i := 0 to 32 do
+begin
+    s := s + i * 3;
+end
+end do
+print s;
+
+s := 0;
+for i := 0 to 33 do
+begin
+    s := s + i * 3;
+end
+end do
+print s;
+
+// unrolled by 8 with the iterations over a multiple of 8 peeled in front:
+// 101 = 12 * 8 + 5, 50 = 6 * 8 + 2, 35 = 4 * 8 + 3
+for i := 0 to 101 do
+begin
+    a[i] := i * i mod 13;
+end
+end do
+s := 0;
+for i := 0 to 101 do
+begin
+    s := s + a[i] * (i mod 5);
+end
+end do
+print s;
+
+s := 0;
+for i := 3 to 53 do
+begin
+    s := s + a[i - 3] + i;
+end
+end do
+print s;
+
+s := 0;
+for i := 0 to 35 do
+begin
+    a[i] := a[i] + a[i + 1];
+    s := s + a[i];
+end
+end do
+print s;
+print a[34];
+print a[35];
+
+// no iteration at all
+s := 5;
+k := 10;
+while k < 10 do
+begin
+    s := s + k;
+    k := k + 1;
+end
+end do
+print s;
+print k;
+
+// a while loop is counted as well: 41 = 5 * 8 + 1
+s := 0;
+k := 0;
+while k < 41 do
+begin
+    s := s + k mod 4;
+    k := k + 1;
+end
+end do
+print s;
+print k;
+
+end
+end
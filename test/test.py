@@ -2,6 +2,7 @@
 
 import subprocess
 import os
+import re
 import shutil
 import sys
 import textwrap
@@ -29,9 +30,10 @@ class Grader:
         4 : "advLoop1",
         5 : "advLoop2",
         6 : "argument",
-        7 : "negative"
+        7 : "negative",
+        8 : "shortCircuit"
     }
-    advance_case_scores = [0, 5, 5, 5, 5, 5, 5, 5]
+    advance_case_scores = [0, 5, 5, 5, 5, 5, 5, 5, 5]
     advance_id_list = advance_cases.keys()
 
     bonus_case_dir = "./bonus_cases"
@@ -47,11 +49,51 @@ class Grader:
     bonus_case_scores = [0, 2, 2, 3, 3, 3, 3, 3]
     bonus_id_list = bonus_cases.keys()
 
+    # aimed at the passes of -O1, but the output is the same with any flags
+    opt_case_dir = "./opt_cases"
+    opt_cases = {
+        1 : "optCse",
+        2 : "optForward",
+        3 : "optBranch",
+        4 : "optLoopNest",
+        5 : "optUnroll",
+        6 : "optInline",
+        7 : "optTailCall",
+        8 : "optTailDeep"
+    }
+    opt_case_scores = [0, 3, 3, 3, 3, 3, 3, 3, 3]
+    opt_id_list = opt_cases.keys()
+    # recursions too deep for the stack unless -O1 makes loops of them
+    opt_o1_id_list = [8]
+
+    # what -O1 --inline-report says about the calls of an opt case
+    report_cases = {
+        1 : "optInline"
+    }
+    report_case_scores = [0, 3]
+    report_id_list = report_cases.keys()
+
+    # what the module -O1 makes of an opt case has to look like, see
+    # check_ir() for opt_cases/sample-ir
+    ir_cases = {
+        1 : "optCse",
+        2 : "optForward",
+        3 : "optBranch",
+        4 : "optLoopNest",
+        5 : "optUnroll",
+        6 : "optInline",
+        7 : "optTailCall",
+        8 : "optTailDeep"
+    }
+    ir_case_scores = [0, 2, 2, 2, 2, 2, 2, 2, 2]
+    ir_id_list = ir_cases.keys()
+
     diff_result = ""
 
-    def __init__(self, compiler, save_path, 
+    def __init__(self, compiler, compiler_flags, save_path,
                 executable_file_path, code_result_path, io_file):
         self.compiler = compiler
+        self.compiler_flags = compiler_flags
         self.io_file = io_file
 
         self.save_path = save_path
@@ -77,8 +119,12 @@ class Grader:
             test_case = "%s/%s/%s.p" % (self.advance_case_dir, "test-cases", self.advance_cases[case_id])
         elif case_type == "bonus":
             test_case = "%s/%s/%s.p" % (self.bonus_case_dir, "test-cases", self.bonus_cases[case_id])
+        elif case_type == "opt":
+            test_case = "%s/%s/%s.p" % (self.opt_case_dir, "test-cases", self.opt_cases[case_id])
       
         clist = [self.compiler, test_case, "--save-path", self.save_path]
+        if self.compiler_flags:
+            clist.append(self.compiler_flags)
         cmd = " ".join(clist)
         try:
             proc = subprocess.Popen(cmd, shell=True)
@@ -98,6 +144,9 @@ class Grader:
         elif case_type == "bonus":
             test_case = "%s/%s.ll" % (self.save_path, self.bonus_cases[case_id])
             executable_file = "%s/%s" % (self.executable_file_path, self.bonus_cases[case_id])
+        elif case_type == "opt":
+            test_case = "%s/%s.ll" % (self.save_path, self.opt_cases[case_id])
+            executable_file = "%s/%s" % (self.executable_file_path, self.opt_cases[case_id])
 
         clist = ["clang", test_case, self.io_file, "-o", executable_file]
         cmd = " ".join(clist)
@@ -119,6 +168,9 @@ class Grader:
         elif case_type == "bonus":
             output_file = "%s/%s" % (self.code_result_path, self.bonus_cases[case_id])
             executable_file = "%s/%s" % (self.executable_file_path, self.bonus_cases[case_id])
+        elif case_type == "opt":
+            output_file = "%s/%s" % (self.code_result_path, self.opt_cases[case_id])
+            executable_file = "%s/%s" % (self.executable_file_path, self.opt_cases[case_id])
 
         clist = ["echo", "123", "|", executable_file]
         cmd = " ".join(clist)
@@ -162,6 +214,9 @@ class Grader:
         elif case_type == "bonus":
             output_file = "%s/%s" % (self.code_result_path, self.bonus_cases[case_id])
             solution = "%s/%s/%s" % (self.bonus_case_dir, "sample-solutions", self.bonus_cases[case_id])
+        elif case_type == "opt":
+            output_file = "%s/%s" % (self.code_result_path, self.opt_cases[case_id])
+            solution = "%s/%s/%s" % (self.opt_case_dir, "sample-solutions", self.opt_cases[case_id])
 
         clist = ["diff", "-Z", "-u", output_file, solution, f'--label="your output:({output_file})"', f'--label="answer:({solution})"']
         cmd = " ".join(clist)
@@ -182,6 +237,8 @@ class Grader:
                 self.diff_result += "{}\n".format(self.advance_cases[case_id])
             elif case_type == "bonus":
                 self.diff_result += "{}\n".format(self.bonus_cases[case_id])
+            elif case_type == "opt":
+                self.diff_result += "{}\n".format(self.opt_cases[case_id])
             self.diff_result += "{}\n".format(output)
 
         return retcode == 0
@@ -193,7 +250,146 @@ class Grader:
 
         return self.compare_file_content(case_type, case_id)
 
+    def test_inline_report(self, case_id):
+        test_case = "%s/%s/%s.p" % (self.opt_case_dir, "test-cases", self.report_cases[case_id])
+        output_file = "%s/%s.inline" % (self.code_result_path, self.report_cases[case_id])
+        solution = "%s/%s/%s" % (self.opt_case_dir, "sample-reports", self.report_cases[case_id])
+
+        def inline_lines(flags):
+            clist = [self.compiler, test_case, "--save-path", self.save_path] + flags
+            try:
+                proc = subprocess.run(clist, stdout=subprocess.DEVNULL,
+                                      stderr=subprocess.PIPE)
+            except Exception as e:
+                print("Call of '%s' failed: %s" % (" ".join(clist), e))
+                return None
+            lines = str(proc.stderr, "utf-8").splitlines(True)
+            return [line for line in lines if line.startswith("inline:")]
+
+        report = inline_lines(["-O1", "--inline-report"])
+        # nothing is inlined, so there is nothing to report
+        no_inline_report = inline_lines(["-O1", "--no-inline", "--inline-report"])
+        if report is None or no_inline_report is None:
+            return False
+
+        with open(output_file, "w") as out:
+            out.writelines(report)
+            out.writelines(no_inline_report)
+
+        clist = ["diff", "-u", output_file, solution, f'--label="your output:({output_file})"', f'--label="answer:({solution})"']
+        cmd = " ".join(clist)
+        proc = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                                stderr=subprocess.STDOUT, shell=True)
+        output = str(proc.stdout.read(), "utf-8")
+        retcode = proc.wait()
+        if retcode != 0:
+            self.diff_result += "{} --inline-report\n".format(self.report_cases[case_id])
+            self.diff_result += "{}\n".format(output)
+
+        return retcode == 0
+
+    @staticmethod
+    def split_functions(module):
+        """The lines of each function defined in module, and the blocks of
+        it by the comment on their label ("for body"), the entry block by
+        "entry"."""
+        functions = {}
+        lines = None
+        for line in module.splitlines():
+            match = re.match(r"define .*@([\w.]+)\(", line)
+            if match:
+                lines = functions[match.group(1)] = []
+            elif line == "}":
+                lines = None
+            elif lines is not None:
+                lines.append(line)
+
+        blocks = {}
+        for name, lines in functions.items():
+            blocks[name] = []
+            comment = "entry"
+            body = []
+            for line in lines:
+                match = re.match(r"\d+:\s*(?:;\s*(.*))?$", line)
+                if match:
+                    blocks[name].append((comment, "\n".join(body)))
+                    comment = match.group(1) or ""
+                    body = []
+                else:
+                    body.append(line)
+            blocks[name].append((comment, "\n".join(body)))
+        return {name: "\n".join(lines) for name, lines in functions.items()}, blocks
+
+    def check_ir(self, case_id):
+        """Each line of opt_cases/sample-ir/<case> but comments is either
+            flags: <more flags than -O1 to compile the case with>
+        or a check on the module
+            <function>[/<block comment>] has|not|count=<n>: <regex>
+        which searches the text of the function or, given a comment, of
+        each of its blocks with that comment on the label: has, one of them
+        matches; not, none of them does; count, the matches add up to n.
+        There has to be such a function and such a block."""
+        c_name = self.ir_cases[case_id]
+        test_case = "%s/%s/%s.p" % (self.opt_case_dir, "test-cases", c_name)
+        checks_file = "%s/%s/%s" % (self.opt_case_dir, "sample-ir", c_name)
+        save_path = "%s/%s" % (self.save_path, "ir")
+        if not os.path.exists(save_path):
+            os.makedirs(save_path)
+
+        with open(checks_file) as f:
+            lines = [line.strip() for line in f]
+        lines = [line for line in lines if line and not line.startswith("#")]
+        flags = ["-O1"]
+        checks = []
+        for line in lines:
+            if line.startswith("flags:"):
+                flags += line[len("flags:"):].split()
+                continue
+            match = re.match(r"([\w.]+)(?:/([^:]*?))? (has|not|count=\d+): (.*)$", line)
+            assert match, "%s: bad check '%s'" % (checks_file, line)
+            checks.append(match.groups())
+
+        module = "%s/%s.ll" % (save_path, c_name)
+        if os.path.exists(module):
+            os.remove(module)
+        clist = [self.compiler, test_case, "--save-path", save_path] + flags
+        try:
+            subprocess.run(clist, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            with open(module) as f:
+                functions, blocks = self.split_functions(f.read())
+        except Exception as e:
+            print("Call of '%s' failed: %s" % (" ".join(clist), e))
+            return False
+
+        failed = []
+        for function, comment, verb, regex in checks:
+            where = function if comment is None else "%s/%s" % (function, comment)
+            if comment is None:
+                texts = [functions[function]] if function in functions else []
+            else:
+                texts = [text for block_comment, text in blocks.get(function, [])
+                         if block_comment == comment]
+            if not texts:
+                failed.append("%s %s: %s, no such function or block" % (where, verb, regex))
+                continue
+            matches = sum(len(re.findall(regex, text, re.M)) for text in texts)
+            if verb == "has":
+                ok = matches > 0
+            elif verb == "not":
+                ok = matches == 0
+            else:
+                ok = matches == int(verb[len("count="):])
+            if not ok:
+                failed.append("%s %s: %s, found %d" % (where, verb, regex, matches))
+
+        if failed:
+            self.diff_result += "{} {}\n".format(c_name, " ".join(flags))
+            self.diff_result += "".join("  failed %s\n" % check for check in failed)
+        return not failed
+
     def run(self):
+        if self.compiler_flags:
+            print("--- compiler flags: %s" % self.compiler_flags)
         print("---\tCase\t\tPoints")
 
         total_score = 0
@@ -229,6 +425,40 @@ class Grader:
             total_score += get_val
             max_score += max_val
 
+        for o_id in self.opt_id_list:
+            if o_id in self.opt_o1_id_list and "-O1" not in self.compiler_flags.split():
+                continue
+            c_name = self.opt_cases[o_id]
+            print("+++ TESTING opt case %s:" % c_name)
+            ok = self.test_sample_case("opt", o_id)
+            max_val = self.opt_case_scores[o_id]
+            get_val = max_val if ok else 0
+            print("---\t%s\t%d/%d" % (c_name, get_val, max_val))
+            total_score += get_val
+            max_score += max_val
+
+        # the inline reports and the -O1 modules, with flags of their own
+        # whatever --compiler-flags says
+        for r_id in self.report_id_list:
+            c_name = self.report_cases[r_id]
+            print("+++ TESTING inline report %s:" % c_name)
+            ok = self.test_inline_report(r_id)
+            max_val = self.report_case_scores[r_id]
+            get_val = max_val if ok else 0
+            print("---\t%s\t%d/%d" % (c_name, get_val, max_val))
+            total_score += get_val
+            max_score += max_val
+
+        for i_id in self.ir_id_list:
+            c_name = self.ir_cases[i_id]
+            print("+++ TESTING -O1 module of %s:" % c_name)
+            ok = self.check_ir(i_id)
+            max_val = self.ir_case_scores[i_id]
+            get_val = max_val if ok else 0
+            print("---\t%s\t%d/%d" % (c_name, get_val, max_val))
+            total_score += get_val
+            max_score += max_val
+
         print("---\tTOTAL\t\t%d/%d" % (total_score, max_score))
 
         with open("{}/{}".format(self.output_dir, "score.txt"), "w") as result:
@@ -241,6 +471,8 @@ def main():
     parser = ArgumentParser()
     parser.add_argument("--compiler", help="Your compiler to test.", 
                                     default="../src/compiler")
+    parser.add_argument("--compiler-flags", help="Flags passed on to the compiler, e.g. \"-O1\"; the output has to stay the same.",
+                                    default="")
     parser.add_argument("--save-path", help="Path that stores the output llvm instructions of your compiler.", 
                                         default="./output_llvm_code")
     parser.add_argument("--executable-file-path", help="Path that stores the compiled executable files.", 
@@ -252,6 +484,7 @@ def main():
     args = parser.parse_args()
 
     g = Grader(compiler = args.compiler, 
+                compiler_flags = args.compiler_flags,
                 save_path = args.save_path,
                 executable_file_path = args.executable_file_path,
                 code_result_path = args.code_result_path,